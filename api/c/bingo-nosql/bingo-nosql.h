@@ -35,6 +35,17 @@ CEXPORT int bingoInsertRecordObj(int db, int obj);
 CEXPORT int bingoInsertRecordObjWithId(int db, int obj, int id);
 CEXPORT int bingoInsertRecordObjWithExtFP(int db, int obj, int fp);
 CEXPORT int bingoInsertRecordObjWithIdAndExtFP(int db, int obj, int id, int fp);
+// Inserts all records of an array or an iterator, fingerprints are computed in parallel.
+// ids may be NULL, otherwise it contains ids_count ids, and no more than ids_count
+// records are read from the objects.
+// Options: "threads:N" (processors count by default), "bulk-load:true" (similarity
+// index trees are built on bingoOptimize instead of on insertion).
+// The ids and the types of array items are checked before any record is inserted.
+// Records are stored by chunks of 1000, so if a record fails later, e.g. while its
+// fingerprint is computed or an iterator is read, the records of the previous
+// chunks stay in the database and the error message reports their number.
+// Returns the number of inserted records
+CEXPORT int bingoInsertRecordObjBatch(int db, int objects, const int* ids, int ids_count, const char* options);
 CEXPORT int bingoDeleteRecord(int db, int id);
 CEXPORT int bingoGetRecordObj(int db, int id);
 
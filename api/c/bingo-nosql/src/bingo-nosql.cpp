@@ -20,12 +20,16 @@
 #include "bingo_object.h"
 
 #include "bingo_internal.h"
+#include "indigo_array.h"
 #include "indigo_internal.h"
 #include "indigo_molecule.h"
 #include "indigo_reaction.h"
 
+#include "base_cpp/os_thread_wrapper.h"
 #include "bingo_index.h"
 
+#include <map>
+#include <memory>
 #include <stdio.h>
 #include <string>
 
@@ -172,6 +176,53 @@ static int _insertObjectWithExtFPToDatabase(int db, Indigo& self, Index& bingo_i
     return -1;
 }
 
+static void _checkIndexObjectType(Index& bingo_index, IndigoObject& indigo_obj)
+{
+    if (bingo_index.getType() == Index::MOLECULE)
+    {
+        if (!IndigoMolecule::is(indigo_obj))
+            throw BingoException("bingoInsertRecordObjBatch: Only molecule objects can be added to molecule index");
+    }
+    else if (bingo_index.getType() == Index::REACTION)
+    {
+        if (!IndigoReaction::is(indigo_obj))
+            throw BingoException("bingoInsertRecordObjBatch: Only reaction objects can be added to reaction index");
+    }
+    else
+        throw BingoException("bingoInsertRecordObjBatch: Incorrect database");
+}
+
+static IndexObject* _createIndexObject(Indigo& self, Index& bingo_index, IndigoObject& indigo_obj)
+{
+    _checkIndexObjectType(bingo_index, indigo_obj);
+
+    if (bingo_index.getType() == Index::MOLECULE)
+    {
+        indigo_obj.getBaseMolecule().aromatize(self.arom_options);
+
+        return new IndexMolecule(indigo_obj.getMolecule());
+    }
+
+    indigo_obj.getBaseReaction().aromatize(self.arom_options);
+
+    return new IndexReaction(indigo_obj.getReaction());
+}
+
+static int _getObjectIdProperty(Index& bingo_index, IndigoObject& indigo_obj)
+{
+    long obj_id = -1;
+    auto& properties = indigo_obj.getProperties();
+
+    const char* key_name = bingo_index.getIdPropertyName();
+
+    if (key_name != 0 && properties.contains(key_name))
+    {
+        obj_id = strtol(properties.at(key_name), NULL, 10);
+    }
+
+    return obj_id;
+}
+
 Matcher& getMatcher(int id)
 {
     if (id < _searches.begin() || id >= _searches.end() || !_searches.hasElement(id))
@@ -219,17 +270,117 @@ CEXPORT int bingoInsertRecordObj(int db, int obj)
         IndigoObject& indigo_obj = self.getObject(obj);
         Index& bingo_index = _bingo_instances.ref(db);
 
-        long obj_id = -1;
-        auto& properties = indigo_obj.getProperties();
+        return _insertObjectToDatabase(db, self, bingo_index, indigo_obj, _getObjectIdProperty(bingo_index, indigo_obj));
+    }
+    BINGO_END(-1);
+}
 
-        const char* key_name = bingo_index.getIdPropertyName();
+CEXPORT int bingoInsertRecordObjBatch(int db, int objects, const int* ids, int ids_count, const char* options)
+{
+    BINGO_BEGIN_DB(db)
+    {
+        IndigoObject& source = self.getObject(objects);
+        Index& bingo_index = _bingo_instances.ref(db);
 
-        if (key_name != 0 && properties.contains(key_name))
+        std::map<std::string, std::string> option_map;
+        Properties::parseOptions(options, option_map);
+
+        int threads_count = osGetProcessorsCount();
+        bool bulk_load = false;
+
+        if (ids != 0 && ids_count < 0)
+            throw BingoException("bingoInsertRecordObjBatch: incorrect ids count %d", ids_count);
+
+        for (auto& option : option_map)
         {
-            obj_id = strtol(properties.at(key_name), NULL, 10);
+            if (option.first == "threads")
+            {
+                threads_count = atoi(option.second.c_str());
+                if (threads_count <= 0)
+                    throw BingoException("bingoInsertRecordObjBatch: incorrect threads count %s", option.second.c_str());
+            }
+            else if (option.first == "bulk-load")
+                bulk_load = (option.second == "true" || option.second == "1");
+            else
+                throw BingoException("bingoInsertRecordObjBatch: unknown option %s", option.first.c_str());
+        }
+
+        bool is_array = IndigoArray::is(source);
+        int array_idx = 0;
+
+        // The ids and the array items are checked before anything is inserted
+        if (ids != 0)
+        {
+            Array<int> batch_ids;
+            batch_ids.copy(ids, ids_count);
+            bingo_index.checkBatchIds(batch_ids, *_lockers[db]);
+        }
+        if (is_array)
+        {
+            IndigoArray& arr = IndigoArray::cast(source);
+            for (int i = 0; i < arr.objects.size() && (ids == 0 || i < ids_count); i++)
+                _checkIndexObjectType(bingo_index, *arr.objects[i]);
+        }
+
+        // Objects are copied and prepared by chunks to keep memory bounded for long iterators
+        const int chunk_size = 1000;
+        PtrArray<IndexObject> index_objs;
+        Array<int> obj_ids;
+        int inserted = 0;
+
+        try
+        {
+            while (true)
+            {
+                index_objs.clear();
+                obj_ids.clear();
+
+                while (index_objs.size() < chunk_size)
+                {
+                    // Records without ids are left in the source
+                    if (ids != 0 && inserted + index_objs.size() == ids_count)
+                        break;
+
+                    std::unique_ptr<IndigoObject> next_holder;
+                    IndigoObject* indigo_obj;
+
+                    if (is_array)
+                    {
+                        IndigoArray& arr = IndigoArray::cast(source);
+                        if (array_idx == arr.objects.size())
+                            break;
+                        indigo_obj = arr.objects[array_idx++];
+                    }
+                    else
+                    {
+                        next_holder.reset(source.next());
+                        if (next_holder.get() == nullptr)
+                            break;
+                        indigo_obj = next_holder.get();
+                    }
+
+                    int obj_id = (ids != 0 ? ids[inserted + index_objs.size()] : _getObjectIdProperty(bingo_index, *indigo_obj));
+
+                    index_objs.add(_createIndexObject(self, bingo_index, *indigo_obj));
+                    obj_ids.push(obj_id);
+                }
+
+                if (index_objs.size() == 0)
+                    break;
+
+                bingo_index.addBatch(index_objs, obj_ids, *_lockers[db], threads_count, bulk_load);
+                inserted += index_objs.size();
+            }
+        }
+        catch (Exception& e)
+        {
+            // The records of the previous chunks stay in the database
+            if (inserted > 0)
+                throw BingoException("bingoInsertRecordObjBatch: %d records were inserted before the error: %s", inserted, e.message());
+            throw;
         }
 
-        return _insertObjectToDatabase(db, self, bingo_index, indigo_obj, obj_id);
+        return inserted;
     }
     BINGO_END(-1);
 }
@@ -363,7 +514,7 @@ CEXPORT int bingoSearchSub(int db, int query_obj, const char* options)
             std::unique_ptr<MoleculeSubstructureQueryData> query_data = std::make_unique<MoleculeSubstructureQueryData>(obj.getQueryMolecule());
 
             MoleculeIndex& bingo_index = dynamic_cast<MoleculeIndex&>(_bingo_instances.ref(db));
-            MoleculeSubMatcher* matcher = dynamic_cast<MoleculeSubMatcher*>(bingo_index.createMatcher("sub", query_data.release(), options));
+            Matcher* matcher = bingo_index.createMatcher("sub", query_data.release(), options);
 
             int search_id;
             {
@@ -382,7 +533,7 @@ CEXPORT int bingoSearchSub(int db, int query_obj, const char* options)
             std::unique_ptr<ReactionSubstructureQueryData> query_data = std::make_unique<ReactionSubstructureQueryData>(obj.getQueryReaction());
 
             ReactionIndex& bingo_index = dynamic_cast<ReactionIndex&>(_bingo_instances.ref(db));
-            ReactionSubMatcher* matcher = dynamic_cast<ReactionSubMatcher*>(bingo_index.createMatcher("sub", query_data.release(), options));
+            Matcher* matcher = bingo_index.createMatcher("sub", query_data.release(), options);
 
             int search_id;
             {
@@ -488,7 +639,7 @@ CEXPORT int bingoSearchSim(int db, int query_obj, float min, float max, const ch
             std::unique_ptr<MoleculeSimilarityQueryData> query_data = std::make_unique<MoleculeSimilarityQueryData>(obj.getMolecule(), min, max);
 
             MoleculeIndex& bingo_index = dynamic_cast<MoleculeIndex&>(_bingo_instances.ref(db));
-            MoleculeSimMatcher* matcher = dynamic_cast<MoleculeSimMatcher*>(bingo_index.createMatcher("sim", query_data.release(), options));
+            Matcher* matcher = bingo_index.createMatcher("sim", query_data.release(), options);
 
             int search_id;
             {
@@ -507,7 +658,7 @@ CEXPORT int bingoSearchSim(int db, int query_obj, float min, float max, const ch
             std::unique_ptr<ReactionSimilarityQueryData> query_data = std::make_unique<ReactionSimilarityQueryData>(obj.getReaction(), min, max);
 
             ReactionIndex& bingo_index = dynamic_cast<ReactionIndex&>(_bingo_instances.ref(db));
-            ReactionSimMatcher* matcher = dynamic_cast<ReactionSimMatcher*>(bingo_index.createMatcher("sim", query_data.release(), options));
+            Matcher* matcher = bingo_index.createMatcher("sim", query_data.release(), options);
 
             int search_id;
             {
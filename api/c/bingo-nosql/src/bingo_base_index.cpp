@@ -4,9 +4,14 @@
 
 #include "indigo_fingerprints.h"
 
+#include <atomic>
 #include <limits.h>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include "base_c/os_dir.h"
 #include "base_cpp/output.h"
@@ -178,33 +183,7 @@ int BaseIndex::add(/* const */ IndexObject& obj, int obj_id, DatabaseLockData& l
     WriteLock wlock(lock_data);
     profTimerStart(t_after, "exclusive_write");
 
-    {
-        profTimerStart(t_in, "add_obj_data");
-        _insertIndexData(_obj_data);
-    }
-
-    {
-        profTimerStart(t_in, "mapping_changing_1");
-        if (obj_id == -1)
-        {
-            int i = _header->first_free_id;
-            while (back_id_mapping.get(i) != (size_t)-1)
-                i++;
-
-            _header->first_free_id = i;
-
-            obj_id = _header->first_free_id;
-        }
-    }
-
-    int base_id = _header->object_count;
-    _header->object_count++;
-    {
-        profTimerStart(t_in, "mapping_changing_2");
-        _mappingAdd(obj_id, base_id);
-    }
-
-    return obj_id;
+    return _insertObject(_obj_data, obj_id);
 }
 
 int BaseIndex::addWithExtFP(/* const */ IndexObject& obj, int obj_id, DatabaseLockData& lock_data, IndigoObject& fp)
@@ -229,33 +208,107 @@ int BaseIndex::addWithExtFP(/* const */ IndexObject& obj, int obj_id, DatabaseLo
     WriteLock wlock(lock_data);
     profTimerStart(t_after, "exclusive_write");
 
+    return _insertObject(_obj_data, obj_id);
+}
+
+void BaseIndex::addBatch(PtrArray<IndexObject>& objs, Array<int>& obj_ids, DatabaseLockData& lock_data, int threads_count, bool bulk_load)
+{
+    if (_read_only)
+        throw Exception("insert fail: Read only index can't be changed");
+
+    if (obj_ids.size() != objs.size())
+        throw Exception("insert fail: Objects and ids count mismatch");
+
     {
-        profTimerStart(t_in, "add_obj_data");
-        _insertIndexData(_obj_data);
+        WriteLock wlock(lock_data);
+        _checkBatchIds(obj_ids);
     }
 
+    ObjArray<_ObjectIndexData> objs_data;
+    for (int i = 0; i < objs.size(); i++)
+        objs_data.push();
+
     {
-        profTimerStart(t_in, "mapping_changing_1");
-        if (obj_id == -1)
+        profTimerStart(t_in, "prepare_obj_data_batch");
+
+        // Fingerprints and canonical forms are computed independently for each object,
+        // only storage updates below need the exclusive lock
+        std::atomic<int> next_obj(0);
+        std::exception_ptr error;
+        std::mutex error_lock;
+        int db_id = MMFStorage::getDatabaseId();
+
+        auto worker = [&]() {
+            qword initial_SID = TL_GET_SESSION_ID();
+            MMFStorage::setDatabaseId(db_id);
+
+            try
+            {
+                int i;
+                while ((i = next_obj++) < objs.size())
+                    _prepareIndexData(*objs[i], objs_data[i]);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(error_lock);
+                if (!error)
+                    error = std::current_exception();
+                next_obj = objs.size();
+            }
+
+            MMFStorage::setDatabaseId(-1);
+            TL_RELEASE_SESSION_ID(initial_SID);
+        };
+
+        if (threads_count > objs.size())
+            threads_count = objs.size();
+
+        if (threads_count <= 1)
         {
-            int i = _header->first_free_id;
-            while (back_id_mapping.get(i) != (size_t)-1)
-                i++;
-
-            _header->first_free_id = i;
-
-            obj_id = _header->first_free_id;
+            for (int i = 0; i < objs.size(); i++)
+                _prepareIndexData(*objs[i], objs_data[i]);
+        }
+        else
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threads_count; i++)
+                threads.emplace_back(worker);
+            for (auto& thread : threads)
+                thread.join();
         }
+
+        if (error)
+            std::rethrow_exception(error);
     }
 
-    int base_id = _header->object_count;
-    _header->object_count++;
+    WriteLock wlock(lock_data);
+    profTimerStart(t_after, "exclusive_write_batch");
+
+    // The lock was released while preparing the objects, and a concurrent insert could take the ids
+    _checkBatchIds(obj_ids);
+
+    for (int i = 0; i < objs.size(); i++)
+        obj_ids[i] = _insertObject(objs_data[i], obj_ids[i], bulk_load);
+}
+
+void BaseIndex::checkBatchIds(const Array<int>& obj_ids, DatabaseLockData& lock_data)
+{
+    ReadLock rlock(lock_data);
+    _checkBatchIds(obj_ids);
+}
+
+void BaseIndex::_checkBatchIds(const Array<int>& obj_ids)
+{
+    BingoMapping& back_id_mapping = _back_id_mapping_ptr.ref();
+    std::unordered_set<int> batch_ids;
+
+    for (int i = 0; i < obj_ids.size(); i++)
     {
-        profTimerStart(t_in, "mapping_changing_2");
-        _mappingAdd(obj_id, base_id);
+        if (obj_ids[i] == -1)
+            continue;
+        if (back_id_mapping.get(obj_ids[i]) != (size_t)-1 || !batch_ids.insert(obj_ids[i]).second)
+            throw Exception("insert fail: This id was already used");
     }
-
-    return obj_id;
 }
 
 void BaseIndex::optimize()
@@ -521,15 +574,48 @@ bool BaseIndex::_prepareIndexDataWithExtFP(IndexObject& obj, _ObjectIndexData& o
     return true;
 }
 
-void BaseIndex::_insertIndexData(_ObjectIndexData& obj_data)
+void BaseIndex::_insertIndexData(_ObjectIndexData& obj_data, bool defer_build)
 {
     _sub_fp_storage.ptr()->add(obj_data.sub_fp.ptr());
-    _sim_fp_storage.ptr()->add(obj_data.sim_fp.ptr(), _header->object_count);
+    _sim_fp_storage.ptr()->add(obj_data.sim_fp.ptr(), _header->object_count, defer_build);
     _cf_storage.ptr()->add((byte*)obj_data.cf_str.ptr(), obj_data.cf_str.size(), _header->object_count);
     _exact_storage.ptr()->add(obj_data.hash, _header->object_count);
     _gross_storage.ptr()->add(obj_data.gross_str, _header->object_count);
 }
 
+int BaseIndex::_insertObject(_ObjectIndexData& obj_data, int obj_id, bool defer_build)
+{
+    BingoMapping& back_id_mapping = _back_id_mapping_ptr.ref();
+
+    {
+        profTimerStart(t_in, "add_obj_data");
+        _insertIndexData(obj_data, defer_build);
+    }
+
+    {
+        profTimerStart(t_in, "mapping_changing_1");
+        if (obj_id == -1)
+        {
+            int i = _header->first_free_id;
+            while (back_id_mapping.get(i) != (size_t)-1)
+                i++;
+
+            _header->first_free_id = i;
+
+            obj_id = _header->first_free_id;
+        }
+    }
+
+    int base_id = _header->object_count;
+    _header->object_count++;
+    {
+        profTimerStart(t_in, "mapping_changing_2");
+        _mappingAdd(obj_id, base_id);
+    }
+
+    return obj_id;
+}
+
 void BaseIndex::_mappingLoad()
 {
     _id_mapping_ptr = BingoPtr<BingoArray<int>>(_header->mapping_offset);
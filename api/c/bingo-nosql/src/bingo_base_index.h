@@ -49,6 +49,11 @@ namespace bingo
 
         virtual int addWithExtFP(IndexObject& obj, int obj_id, DatabaseLockData& lock_data, IndigoObject& fp) = 0;
 
+        virtual void addBatch(PtrArray<IndexObject>& objs, Array<int>& obj_ids, DatabaseLockData& lock_data, int threads_count, bool bulk_load) = 0;
+
+        // Throws if an id is used twice or is already in the index
+        virtual void checkBatchIds(const Array<int>& obj_ids, DatabaseLockData& lock_data) = 0;
+
         virtual void optimize() = 0;
 
         virtual void remove(int id) = 0;
@@ -90,6 +95,10 @@ namespace bingo
 
         int addWithExtFP(IndexObject& obj, int obj_id, DatabaseLockData& lock_data, IndigoObject& fp) override;
 
+        void addBatch(PtrArray<IndexObject>& objs, Array<int>& obj_ids, DatabaseLockData& lock_data, int threads_count, bool bulk_load) override;
+
+        void checkBatchIds(const Array<int>& obj_ids, DatabaseLockData& lock_data) override;
+
         void optimize() override;
 
         void remove(int id) override;
@@ -170,7 +179,10 @@ namespace bingo
 
         bool _prepareIndexDataWithExtFP(IndexObject& obj, _ObjectIndexData& obj_data, IndigoObject& fp);
 
-        void _insertIndexData(_ObjectIndexData& obj_data);
+        void _insertIndexData(_ObjectIndexData& obj_data, bool defer_build = false);
+
+        int _insertObject(_ObjectIndexData& obj_data, int obj_id, bool defer_build = false);
+        void _checkBatchIds(const Array<int>& obj_ids);
 
         void _mappingCreate();
 
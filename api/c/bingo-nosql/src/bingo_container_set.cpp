@@ -55,13 +55,13 @@ bool ContainerSet::add(const byte* fingerprint, int id, int fp_ones_count)
     return false;
 }
 
-void ContainerSet::buildContainer()
+void ContainerSet::buildContainer(bool deferred)
 {
     profIncCounter("trees_count", 1);
 
     MultibitTree& cont = _set.push<int>(_fp_size);
 
-    cont.build(_increment, _indices, _container_size, _min_ones_count, _max_ones_count);
+    cont.build(_increment, _indices, _container_size, _min_ones_count, _max_ones_count, deferred);
     _increment.allocate(_container_size * _fp_size);
     _indices.allocate(_container_size);
 
@@ -136,6 +136,15 @@ void ContainerSet::findSimilar(const byte* query, SimCoef& sim_coef, double min_
 
 void ContainerSet::optimize()
 {
+    for (int i = 0; i < _set.size(); i++)
+    {
+        if (_set[i].isDeferred())
+        {
+            profTimerStart(t, "cs_complete_deferred");
+            _set[i].completeBuild();
+        }
+    }
+
     if (_inc_count < _container_size / 10)
         return;
 
@@ -32,7 +32,7 @@ namespace bingo
 
         bool add(const byte* fingerprint, int id, int fp_ones_count = -1);
 
-        void buildContainer();
+        void buildContainer(bool deferred = false);
 
         void splitSet(ContainerSet& new_set);
 
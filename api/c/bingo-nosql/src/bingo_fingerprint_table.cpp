@@ -40,7 +40,7 @@ void FingerprintTable::load(BingoPtr<FingerprintTable>& ptr, BingoAddr offset)
     ptr = BingoPtr<FingerprintTable>(offset);
 }
 
-void FingerprintTable::add(const byte* fingerprint, int id)
+void FingerprintTable::add(const byte* fingerprint, int id, bool defer_build)
 {
     int fp_bit_count = bitGetOnesCount(fingerprint, _fp_size);
 
@@ -51,7 +51,7 @@ void FingerprintTable::add(const byte* fingerprint, int id)
             if (_table[i].add(fingerprint, id))
             {
                 if (_table[i].getMinBorder() == _table[i].getMaxBorder() || _table[i].getContCount() > 1 || _table.size() >= _max_cell_count)
-                    _table[i].buildContainer();
+                    _table[i].buildContainer(defer_build);
                 else
                 {
                     _table.resize(_table.size() + 1);
@@ -26,7 +26,7 @@ namespace bingo
 
         static void load(BingoPtr<FingerprintTable>& ptr, BingoAddr offset);
 
-        void add(const byte* fingerprint, int id);
+        void add(const byte* fingerprint, int id, bool defer_build = false);
 
         void findSimilar(const byte* query, SimCoef& sim_coef, double min_coef, Array<SimResult>& sim_fp_indices);
 
@@ -11,6 +11,12 @@ MoleculeIndex::MoleculeIndex() : BaseIndex(MOLECULE)
 
 Matcher* MoleculeIndex::createMatcher(const char* type, MatcherQueryData* query_data, const char* options)
 {
+    std::string other_options;
+    int threads_count = ParallelMatcher::extractThreadsOption(options, other_options);
+    if (threads_count > 1 && (strcmp(type, "sub") == 0 || strcmp(type, "sim") == 0))
+        return new ParallelMatcher(*this, type, query_data, other_options.c_str(), threads_count);
+    options = other_options.c_str();
+
     if (strcmp(type, "sub") == 0)
     {
         std::unique_ptr<MoleculeSubMatcher> matcher = std::make_unique<MoleculeSubMatcher>(*this);
@@ -102,6 +108,12 @@ ReactionIndex::ReactionIndex() : BaseIndex(REACTION)
 
 Matcher* ReactionIndex::createMatcher(const char* type, MatcherQueryData* query_data, const char* options)
 {
+    std::string other_options;
+    int threads_count = ParallelMatcher::extractThreadsOption(options, other_options);
+    if (threads_count > 1 && (strcmp(type, "sub") == 0 || strcmp(type, "sim") == 0))
+        return new ParallelMatcher(*this, type, query_data, other_options.c_str(), threads_count);
+    options = other_options.c_str();
+
     if (strcmp(type, "sub") == 0)
     {
         std::unique_ptr<ReactionSubMatcher> matcher = std::make_unique<ReactionSubMatcher>(*this);
@@ -2,52 +2,58 @@
 
 using namespace bingo;
 
-DatabaseLockData::DatabaseLockData() : writers_count(0), readers_count(0)
+DatabaseLockData::DatabaseLockData() : readers_count(0), writers_count(0)
 {
-    osSemaphoreCreate(&rc_sem, 1, 1);
-    osSemaphoreCreate(&wc_sem, 1, 1);
-    osSemaphoreCreate(&w_sem, 1, 1);
-    osSemaphoreCreate(&r_sem, 1, 1);
 }
 
 ReadLock::ReadLock(DatabaseLockData& data) : _data(data)
 {
-    osSemaphoreWait(&_data.r_sem);
-    osSemaphoreWait(&_data.rc_sem);
-    _data.readers_count++;
-    if (_data.readers_count == 1)
-        osSemaphoreWait(&_data.w_sem);
-    osSemaphorePost(&_data.rc_sem);
-    osSemaphorePost(&_data.r_sem);
+    while (true)
+    {
+        if (_data.writers_count.load() == 0)
+        {
+            _data.readers_count++;
+            if (_data.writers_count.load() == 0)
+                return;
+
+            // A writer has come in between, step back and let it go first
+            if (--_data.readers_count == 0)
+            {
+                std::lock_guard<std::mutex> guard(_data.wait_mutex);
+                _data.wait_cond.notify_all();
+            }
+        }
+
+        std::unique_lock<std::mutex> wait_lock(_data.wait_mutex);
+        _data.wait_cond.wait(wait_lock, [this]() { return _data.writers_count.load() == 0; });
+    }
 }
 
 ReadLock::~ReadLock()
 {
-    osSemaphoreWait(&_data.rc_sem);
-    _data.readers_count--;
-    if (_data.readers_count == 0)
-        osSemaphorePost(&_data.w_sem);
-    osSemaphorePost(&_data.rc_sem);
+    if (--_data.readers_count == 0 && _data.writers_count.load() != 0)
+    {
+        std::lock_guard<std::mutex> guard(_data.wait_mutex);
+        _data.wait_cond.notify_all();
+    }
 }
 
 WriteLock::WriteLock(DatabaseLockData& data) : _data(data)
 {
-    osSemaphoreWait(&_data.wc_sem);
     _data.writers_count++;
-    if (_data.writers_count == 1)
-        osSemaphoreWait(&_data.r_sem);
-    osSemaphorePost(&_data.wc_sem);
+    _data.write_mutex.lock();
 
-    osSemaphoreWait(&_data.w_sem);
+    std::unique_lock<std::mutex> wait_lock(_data.wait_mutex);
+    _data.wait_cond.wait(wait_lock, [this]() { return _data.readers_count.load() == 0; });
 }
 
 WriteLock::~WriteLock()
 {
-    osSemaphorePost(&_data.w_sem);
+    _data.write_mutex.unlock();
 
-    osSemaphoreWait(&_data.wc_sem);
-    _data.writers_count--;
-    if (_data.writers_count == 0)
-        osSemaphorePost(&_data.r_sem);
-    osSemaphorePost(&_data.wc_sem);
+    {
+        std::lock_guard<std::mutex> guard(_data.wait_mutex);
+        _data.writers_count--;
+    }
+    _data.wait_cond.notify_all();
 }
@@ -1,14 +1,22 @@
 #ifndef __bingo_lock__
 #define __bingo_lock__
 
-#include "base_c/os_sync.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 namespace bingo
 {
+    // Writer-preferring reader/writer lock. Readers take the lock with two atomic
+    // operations while there are no writers and fall back to the mutex only when
+    // a writer is waiting or active.
     struct DatabaseLockData
     {
-        os_semaphore rc_sem, wc_sem, w_sem, r_sem;
-        int writers_count, readers_count;
+        std::atomic<int> readers_count;
+        std::atomic<int> writers_count; // waiting and active writers
+        std::mutex write_mutex;
+        std::mutex wait_mutex;
+        std::condition_variable wait_cond;
 
         DatabaseLockData();
     };
@@ -1,5 +1,6 @@
 #include "bingo_matcher.h"
 #include "bingo_euclid_coef.h"
+#include "bingo_mmf_storage.h"
 #include "bingo_tanimoto_coef.h"
 #include "bingo_tversky_coef.h"
 
@@ -10,7 +11,9 @@
 #include "base_cpp/profiling.h"
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 using namespace indigo;
@@ -28,6 +31,11 @@ QueryObject& GrossQueryData::getQueryObject()
     return _obj;
 }
 
+MatcherQueryData* MatcherQueryData::clone()
+{
+    throw Exception("MatcherQueryData does not support this method");
+}
+
 void SimilarityQueryData::setMin(float min)
 {
     throw Exception("SimilarityQueryData does not support this method");
@@ -58,6 +66,11 @@ void MoleculeSimilarityQueryData::setMin(float min)
     _min = min;
 }
 
+MatcherQueryData* MoleculeSimilarityQueryData::clone()
+{
+    return new MoleculeSimilarityQueryData((Molecule&)_obj.getMolecule(), _min, _max);
+}
+
 ReactionSimilarityQueryData::ReactionSimilarityQueryData(/* const */ Reaction& qrxn, float min_coef, float max_coef)
     : _obj(qrxn), _min(min_coef), _max(max_coef)
 {
@@ -83,6 +96,11 @@ void ReactionSimilarityQueryData::setMin(float min)
     _min = min;
 }
 
+MatcherQueryData* ReactionSimilarityQueryData::clone()
+{
+    return new ReactionSimilarityQueryData((Reaction&)_obj.getReaction(), _min, _max);
+}
+
 MoleculeExactQueryData::MoleculeExactQueryData(/* const */ Molecule& mol) : _obj(mol)
 {
 }
@@ -110,6 +128,11 @@ MoleculeSubstructureQueryData::MoleculeSubstructureQueryData(/* const */ QueryMo
     return _obj;
 }
 
+MatcherQueryData* MoleculeSubstructureQueryData::clone()
+{
+    return new MoleculeSubstructureQueryData((QueryMolecule&)_obj.getMolecule());
+}
+
 ReactionSubstructureQueryData::ReactionSubstructureQueryData(/* const */ QueryReaction& qrxn) : _obj(qrxn)
 {
 }
@@ -119,6 +142,11 @@ ReactionSubstructureQueryData::ReactionSubstructureQueryData(/* const */ QueryRe
     return _obj;
 }
 
+MatcherQueryData* ReactionSubstructureQueryData::clone()
+{
+    return new ReactionSubstructureQueryData((QueryReaction&)_obj.getReaction());
+}
+
 IndexCurrentMolecule::IndexCurrentMolecule(IndexCurrentMolecule*& ptr) : _ptr(ptr)
 {
     matcher_exist = true;
@@ -166,6 +194,11 @@ int BaseMatcher::currentId()
     return id_mapping[_current_id];
 }
 
+int BaseMatcher::currentIndex() const
+{
+    return _current_id;
+}
+
 IndigoObject* BaseMatcher::currentObject()
 {
     if (_current_obj_used)
@@ -357,7 +390,6 @@ BaseSubstructureMatcher::BaseSubstructureMatcher(/*const */ BaseIndex& index, In
 bool BaseSubstructureMatcher::next()
 {
     // int fp_size_in_bits = _fp_size * 8;
-    static int sub_cnt = 0;
 
     _current_cand_id++;
     while (!((_current_pack == _final_pack) && (_current_cand_id == _candidates.size())))
@@ -396,10 +428,7 @@ bool BaseSubstructureMatcher::next()
         _match_time_esimate.addValue(profTimerGetTimeSec(tsingle));
 
         if (status)
-        {
-            sub_cnt++;
             return true;
-        }
         _current_cand_id++;
     }
 
@@ -450,13 +479,16 @@ void BaseSubstructureMatcher::_findPackCandidates(int pack_idx)
     const byte* block;
 
     int fp_size_in_bits = _fp_size * 8;
+    int block_size = fp_storage.getBlockSize();
+    int word_count = (block_size + sizeof(qword) - 1) / sizeof(qword);
 
-    Array<byte> fit_bits;
-    fit_bits.clear_resize(fp_storage.getBlockSize());
-    fit_bits.fill(255);
+    // Candidates mask is processed by 64-bit words: the block is 8192 bytes long,
+    // so byte-by-byte processing is too slow for unselective queries
+    _fit_words.clear_resize(word_count);
+    _fit_words.fffill();
 
     profTimerStart(tgs, "sub_find_cand_pack_get_search");
-    int left = 0, right = fp_storage.getBlockSize() - 1;
+    int left = 0, right = word_count - 1;
 
     // Filter only based on the first 10 bits
     // TODO: collect time infromation about the reading and matching measurements and
@@ -470,11 +502,11 @@ void BaseSubstructureMatcher::_findPackCandidates(int pack_idx)
         profTimerStop(tgb);
 
         profTimerStart(tgu, "sub_find_cand_pack_fit_update");
-        bitAnd(fit_bits.ptr() + left, &block[0] + left, right - left + 1);
+        _andBlockWords(_fit_words.ptr(), block, block_size, left, right);
 
-        while (left <= right && fit_bits[left] == 0)
+        while (left <= right && _fit_words[left] == 0)
             left++;
-        while (left <= right && fit_bits[right] == 0)
+        while (left <= right && _fit_words[right] == 0)
             right--;
 
         if (left > right)
@@ -485,9 +517,37 @@ void BaseSubstructureMatcher::_findPackCandidates(int pack_idx)
     }
     profTimerStop(tgs);
 
-    for (int k = 0; k < 8 * fp_storage.getBlockSize(); k++)
-        if (bitGetBit(fit_bits.ptr(), k))
-            _candidates.push(k + pack_idx * fp_storage.getBlockSize() * 8);
+    int id_offset = pack_idx * block_size * 8;
+    for (int w = left; w <= right; w++)
+    {
+        qword bits = _fit_words[w];
+        while (bits != 0)
+        {
+            _candidates.push(id_offset + w * 64 + bitGetOneLOIndexQword(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+void BaseSubstructureMatcher::_andBlockWords(qword* fit_words, const byte* block, int block_size, int left, int right)
+{
+    int full_words = block_size / sizeof(qword);
+    int last = std::min(right, full_words - 1);
+    qword w;
+
+    for (int i = left; i <= last; i++)
+    {
+        memcpy(&w, block + i * sizeof(qword), sizeof(qword));
+        fit_words[i] &= w;
+    }
+
+    if (right >= full_words)
+    {
+        // Tail of the block that does not fill the whole word
+        w = 0;
+        memcpy(&w, block + full_words * sizeof(qword), block_size - full_words * sizeof(qword));
+        fit_words[full_words] &= w;
+    }
 }
 
 void BaseSubstructureMatcher::_findIncCandidates()
@@ -681,7 +741,8 @@ bool BaseSimilarityMatcher::next()
             }
             else
             {
-                if (_current_container > 0)
+                // Increment is not partitioned, so it belongs to the first part only
+                if (_current_container > 0 || _part_id > 1)
                     return false;
 
                 _current_portion.clear();
@@ -1616,4 +1677,287 @@ bool EnumeratorMatcher::next()
     }
 
     return false;
-}
\ No newline at end of file
+}
+//
+// ParallelMatcher
+//
+
+static const char* _matcher_threads_prop = "threads";
+
+// Each thread gets several index parts to balance the load
+// when matching objects are distributed unevenly
+static const int _parts_per_thread = 4;
+static const int _max_batch_size = 4096;
+
+ParallelMatcher::ParallelMatcher(BaseIndex& index, const char* type, MatcherQueryData* query_data, const char* options, int threads_count)
+    : BaseMatcher(index, _current), _threads_count(threads_count)
+{
+    std::unique_ptr<MatcherQueryData> query_data_holder(query_data);
+
+    if (index.getType() == Index::MOLECULE)
+        _current = new IndexCurrentMolecule((IndexCurrentMolecule*&)_current);
+    else
+        _current = new IndexCurrentReaction((IndexCurrentReaction*&)_current);
+
+    _is_sim = (strcmp(type, "sim") == 0);
+    if (!_is_sim && strcmp(type, "sub") != 0)
+        throw Exception("ParallelMatcher: only substructure and similarity searches can be run in parallel");
+
+    int parts_count = _threads_count * _parts_per_thread;
+    if (!_is_sim)
+        parts_count = std::min(parts_count, index.getSubStorage().getPackCount() + 1);
+
+    _parts.resize(parts_count);
+    for (int i = 0; i < parts_count; i++)
+    {
+        std::stringstream part_options;
+        if (options != 0 && strlen(options) > 0)
+            part_options << options << ";";
+        part_options << _matcher_part_prop << ":" << i + 1 << "/" << parts_count;
+
+        Matcher* part_matcher = index.createMatcher(type, query_data->clone(), part_options.str().c_str());
+        _parts[i].holder.reset(part_matcher);
+        _parts[i].matcher = dynamic_cast<BaseMatcher*>(part_matcher);
+        _parts[i].finished = false;
+    }
+
+    _current_id = -1;
+    _current_sim_value = -1;
+    _next_part = 0;
+    _finished_parts = 0;
+    _batch_size = _threads_count;
+    _results_pos = 0;
+    _round = 0;
+    _running_workers = 0;
+    _db_id = -1;
+    _shutdown = false;
+}
+
+ParallelMatcher::~ParallelMatcher()
+{
+    {
+        std::lock_guard<std::mutex> locker(_round_lock);
+        _shutdown = true;
+    }
+    _round_started.notify_all();
+
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+int ParallelMatcher::extractThreadsOption(const char* options, std::string& other_options)
+{
+    other_options.clear();
+    if (options == 0)
+        return 0;
+
+    int threads_count = 0;
+    std::stringstream options_stream;
+    options_stream << options;
+
+    std::string line;
+    while (options_stream.good())
+    {
+        std::getline(options_stream, line, ';');
+        if (line.size() == 0)
+            continue;
+
+        int sep = (int)line.find_first_of(':');
+        if (sep != -1 && line.compare(0, sep, _matcher_threads_prop) == 0)
+        {
+            std::stringstream value(line.substr(sep + 1));
+            value >> threads_count;
+            if (value.fail() || threads_count <= 0)
+                throw Exception("ParallelMatcher: incorrect threads count");
+            continue;
+        }
+
+        if (other_options.size() > 0)
+            other_options += ";";
+        other_options += line;
+    }
+
+    return threads_count;
+}
+
+bool ParallelMatcher::next()
+{
+    while (_results_pos >= _results.size())
+    {
+        if (_finished_parts == (int)_parts.size())
+            return false;
+
+        _results.clear();
+        _results_pos = 0;
+        _runRound();
+
+        // Grow batches so that the threads are woken rarely for the queries with many hits
+        _batch_size = std::min(_batch_size * 2, _max_batch_size);
+    }
+
+    _current_id = _results[_results_pos].index;
+    _current_sim_value = _results[_results_pos].sim_value;
+    _results_pos++;
+    return true;
+}
+
+IndigoObject* ParallelMatcher::currentObject()
+{
+    if (!_current_obj_used)
+        _loadCurrentObject();
+
+    return BaseMatcher::currentObject();
+}
+
+float ParallelMatcher::currentSimValue()
+{
+    if (!_is_sim)
+        return BaseMatcher::currentSimValue();
+
+    return _current_sim_value;
+}
+
+int ParallelMatcher::esimateRemainingResultsCount(int& delta)
+{
+    int count = 0;
+    delta = 0;
+    for (auto& part : _parts)
+    {
+        if (part.finished)
+            continue;
+
+        int part_delta;
+        count += part.matcher->esimateRemainingResultsCount(part_delta);
+        delta += part_delta;
+    }
+    return count + _results.size() - _results_pos;
+}
+
+float ParallelMatcher::esimateRemainingTime(float& delta)
+{
+    float time = 0;
+    delta = 0;
+    for (auto& part : _parts)
+    {
+        if (part.finished)
+            continue;
+
+        float part_delta;
+        time += part.matcher->esimateRemainingTime(part_delta);
+        delta += part_delta;
+    }
+    return time / _threads_count;
+}
+
+void ParallelMatcher::_runRound()
+{
+    profTimerStart(t, "parallel_round");
+
+    // Parts that were not finished during the previous round are claimed again
+    _next_part = 0;
+    _round_error = nullptr;
+
+    // The workers live until the matcher is destroyed
+    while ((int)_workers.size() < _threads_count)
+        _workers.emplace_back(&ParallelMatcher::_workerFunc, this);
+
+    {
+        std::lock_guard<std::mutex> locker(_round_lock);
+        _db_id = MMFStorage::getDatabaseId();
+        _running_workers = (int)_workers.size();
+        _round++;
+    }
+    _round_started.notify_all();
+
+    {
+        std::unique_lock<std::mutex> locker(_round_lock);
+        _round_finished.wait(locker, [this]() { return _running_workers == 0; });
+    }
+
+    if (_round_error)
+        std::rethrow_exception(_round_error);
+}
+
+void ParallelMatcher::_workerFunc()
+{
+    qword initial_SID = TL_GET_SESSION_ID();
+    int round = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> locker(_round_lock);
+            _round_started.wait(locker, [this, round]() { return _shutdown || _round != round; });
+            if (_shutdown)
+                break;
+            round = _round;
+            MMFStorage::setDatabaseId(_db_id);
+        }
+
+        _matchRound();
+        MMFStorage::setDatabaseId(-1);
+
+        std::lock_guard<std::mutex> locker(_round_lock);
+        if (--_running_workers == 0)
+            _round_finished.notify_one();
+    }
+
+    TL_RELEASE_SESSION_ID(initial_SID);
+}
+
+void ParallelMatcher::_matchRound()
+{
+    try
+    {
+        while (true)
+        {
+            _Part* part;
+            {
+                std::lock_guard<std::mutex> locker(_round_lock);
+                if (_round_error || _results.size() >= _batch_size)
+                    break;
+
+                while (_next_part < (int)_parts.size() && _parts[_next_part].finished)
+                    _next_part++;
+
+                if (_next_part == (int)_parts.size())
+                    break;
+
+                part = &_parts[_next_part++];
+            }
+
+            bool stop = false;
+            while (true)
+            {
+                bool found = part->matcher->next();
+
+                std::lock_guard<std::mutex> locker(_round_lock);
+                if (!found)
+                {
+                    part->finished = true;
+                    _finished_parts++;
+                    break;
+                }
+
+                _Result& result = _results.push();
+                result.index = part->matcher->currentIndex();
+                result.sim_value = _is_sim ? part->matcher->currentSimValue() : -1;
+
+                if (_round_error || _results.size() >= _batch_size)
+                {
+                    stop = true;
+                    break;
+                }
+            }
+
+            if (stop)
+                break;
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> locker(_round_lock);
+        if (!_round_error)
+            _round_error = std::current_exception();
+    }
+}
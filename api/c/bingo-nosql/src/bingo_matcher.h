@@ -14,6 +14,12 @@
 #include "molecule/molecule_substructure_matcher.h"
 #include "reaction/reaction_exact_matcher.h"
 
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 using namespace indigo;
 
 namespace bingo
@@ -27,6 +33,9 @@ namespace bingo
     public:
         virtual /*const*/ QueryObject& getQueryObject() /*const*/ = 0;
 
+        // Returns independent copy of the query data (used by parallel search)
+        virtual MatcherQueryData* clone();
+
         virtual ~MatcherQueryData(){};
     };
 
@@ -63,6 +72,7 @@ namespace bingo
         MoleculeSimilarityQueryData(/* const */ Molecule& mol, float min_coef, float max_coef);
 
         /*const*/ QueryObject& getQueryObject() /*const*/ override;
+        MatcherQueryData* clone() override;
 
         float getMin() const override;
         float getMax() const override;
@@ -80,6 +90,7 @@ namespace bingo
         ReactionSimilarityQueryData(/* const */ Reaction& rxn, float min_coef, float max_coef);
 
         /*const*/ QueryObject& getQueryObject() /*const*/ override;
+        MatcherQueryData* clone() override;
 
         float getMin() const override;
         float getMax() const override;
@@ -119,6 +130,7 @@ namespace bingo
         MoleculeSubstructureQueryData(/* const */ QueryMolecule& qmol);
 
         /*const*/ QueryObject& getQueryObject() /*const*/ override;
+        MatcherQueryData* clone() override;
 
     private:
         SubstructureMoleculeQuery _obj;
@@ -130,6 +142,7 @@ namespace bingo
         ReactionSubstructureQueryData(/* const */ QueryReaction& qrxn);
 
         /*const*/ QueryObject& getQueryObject() /*const*/ override;
+        MatcherQueryData* clone() override;
 
     private:
         SubstructureReactionQuery _obj;
@@ -192,6 +205,9 @@ namespace bingo
 
         int currentId() override;
 
+        // Internal (storage) index of the current object
+        int currentIndex() const;
+
         IndigoObject* currentObject() override;
 
         const Index& getIndex() override;
@@ -248,6 +264,8 @@ namespace bingo
 
         void _findPackCandidates(int pack_idx);
 
+        static void _andBlockWords(qword* fit_words, const byte* block, int block_size, int left, int right);
+
         void _findIncCandidates();
 
         virtual bool _tryCurrent() /* const */ = 0;
@@ -258,6 +276,7 @@ namespace bingo
 
     private:
         Array<int> _candidates;
+        Array<qword> _fit_words;
         int _current_cand_id;
         int _current_pack;
         int _final_pack;
@@ -525,6 +544,79 @@ namespace bingo
         IndigoObject* _indigoObject;
         int _id_numbers;
     };
+
+    // Runs one substructure or similarity query on several threads.
+    // The index is split into parts (see "part" matcher option) that are
+    // claimed by worker threads dynamically. The workers are started once and
+    // wait between the rounds. A round runs only inside a next() call, so the
+    // database read lock taken by bingoNext covers the matching.
+    // Results are returned in arbitrary order.
+    class ParallelMatcher : public BaseMatcher
+    {
+    public:
+        ParallelMatcher(BaseIndex& index, const char* type, MatcherQueryData* query_data, const char* options, int threads_count);
+
+        bool next() override;
+
+        IndigoObject* currentObject() override;
+
+        float currentSimValue() override;
+
+        int esimateRemainingResultsCount(int& delta) override;
+        float esimateRemainingTime(float& delta) override;
+
+        // Extracts "threads" value from options string. Other options are
+        // returned in other_options. Returns 0 if the option is absent.
+        static int extractThreadsOption(const char* options, std::string& other_options);
+
+        ~ParallelMatcher() override;
+
+    protected:
+        void _setParameters(const char* params) override{};
+        void _initPartition() override{};
+
+    private:
+        struct _Result
+        {
+            int index;
+            float sim_value;
+        };
+
+        struct _Part
+        {
+            std::unique_ptr<Matcher> holder;
+            BaseMatcher* matcher;
+            bool finished;
+        };
+
+        void _runRound();
+        void _workerFunc();
+        void _matchRound();
+
+        IndigoObject* _current;
+        bool _is_sim;
+        int _threads_count;
+        int _batch_size;
+        float _current_sim_value;
+
+        std::vector<_Part> _parts;
+        int _next_part;
+        int _finished_parts;
+
+        Array<_Result> _results;
+        int _results_pos;
+
+        std::mutex _round_lock;
+        std::exception_ptr _round_error;
+
+        std::vector<std::thread> _workers;
+        std::condition_variable _round_started;
+        std::condition_variable _round_finished;
+        int _round;
+        int _running_workers;
+        int _db_id;
+        bool _shutdown;
+    };
 }; // namespace bingo
 
 #endif // __bingo_matcher__
@@ -8,17 +8,17 @@
 
 using namespace bingo;
 
-// TODO: implement real thread local storage - not session local
-static _SIDManager _database_id;
+static thread_local int _database_id = -1;
 
 int MMFStorage::getDatabaseId()
 {
-    return (int)_database_id.getSessionId();
+    return _database_id;
 }
 
 void MMFStorage::setDatabaseId(int db)
 {
-    _database_id.setSessionId((int)db);
+    _database_id = db;
+    BingoAllocator::_resetCurrentInstance();
 }
 
 MMFStorage::MMFStorage()
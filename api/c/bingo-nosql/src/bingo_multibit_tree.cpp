@@ -141,25 +141,24 @@ void MultibitTree::_build()
     _tree_ptr = _buildNode(indices, is_mb, 0);
 }
 
-void MultibitTree::_findLinear(_MultibitNode* node, const byte* query, int query_bit_number, SimCoef& sim_coef, double min_coef, Array<SimResult>& sim_indices,
-                               int fp_bit_number)
+void MultibitTree::_findLinear(const int* fp_indices, int fp_count, const byte* query, int query_bit_number, SimCoef& sim_coef, double min_coef,
+                               Array<SimResult>& sim_indices, int fp_bit_number)
 {
     profTimerStart(tmsl, "multibit_tree_search_linear");
     byte* fingerprints = _fingerprints_ptr.ptr();
     int* indices = _indices_ptr.ptr();
 
-    int* fp_indices = node->fp_indices_array.ptr();
-
-    for (int i = 0; i < node->fp_indices_count; i++)
+    for (int i = 0; i < fp_count; i++)
     {
-        const byte* fp = fingerprints + fp_indices[i] * _fp_size;
+        int fp_idx = (fp_indices != 0 ? fp_indices[i] : i);
+        const byte* fp = fingerprints + fp_idx * _fp_size;
         int f_bit_number = bitGetOnesCount(fp, _fp_size);
 
         double coef = sim_coef.calcCoef(query, fp, query_bit_number, f_bit_number);
         if (coef < min_coef)
             continue;
 
-        sim_indices.push(SimResult(indices[fp_indices[i]], (float)coef));
+        sim_indices.push(SimResult(indices[fp_idx], (float)coef));
     }
 }
 
@@ -173,10 +172,11 @@ void MultibitTree::_findSimilarInNode(BingoPtr<_MultibitNode> node_ptr, const by
 
     if (node->fp_indices_count != 0)
     {
+        int* fp_indices = node->fp_indices_array.ptr();
         if (_min_fp_bit_number == _max_fp_bit_number) // if fingerpint bits_count is fixed
-            _findLinear(node, query, query_bit_number, sim_coef, min_coef, sim_indices, _min_fp_bit_number);
+            _findLinear(fp_indices, node->fp_indices_count, query, query_bit_number, sim_coef, min_coef, sim_indices, _min_fp_bit_number);
         else
-            _findLinear(node, query, query_bit_number, sim_coef, min_coef, sim_indices);
+            _findLinear(fp_indices, node->fp_indices_count, query, query_bit_number, sim_coef, min_coef, sim_indices);
 
         return;
     }
@@ -216,10 +216,10 @@ MultibitTree::MultibitTree(int fp_size) : _fp_size(fp_size)
     _tree_ptr.allocate();
     new (_tree_ptr.ptr()) _MultibitNode();
     _query_bit_number = -1;
-    _max_level = 6;
+    _max_level = _default_max_level;
 }
 
-void MultibitTree::build(BingoPtr<byte> fingerprints, BingoPtr<int> indices, int fp_count, int min_fp_bit_number, int max_fp_bit_number)
+void MultibitTree::build(BingoPtr<byte> fingerprints, BingoPtr<int> indices, int fp_count, int min_fp_bit_number, int max_fp_bit_number, bool deferred)
 {
     _fingerprints_ptr = fingerprints;
     _indices_ptr = indices;
@@ -229,6 +229,25 @@ void MultibitTree::build(BingoPtr<byte> fingerprints, BingoPtr<int> indices, int
 
     _fp_count = fp_count;
 
+    // A deferred tree is searched linearly and allocates no nodes, since the
+    // storage of the database can not be freed when the tree is built later
+    _max_level = (deferred ? 0 : _default_max_level);
+
+    if (!deferred)
+        _build();
+}
+
+bool MultibitTree::isDeferred() const
+{
+    return _max_level == 0;
+}
+
+void MultibitTree::completeBuild()
+{
+    if (!isDeferred())
+        return;
+
+    _max_level = _default_max_level;
     _build();
 }
 
@@ -238,6 +257,12 @@ int MultibitTree::findSimilar(const byte* query, SimCoef& sim_coef, double min_c
     int query_bit_number = bitGetOnesCount(query, _fp_size);
     sim_fp_indices.clear();
 
+    if (isDeferred())
+    {
+        _findLinear(0, _fp_count, query, query_bit_number, sim_coef, min_coef, sim_fp_indices);
+        return sim_fp_indices.size();
+    }
+
     _findSimilarInNode(_tree_ptr, query, query_bit_number, sim_coef, min_coef, sim_fp_indices, 0, 0);
 
     return sim_fp_indices.size();
@@ -19,7 +19,12 @@ namespace bingo
     public:
         MultibitTree(int fp_size);
 
-        void build(BingoPtr<byte> fingerprints, BingoPtr<int> indices, int fp_count, int min_fp_bit_number, int max_fp_bit_number);
+        void build(BingoPtr<byte> fingerprints, BingoPtr<int> indices, int fp_count, int min_fp_bit_number, int max_fp_bit_number, bool deferred = false);
+
+        // Deferred tree is searched linearly until completeBuild() is called
+        bool isDeferred() const;
+
+        void completeBuild();
 
         int findSimilar(const byte* query, SimCoef& sim_coef, double min_coef, Array<SimResult>& sim_fp_indices);
 
@@ -74,14 +79,17 @@ namespace bingo
         int _query_bit_number;
         int _max_level;
 
+        static const int _default_max_level = 6;
+
         static int _compareBitWeights(_DistrWeight& bw1, _DistrWeight& bw2, void* context);
 
         BingoPtr<_MultibitNode> _buildNode(Array<int>& fit_fp_indices, const Array<bool>& is_parrent_mb, int level);
 
         void _build();
 
-        void _findLinear(_MultibitNode* node, const byte* query, int query_bit_number, SimCoef& sim_coef, double min_coef, Array<SimResult>& sim_indices,
-                         int fp_bit_number = -1);
+        // fp_indices may be null to search the first fp_count fingerprints
+        void _findLinear(const int* fp_indices, int fp_count, const byte* query, int query_bit_number, SimCoef& sim_coef, double min_coef,
+                         Array<SimResult>& sim_indices, int fp_bit_number = -1);
 
         void _findSimilarInNode(BingoPtr<_MultibitNode> node_ptr, const byte* query, int query_bit_number, SimCoef& sim_coef, double min_coef,
                                 Array<SimResult>& sim_indices, int m01, int m10);
@@ -12,6 +12,8 @@ using namespace indigo;
 using namespace bingo;
 
 PtrArray<BingoAllocator> BingoAllocator::_instances;
+// Allocator of the current thread database, resolved on the first dereference
+static thread_local BingoAllocator* _current_instance = nullptr;
 OsLock BingoAllocator::_instances_lock;
 const BingoAddr BingoAddr::bingo_null = BingoAddr(-1, -1);
 
@@ -50,8 +52,10 @@ void BingoAllocator::_create(const char* filename, size_t min_size, size_t max_s
     allocator_data->_max_file_size = max_size;
     allocator_data->_cur_file_id = 0;
     inst->_mm_files->push(file);
+    inst->_file_ptrs.push(mmf_ptr);
     inst->_filename.assign(filename);
     inst->_index_id = index_id;
+    _current_instance = nullptr;
 }
 
 void BingoAllocator::_load(const char* filename, size_t alloc_off, ObjArray<MMFile>* mm_files, int index_id, bool read_only)
@@ -84,8 +88,10 @@ void BingoAllocator::_load(const char* filename, size_t alloc_off, ObjArray<MMFi
     inst->_data_offset = alloc_off;
     inst->_mm_files = mm_files;
     inst->_mm_files->push(file);
+    inst->_file_ptrs.push(mmf_ptr);
     inst->_filename.assign(filename);
     inst->_index_id = index_id;
+    _current_instance = nullptr;
 
     for (int i = 1; i < (int)allocator_data->_cur_file_id + 1; i++)
     {
@@ -96,30 +102,29 @@ void BingoAllocator::_load(const char* filename, size_t alloc_off, ObjArray<MMFi
         size_t file_size = _getFileSize(i, allocator_data->_min_file_size, allocator_data->_max_file_size, allocator_data->_existing_files);
 
         file.open(name.c_str(), file_size, false, read_only);
+        inst->_file_ptrs.push((byte*)file.ptr());
     }
 }
 
 BingoAllocator* BingoAllocator::_getInstance()
 {
+    if (_current_instance != nullptr)
+        return _current_instance;
+
     int database_id = MMFStorage::getDatabaseId();
-    if (_instances.size() <= database_id)
+    if (database_id < 0 || _instances.size() <= database_id)
         throw Exception("BingoAllocator: Incorrect session id");
 
     if (_instances[database_id] == 0)
         throw Exception("BingoAllocator: instance is not initialized");
 
-    return _instances[database_id];
+    _current_instance = _instances[database_id];
+    return _current_instance;
 }
 
-byte* BingoAllocator::_get(size_t file_id, size_t offset)
+void BingoAllocator::_resetCurrentInstance()
 {
-    // byte * mmf_ptr = (byte *)_mm_files->at(0).ptr();
-
-    //_BingoAllocatorData *allocator_data = (_BingoAllocatorData *)(mmf_ptr + _data_offset);
-
-    byte* file_ptr = (byte*)_mm_files->at((int)file_id).ptr();
-
-    return file_ptr + offset;
+    _current_instance = nullptr;
 }
 
 BingoAllocator::BingoAllocator()
@@ -179,6 +184,7 @@ void BingoAllocator::_addFile(size_t alloc_size)
     std::string name;
     _genFilename(_mm_files->size() - 1, _filename.c_str(), name);
     file.open(name.c_str(), file_size, true, false);
+    _file_ptrs.push((byte*)file.ptr());
 
     allocator_data->_cur_file_id++;
     allocator_data->_free_off = 0;
@@ -463,6 +463,9 @@ namespace bingo
 
         ObjArray<MMFile>* _mm_files;
 
+        // Base addresses of the mapped files, indexed by BingoAddr::file_id
+        Array<byte*> _file_ptrs;
+
         size_t _data_offset;
 
         static PtrArray<BingoAllocator> _instances;
@@ -504,7 +507,12 @@ namespace bingo
 
         static BingoAllocator* _getInstance();
 
-        byte* _get(size_t file_id, size_t offset);
+        static void _resetCurrentInstance();
+
+        byte* _get(size_t file_id, size_t offset)
+        {
+            return _file_ptrs.ptr()[file_id] + offset;
+        }
 
         BingoAllocator();
 
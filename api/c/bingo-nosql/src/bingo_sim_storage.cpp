@@ -24,7 +24,7 @@ void SimStorage::load(BingoPtr<SimStorage>& ptr, BingoAddr offset)
     ptr = BingoPtr<SimStorage>(offset);
 }
 
-void SimStorage::add(const byte* fingerprint, int id)
+void SimStorage::add(const byte* fingerprint, int id, bool defer_build)
 {
     if ((BingoAddr)_fingerprint_table == BingoAddr::bingo_null)
     {
@@ -37,14 +37,14 @@ void SimStorage::add(const byte* fingerprint, int id)
         {
             FingerprintTable::create(_fingerprint_table, _fp_size, _mt_size);
             for (int i = 0; i < _inc_fp_count; i++)
-                _fingerprint_table->add(_inc_buffer.ptr() + (i * _fp_size), _inc_id_buffer[i]);
+                _fingerprint_table->add(_inc_buffer.ptr() + (i * _fp_size), _inc_id_buffer[i], defer_build);
 
             _inc_fp_count = 0;
         }
     }
     else
     {
-        _fingerprint_table->add(fingerprint, id);
+        _fingerprint_table->add(fingerprint, id, defer_build);
     }
 }
 
@@ -24,7 +24,7 @@ namespace bingo
 
         static void load(BingoPtr<SimStorage>& ptr, BingoAddr offset);
 
-        void add(const byte* fingerprint, int id);
+        void add(const byte* fingerprint, int id, bool defer_build = false);
 
         void optimize();
 
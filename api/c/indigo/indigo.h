@@ -673,6 +673,10 @@ CEXPORT double indigoMonoisotopicMass(int molecule);
 CEXPORT const char* indigoMassComposition(int molecule);
 
 CEXPORT const char* indigoCanonicalSmiles(int molecule);
+// Returns 128-bit canonical hash of the molecule as 32 hexadecimal digits.
+// Molecules with equal canonical SMILES have equal hashes, but the SMILES
+// string itself is not generated.
+CEXPORT const char* indigoCanonicalHash(int molecule);
 CEXPORT const char* indigoLayeredCode(int molecule);
 
 CEXPORT const int* indigoSymmetryClasses(int molecule, int* count_out);
@@ -815,6 +819,14 @@ CEXPORT int indigoLoadFingerprintFromDescriptors(const double* arr, int arr_len,
 // "tversky" without numbers defaults to alpha = beta = 0.5
 CEXPORT float indigoSimilarity(int item1, int item2, const char* metrics);
 
+// Accepts a molecule, an array of molecules or a molecule iterator (which is
+// exhausted by the call) and calculates unfolded Morgan features.
+// Types: "ECFP2", "ECFP4", "ECFP6" or "ECFP8".
+// Returns count_out integers: for every molecule the number of distinct
+// features N followed by N pairs of (feature id, number of occurrences).
+// Feature ids are sorted and should be read as unsigned 32-bit numbers.
+CEXPORT const int* indigoMorganFeatures(int molecules, const char* type, int* count_out);
+
 /* Working with SDF/RDF/SMILES/CML/CDX files  */
 
 CEXPORT int indigoIterateSDF(int reader);
@@ -901,6 +913,17 @@ CEXPORT int indigoCountMatchesWithLimit(int matcher, int query, int embeddings_l
 // Returns substructure matches iterator
 CEXPORT int indigoIterateMatches(int matcher, int query);
 
+// Returns a new 'multi-query matcher' object for a library of queries.
+//   queries is an array of query molecules; the pattern id of each query
+//   is its index in the array.
+// 'mode' can be empty or "RES" for resonance matching
+CEXPORT int indigoMultiQuerySubstructureMatcher(int queries, const char* mode);
+
+// Returns ids of the library patterns that are substructures of the target.
+//   matcher is an object returned by indigoMultiQuerySubstructureMatcher.
+//   Target preparation is done once for all the patterns.
+CEXPORT const int* indigoMatchAll(int matcher, int target, int* count_out);
+
 // Accepts a 'match' object obtained from indigoMatchSubstructure.
 // Returns a new molecule which has the query highlighted.
 CEXPORT int indigoHighlightedTarget(int match);
@@ -1017,13 +1040,19 @@ CEXPORT const char* indigoDbgInternalType(int object);
 // Internal breakpoint
 CEXPORT void indigoDbgBreakpoint(void);
 
-// Methods that returns profiling infromation in a human readable format
+// Methods that returns profiling infromation in a human readable format.
+// The statistics are collected for the whole process and include all the
+// threads and all the Indigo sessions. Up to 16384 labels are recorded,
+// samples of further labels are dropped.
 CEXPORT const char* indigoDbgProfiling(int /*bool*/ whole_session);
 
-// Reset profiling counters either for the current state or for the whole session
+// Reset profiling counters either for the current state or for the whole session.
+// The counters are reset for the whole process, including the other threads
+// and Indigo sessions.
 CEXPORT int indigoDbgResetProfiling(int /*bool*/ whole_session);
 
-// Methods that returns profiling counter value for a particular counter
+// Methods that returns profiling counter value for a particular counter.
+// The value is collected over all the threads and Indigo sessions.
 CEXPORT qword indigoDbgProfilingGetCounter(const char* name, int /*bool*/ whole_session);
 
 #endif
@@ -94,6 +94,10 @@ void Indigo::init()
     ignore_closing_bond_direction_mismatch = false;
     ignore_bad_valence = false;
 
+    iterator_threads = 0;
+    iterator_ordered = true;
+    iterator_index = false;
+
     // Update global index
     static ThreadSafeStaticObj<OsLock> lock;
     {
@@ -104,19 +108,13 @@ void Indigo::init()
     }
 }
 
-Indigo::Indigo() : _next_id(1001)
+Indigo::Indigo()
 {
     init();
 }
 
 void Indigo::removeAllObjects()
 {
-    OsLocker lock(_objects_lock);
-    int i;
-
-    for (i = _objects.begin(); i != _objects.end(); i = _objects.next(i))
-        delete _objects.value(i);
-
     _objects.clear();
 }
 
@@ -234,40 +232,27 @@ CEXPORT void indigoSetErrorMessage(const char* message)
 
 int Indigo::addObject(IndigoObject* obj)
 {
-    OsLocker lock(_objects_lock);
-    int id = _next_id++;
-    _objects.insert(id, obj);
-    return id;
+    return _objects.add(obj);
 }
 
 void Indigo::removeObject(int id)
 {
-    OsLocker lock(_objects_lock);
-    if (_objects.at2(id) == 0)
-        return;
-    delete _objects.at(id);
-    _objects.remove(id);
+    delete _objects.remove(id);
 }
 
 IndigoObject& Indigo::getObject(int handle)
 {
-    OsLocker lock(_objects_lock);
+    IndigoObject* obj = _objects.get(handle);
 
-    try
-    {
-        return *_objects.at(handle);
-    }
-    catch (RedBlackMap<int, IndigoObject*>::Error& e)
-    {
-        throw IndigoError("can not access object #%d: %s", handle, e.message());
-    }
+    if (obj == nullptr)
+        throw IndigoError("can not access object #%d: object not found", handle);
+
+    return *obj;
 }
 
 int Indigo::countObjects()
 {
-    OsLocker lock(_objects_lock);
-
-    return _objects.size();
+    return _objects.count();
 }
 
 static TemporaryThreadObjManager<Indigo::TmpData> _indigo_temporary_obj_manager;
@@ -22,10 +22,12 @@
 #include <memory>
 #include "base_cpp/output.h"
 #include "base_cpp/scanner.h"
+#include "indigo_array.h"
 #include "indigo_io.h"
 #include "indigo_molecule.h"
 #include "indigo_reaction.h"
 #include "molecule/molecule_fingerprint.h"
+#include "molecule/molecule_morgan_fingerprint_builder.h"
 #include "reaction/reaction.h"
 #include "reaction/reaction_fingerprint.h"
 #include <math.h>
@@ -509,4 +511,73 @@ CEXPORT const char* indigoOneBitsList(int fingerprint)
         return tmp.string.ptr();
     }
     INDIGO_END(0);
-}
\ No newline at end of file
+}
+
+CEXPORT const int* indigoMorganFeatures(int molecules, const char* type, int* count_out)
+{
+    INDIGO_BEGIN
+    {
+        IndigoObject& obj = self.getObject(molecules);
+
+        SimilarityType sim_type = MoleculeFingerprintBuilder::parseSimilarityType(type);
+        int order = MoleculeFingerprintBuilder::getSimilarityTypeOrder(sim_type);
+        if (order <= 0)
+            throw IndigoError("indigoMorganFeatures(): %s is not a Morgan fingerprint type", type);
+        bool fcfp = (sim_type >= SimilarityType::FCFP2);
+
+        MoleculeMorganFeaturesBatch batch;
+
+        auto addMolecule = [&](IndigoObject& item) {
+            BaseMolecule& mol = item.getBaseMolecule();
+            if (fcfp)
+                batch.addFCFP(mol, order);
+            else
+                batch.addECFP(mol, order);
+        };
+
+        if (IndigoBaseMolecule::is(obj))
+            addMolecule(obj);
+        else if (IndigoArray::is(obj))
+        {
+            IndigoArray& arr = IndigoArray::cast(obj);
+            for (int i = 0; i < arr.objects.size(); i++)
+                addMolecule(*arr.objects[i]);
+        }
+        else
+        {
+            while (true)
+            {
+                std::unique_ptr<IndigoObject> item(obj.next());
+                if (item == nullptr)
+                    break;
+                addMolecule(*item);
+            }
+        }
+
+        QS_DEF(Array<int>, res);
+        res.clear();
+        for (int i = 0; i < batch.count(); i++)
+        {
+            const dword* ids;
+            const int* counts;
+            int n = batch.getFeatures(i, ids, counts);
+            res.push(n);
+            for (int j = 0; j < n; j++)
+            {
+                res.push((int)ids[j]);
+                res.push(counts[j]);
+            }
+        }
+
+        auto& tmp = self.getThreadTmpData();
+        tmp.string.copy((char*)res.ptr(), res.sizeInBytes());
+        // Keep the returned pointer non-null when there are no molecules
+        tmp.string.push(0);
+
+        if (count_out != 0)
+            *count_out = res.size();
+
+        return (const int*)tmp.string.ptr();
+    }
+    INDIGO_END(0);
+}
@@ -0,0 +1,156 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#include "indigo_handle_table.h"
+
+#include <functional>
+#include <thread>
+
+#include "indigo_internal.h"
+
+IndigoHandleTable::IndigoHandleTable() : _slots_count(0), _objects_count(0)
+{
+    for (int i = 0; i < MAX_SEGMENTS; i++)
+        _segments[i].store(nullptr, std::memory_order_relaxed);
+}
+
+IndigoHandleTable::~IndigoHandleTable()
+{
+    for (int i = 0; i < MAX_SEGMENTS; i++)
+        delete[] _segments[i].load(std::memory_order_relaxed);
+}
+
+int IndigoHandleTable::add(IndigoObject* obj)
+{
+    int slot = -1;
+
+    // Reuse a slot from the own free list first, then from the lists of the other
+    // threads, so objects freed by another thread do not make the table grow
+    int first = _threadFreeListIndex();
+    for (int i = 0; i < FREE_LISTS_COUNT && slot == -1; i++)
+    {
+        _FreeList& free_list = _free_lists[(first + i) % FREE_LISTS_COUNT];
+        std::lock_guard<std::mutex> guard(free_list.lock);
+        if (!free_list.slots.empty())
+        {
+            slot = free_list.slots.back();
+            free_list.slots.pop_back();
+        }
+    }
+
+    if (slot == -1)
+    {
+        slot = _slots_count++;
+        if (slot >= (1 << SLOT_BITS))
+        {
+            _slots_count--;
+            throw IndigoError("too many objects (%d) in the session", slot);
+        }
+
+        int segment = slot >> SEGMENT_BITS;
+        if (_segments[segment].load(std::memory_order_acquire) == nullptr)
+        {
+            std::lock_guard<std::mutex> guard(_segments_lock);
+            if (_segments[segment].load(std::memory_order_relaxed) == nullptr)
+                _segments[segment].store(new _Slot[SEGMENT_SIZE](), std::memory_order_release);
+        }
+    }
+
+    _Slot* s = _getSlot(slot);
+
+    int generation = -s->generation.load(std::memory_order_relaxed) % GENERATION_MASK + 1;
+    s->object.store(obj, std::memory_order_relaxed);
+    s->generation.store(generation, std::memory_order_release);
+    _objects_count++;
+
+    return (generation << SLOT_BITS) | slot;
+}
+
+IndigoObject* IndigoHandleTable::get(int handle) const
+{
+    if (handle <= 0)
+        return nullptr;
+
+    _Slot* s = _getSlot(handle & ((1 << SLOT_BITS) - 1));
+    if (s == nullptr || s->generation.load(std::memory_order_acquire) != (handle >> SLOT_BITS))
+        return nullptr;
+
+    return s->object.load(std::memory_order_relaxed);
+}
+
+IndigoObject* IndigoHandleTable::remove(int handle)
+{
+    if (handle <= 0)
+        return nullptr;
+
+    int slot = handle & ((1 << SLOT_BITS) - 1);
+    _Slot* s = _getSlot(slot);
+    if (s == nullptr)
+        return nullptr;
+
+    // Only one of the concurrent removers of the same handle succeeds
+    int generation = handle >> SLOT_BITS;
+    if (!s->generation.compare_exchange_strong(generation, -generation, std::memory_order_acq_rel))
+        return nullptr;
+
+    IndigoObject* obj = s->object.exchange(nullptr, std::memory_order_acquire);
+    _objects_count--;
+
+    _FreeList& free_list = _free_lists[_threadFreeListIndex()];
+    std::lock_guard<std::mutex> guard(free_list.lock);
+    free_list.slots.push_back(slot);
+
+    return obj;
+}
+
+void IndigoHandleTable::clear()
+{
+    int slots_count = _slots_count.load();
+
+    for (int slot = 0; slot < slots_count; slot++)
+    {
+        _Slot* s = _getSlot(slot);
+        if (s == nullptr)
+            continue;
+
+        int generation = s->generation.load(std::memory_order_acquire);
+        if (generation > 0)
+            delete remove((generation << SLOT_BITS) | slot);
+    }
+}
+
+int IndigoHandleTable::count() const
+{
+    return _objects_count.load();
+}
+
+IndigoHandleTable::_Slot* IndigoHandleTable::_getSlot(int slot) const
+{
+    _Slot* segment = _segments[slot >> SEGMENT_BITS].load(std::memory_order_acquire);
+    if (segment == nullptr)
+        return nullptr;
+
+    return segment + (slot & (SEGMENT_SIZE - 1));
+}
+
+int IndigoHandleTable::_threadFreeListIndex()
+{
+    static thread_local size_t thread_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    return (int)(thread_hash % FREE_LISTS_COUNT);
+}
@@ -0,0 +1,90 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#ifndef __indigo_handle_table__
+#define __indigo_handle_table__
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class IndigoObject;
+
+// Table of the objects owned by an Indigo session. A handle packs a slot
+// index and the slot generation, so stale handles of freed objects are
+// rejected. Lookups are lock-free; removed slots go to one of several free
+// lists chosen by the calling thread, and adding an object takes a slot from
+// the own list first and from the lists of the other threads before growing.
+class IndigoHandleTable
+{
+public:
+    IndigoHandleTable();
+    ~IndigoHandleTable();
+
+    int add(IndigoObject* obj);
+
+    // Returns nullptr for unknown or already removed handles
+    IndigoObject* get(int handle) const;
+
+    // Detaches the object from the table and returns it, nullptr for unknown handles
+    IndigoObject* remove(int handle);
+
+    // Deletes all the objects
+    void clear();
+
+    int count() const;
+
+private:
+    IndigoHandleTable(const IndigoHandleTable&) = delete;
+    IndigoHandleTable& operator=(const IndigoHandleTable&) = delete;
+
+    enum
+    {
+        SLOT_BITS = 24,
+        GENERATION_MASK = 0x3F,
+        SEGMENT_BITS = 12,
+        SEGMENT_SIZE = 1 << SEGMENT_BITS,
+        MAX_SEGMENTS = 1 << (SLOT_BITS - SEGMENT_BITS),
+        FREE_LISTS_COUNT = 16
+    };
+
+    struct _Slot
+    {
+        std::atomic<IndigoObject*> object;
+        // Positive value is the generation of the live object, negative one is
+        // the generation of the last removed object
+        std::atomic<int> generation;
+    };
+
+    struct _FreeList
+    {
+        std::mutex lock;
+        std::vector<int> slots;
+    };
+
+    _Slot* _getSlot(int slot) const;
+    static int _threadFreeListIndex();
+
+    std::atomic<_Slot*> _segments[MAX_SEGMENTS];
+    std::atomic<int> _slots_count;
+    std::atomic<int> _objects_count;
+    std::mutex _segments_lock;
+    _FreeList _free_lists[FREE_LISTS_COUNT];
+};
+
+#endif
@@ -40,6 +40,7 @@
 #include "molecule/molecule_standardize_options.h"
 #include "molecule/molecule_stereocenter_options.h"
 #include "molecule/molecule_tautomer.h"
+#include "indigo_handle_table.h"
 #include "option_manager.h"
 
 /* When Indigo internal code is used dynamically the INDIGO_VERSION define
@@ -161,6 +162,7 @@ public:
         GROSS_REACTION,
         JSON_MOLECULE,
         JSON_REACTION,
+        MULTI_QUERY_SUBSTRUCTURE_MATCHER,
         INDIGO_OBJECT_LAST_TYPE // must be the last element in the enum
     };
 
@@ -301,6 +303,12 @@ public:
     bool ignore_closing_bond_direction_mismatch;
     bool ignore_bad_valence;
 
+    // File iterators parse records ahead of the consumer when more than one thread is set
+    int iterator_threads;
+    bool iterator_ordered;
+    // SDF and RDF file iterators keep record offsets in a "<file>.idx" sidecar file
+    bool iterator_index;
+
     bool deconvolution_aromatization;
     bool deco_save_ap_bond_orders;
     bool deco_ignore_errors;
@@ -348,10 +356,7 @@ public:
     bool scsr_ignore_chem_templates;
 
 protected:
-    RedBlackMap<int, IndigoObject*> _objects;
-
-    int _next_id;
-    OsLock _objects_lock;
+    IndigoHandleTable _objects;
 
     int _indigo_id;
 };
@@ -17,6 +17,7 @@
  ***************************************************************************/
 
 #include "indigo_loaders.h"
+#include "base_cpp/output.h"
 #include "base_cpp/scanner.h"
 #include "indigo_io.h"
 #include "indigo_molecule.h"
@@ -36,7 +37,68 @@
 #include "reaction/rsmiles_loader.h"
 #include "reaction/rxnfile_loader.h"
 
+#include <functional>
 #include <limits>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Unique name next to the file, so that concurrent writers do not share it
+    std::string temporaryFilename(const std::string& filename)
+    {
+#ifdef _WIN32
+        int pid = _getpid();
+#else
+        int pid = getpid();
+#endif
+        std::ostringstream name;
+        name << filename << ".tmp." << pid << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+        return name.str();
+    }
+
+    // Loads the "<filename>.idx" offset index, building it first if it is missing or
+    // does not match the file. Returns nullptr if the index can not be used, e.g. for
+    // gzipped files or when the index can not be written.
+    std::unique_ptr<RecordOffsetIndex> loadRecordIndex(const std::string& filename, Scanner& scanner, bool can_save,
+                                                       const std::function<void(Output&, long long)>& save)
+    {
+        Indigo& self = indigoGetInstance();
+        std::string index_filename = filename + ".idx";
+        auto index = std::make_unique<RecordOffsetIndex>();
+        long long mtime = fileModificationTime(self.filename_encoding, filename.c_str());
+
+        if (!can_save || mtime < 0)
+            return nullptr;
+        if (index->load(self.filename_encoding, index_filename.c_str(), scanner, mtime))
+            return index;
+
+        // The index is written to a temporary file and renamed, so a partial write
+        // never leaves a truncated index behind
+        std::string tmp_filename = temporaryFilename(index_filename);
+        try
+        {
+            {
+                FileOutput output(self.filename_encoding, tmp_filename.c_str());
+                save(output, mtime);
+            }
+            if (renameFile(self.filename_encoding, tmp_filename.c_str(), index_filename.c_str()) &&
+                index->load(self.filename_encoding, index_filename.c_str(), scanner, mtime))
+                return index;
+        }
+        catch (Exception&)
+        {
+        }
+        removeFile(self.filename_encoding, tmp_filename.c_str());
+        return nullptr;
+    }
+}
 
 IndigoJSONMolecule::IndigoJSONMolecule(rapidjson::Value& node, rapidjson::Value& rgroups, int index)
     : IndigoObject(JSON_MOLECULE), _node(node), _rgroups(rgroups), _loaded(false)
@@ -75,20 +137,24 @@ IndigoJSONMolecule::~IndigoJSONMolecule()
 {
 }
 
-IndigoSdfLoader::IndigoSdfLoader(Scanner& scanner) : IndigoObject(SDF_LOADER)
+IndigoSdfLoader::IndigoSdfLoader(Scanner& scanner) : IndigoObject(SDF_LOADER), _prefetch_start(0)
 {
     sdf_loader = std::make_unique<SdfLoader>(scanner);
 }
 
-IndigoSdfLoader::IndigoSdfLoader(const char* filename) : IndigoObject(SDF_LOADER)
+IndigoSdfLoader::IndigoSdfLoader(const char* filename) : IndigoObject(SDF_LOADER), _prefetch_start(0)
 {
     // AutoPtr guard in case of exception in SdfLoader (happens in case of empty file)
-    _own_scanner = std::make_unique<FileScanner>(indigoGetInstance().filename_encoding, filename);
+    _own_scanner = std::make_unique<MappedFileScanner>(indigoGetInstance().filename_encoding, filename);
     sdf_loader = std::make_unique<SdfLoader>(*_own_scanner);
+    _filename = filename;
 }
 
 IndigoSdfLoader::~IndigoSdfLoader()
 {
+    // The loader can run threads reading the source scanner, so it is destroyed first
+    _prefetcher.reset();
+    sdf_loader.reset();
 }
 
 IndigoRdfData::IndigoRdfData(int type, Array<char>& data, int index, long long offset) : IndigoObject(type)
@@ -243,6 +309,24 @@ IndigoRdfReaction::~IndigoRdfReaction()
 }
 
 IndigoObject* IndigoSdfLoader::next()
+{
+    if (_prefetcher == nullptr)
+    {
+        _prefetch_start = sdf_loader->currentNumber();
+        _prefetcher = IndigoPrefetcher::create(
+            [this](long long& end_offset) {
+                IndigoObject* obj = _readNext();
+                end_offset = sdf_loader->tell();
+                return obj;
+            },
+            sdf_loader->tell());
+    }
+    if (_prefetcher != nullptr)
+        return _prefetcher->next();
+    return _readNext();
+}
+
+IndigoObject* IndigoSdfLoader::_readNext()
 {
     if (sdf_loader->isEOF())
         return 0;
@@ -255,8 +339,36 @@ IndigoObject* IndigoSdfLoader::next()
     return new IndigoRdfMolecule(sdf_loader->data, sdf_loader->properties, counter, offset);
 }
 
+void IndigoSdfLoader::_stopPrefetch()
+{
+    if (_prefetcher == nullptr)
+        return;
+
+    // In the ordered mode the records after the delivered ones are read again
+    bool ordered = _prefetcher->ordered();
+    int index = _prefetch_start + (int)_prefetcher->deliveredCount();
+    _prefetcher.reset();
+    if (ordered)
+        sdf_loader->seekToRecord(index);
+}
+
+void IndigoSdfLoader::_loadIndex()
+{
+    // The index is looked for once, when random access is needed for the first time
+    if (_filename.empty() || !indigoGetInstance().iterator_index)
+        return;
+
+    _index = loadRecordIndex(_filename, *_own_scanner, sdf_loader->canSaveIndex(),
+                             [this](Output& output, long long mtime) { sdf_loader->saveIndex(output, mtime); });
+    if (_index != nullptr)
+        sdf_loader->useIndex(_index.get());
+    _filename.clear();
+}
+
 IndigoObject* IndigoSdfLoader::at(int index)
 {
+    _stopPrefetch();
+    _loadIndex();
     sdf_loader->readAt(index);
 
     return new IndigoRdfMolecule(sdf_loader->data, sdf_loader->properties, index, 0LL);
@@ -264,30 +376,66 @@ IndigoObject* IndigoSdfLoader::at(int index)
 
 bool IndigoSdfLoader::hasNext()
 {
+    if (_prefetcher != nullptr)
+        return _prefetcher->hasNext();
     return !sdf_loader->isEOF();
 }
 
 long long IndigoSdfLoader::tell()
 {
+    if (_prefetcher != nullptr)
+        return _prefetcher->tell();
     return sdf_loader->tell();
 }
 
-IndigoRdfLoader::IndigoRdfLoader(Scanner& scanner) : IndigoObject(RDF_LOADER)
+int IndigoSdfLoader::count()
+{
+    if (_prefetcher != nullptr && !_prefetcher->ordered())
+        throw IndigoError("can not count records during unordered iteration");
+
+    _stopPrefetch();
+    _loadIndex();
+    return sdf_loader->count();
+}
+
+IndigoRdfLoader::IndigoRdfLoader(Scanner& scanner) : IndigoObject(RDF_LOADER), _prefetch_start(0)
 {
     rdf_loader = std::make_unique<RdfLoader>(scanner);
 }
 
-IndigoRdfLoader::IndigoRdfLoader(const char* filename) : IndigoObject(RDF_LOADER)
+IndigoRdfLoader::IndigoRdfLoader(const char* filename) : IndigoObject(RDF_LOADER), _prefetch_start(0)
 {
-    _own_scanner = std::make_unique<FileScanner>(indigoGetInstance().filename_encoding, filename);
+    _own_scanner = std::make_unique<MappedFileScanner>(indigoGetInstance().filename_encoding, filename);
     rdf_loader = std::make_unique<RdfLoader>(*_own_scanner);
+    _filename = filename;
 }
 
 IndigoRdfLoader::~IndigoRdfLoader()
 {
+    // The loader can run threads reading the source scanner, so it is destroyed first
+    _prefetcher.reset();
+    rdf_loader.reset();
 }
 
 IndigoObject* IndigoRdfLoader::next()
+{
+    if (_prefetcher == nullptr)
+    {
+        _prefetch_start = rdf_loader->currentNumber();
+        _prefetcher = IndigoPrefetcher::create(
+            [this](long long& end_offset) {
+                IndigoObject* obj = _readNext();
+                end_offset = rdf_loader->tell();
+                return obj;
+            },
+            rdf_loader->tell());
+    }
+    if (_prefetcher != nullptr)
+        return _prefetcher->next();
+    return _readNext();
+}
+
+IndigoObject* IndigoRdfLoader::_readNext()
 {
     if (rdf_loader->isEOF())
         return 0;
@@ -303,8 +451,35 @@ IndigoObject* IndigoRdfLoader::next()
         return new IndigoRdfReaction(rdf_loader->data, rdf_loader->properties, counter, offset);
 }
 
+void IndigoRdfLoader::_stopPrefetch()
+{
+    if (_prefetcher == nullptr)
+        return;
+
+    bool ordered = _prefetcher->ordered();
+    int index = _prefetch_start + (int)_prefetcher->deliveredCount();
+    _prefetcher.reset();
+    if (ordered)
+        rdf_loader->seekToRecord(index);
+}
+
+void IndigoRdfLoader::_loadIndex()
+{
+    // The index is looked for once, when random access is needed for the first time
+    if (_filename.empty() || !indigoGetInstance().iterator_index)
+        return;
+
+    _index = loadRecordIndex(_filename, *_own_scanner, rdf_loader->canSaveIndex(),
+                             [this](Output& output, long long mtime) { rdf_loader->saveIndex(output, mtime); });
+    if (_index != nullptr)
+        rdf_loader->useIndex(_index.get());
+    _filename.clear();
+}
+
 IndigoObject* IndigoRdfLoader::at(int index)
 {
+    _stopPrefetch();
+    _loadIndex();
     rdf_loader->readAt(index);
 
     if (rdf_loader->isMolecule())
@@ -315,14 +490,28 @@ IndigoObject* IndigoRdfLoader::at(int index)
 
 long long IndigoRdfLoader::tell()
 {
+    if (_prefetcher != nullptr)
+        return _prefetcher->tell();
     return rdf_loader->tell();
 }
 
 bool IndigoRdfLoader::hasNext()
 {
+    if (_prefetcher != nullptr)
+        return _prefetcher->hasNext();
     return !rdf_loader->isEOF();
 }
 
+int IndigoRdfLoader::count()
+{
+    if (_prefetcher != nullptr && !_prefetcher->ordered())
+        throw IndigoError("can not count records during unordered iteration");
+
+    _stopPrefetch();
+    _loadIndex();
+    return rdf_loader->count();
+}
+
 IndigoSmilesMolecule::IndigoSmilesMolecule(Array<char>& smiles, int index, long long offset) : IndigoRdfData(SMILES_MOLECULE, smiles, index, offset)
 {
 }
@@ -409,7 +598,8 @@ IndigoObject* IndigoSmilesReaction::clone()
 
 CP_DEF(IndigoMultilineSmilesLoader);
 
-IndigoMultilineSmilesLoader::IndigoMultilineSmilesLoader(Scanner& scanner) : IndigoObject(MULTILINE_SMILES_LOADER), CP_INIT, TL_CP_GET(_offsets)
+IndigoMultilineSmilesLoader::IndigoMultilineSmilesLoader(Scanner& scanner)
+    : IndigoObject(MULTILINE_SMILES_LOADER), CP_INIT, TL_CP_GET(_offsets), _prefetch_start(0)
 {
     _scanner = &scanner;
 
@@ -418,9 +608,10 @@ IndigoMultilineSmilesLoader::IndigoMultilineSmilesLoader(Scanner& scanner) : Ind
     _offsets.clear();
 }
 
-IndigoMultilineSmilesLoader::IndigoMultilineSmilesLoader(const char* filename) : IndigoObject(MULTILINE_SMILES_LOADER), CP_INIT, TL_CP_GET(_offsets)
+IndigoMultilineSmilesLoader::IndigoMultilineSmilesLoader(const char* filename)
+    : IndigoObject(MULTILINE_SMILES_LOADER), CP_INIT, TL_CP_GET(_offsets), _prefetch_start(0)
 {
-    _own_scanner = std::make_unique<FileScanner>(indigoGetInstance().filename_encoding, filename);
+    _own_scanner = std::make_unique<MappedFileScanner>(indigoGetInstance().filename_encoding, filename);
     _scanner = _own_scanner.get();
 
     _current_number = 0;
@@ -443,6 +634,24 @@ void IndigoMultilineSmilesLoader::_advance()
 }
 
 IndigoObject* IndigoMultilineSmilesLoader::next()
+{
+    if (_prefetcher == nullptr)
+    {
+        _prefetch_start = _current_number;
+        _prefetcher = IndigoPrefetcher::create(
+            [this](long long& end_offset) {
+                IndigoObject* obj = _readNext();
+                end_offset = _scanner->tell();
+                return obj;
+            },
+            _scanner->tell());
+    }
+    if (_prefetcher != nullptr)
+        return _prefetcher->next();
+    return _readNext();
+}
+
+IndigoObject* IndigoMultilineSmilesLoader::_readNext()
 {
     if (_scanner->isEOF())
         return 0;
@@ -460,16 +669,40 @@ IndigoObject* IndigoMultilineSmilesLoader::next()
 
 bool IndigoMultilineSmilesLoader::hasNext()
 {
+    if (_prefetcher != nullptr)
+        return _prefetcher->hasNext();
     return !_scanner->isEOF();
 }
 
 long long IndigoMultilineSmilesLoader::tell()
 {
+    if (_prefetcher != nullptr)
+        return _prefetcher->tell();
     return _scanner->tell();
 }
 
+void IndigoMultilineSmilesLoader::_stopPrefetch()
+{
+    if (_prefetcher == nullptr)
+        return;
+
+    bool ordered = _prefetcher->ordered();
+    int index = _prefetch_start + (int)_prefetcher->deliveredCount();
+    _prefetcher.reset();
+    if (ordered)
+    {
+        _scanner->seek(index < _offsets.size() ? _offsets[index] : _max_offset, SEEK_SET);
+        _current_number = index;
+    }
+}
+
 int IndigoMultilineSmilesLoader::count()
 {
+    if (_prefetcher != nullptr && !_prefetcher->ordered())
+        throw IndigoError("can not count records during unordered iteration");
+
+    _stopPrefetch();
+
     long long offset = _scanner->tell();
     int cn = _current_number;
 
@@ -495,17 +728,19 @@ int IndigoMultilineSmilesLoader::count()
 
 IndigoObject* IndigoMultilineSmilesLoader::at(int index)
 {
+    _stopPrefetch();
+
     if (index < _offsets.size())
     {
         _scanner->seek(_offsets[index], SEEK_SET);
         _current_number = index;
-        return next();
+        return _readNext();
     }
     _scanner->seek(_max_offset, SEEK_SET);
     _current_number = _offsets.size();
     while (index > _offsets.size())
         _advance();
-    return next();
+    return _readNext();
 }
 
 CEXPORT int indigoIterateSDF(int reader)
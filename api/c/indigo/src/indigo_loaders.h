@@ -20,10 +20,14 @@
 #define __indigo_loaders__
 
 #include "indigo_internal.h"
+#include "indigo_prefetcher.h"
+
+#include <string>
 
 #include <rapidjson/document.h>
 
 #include "base_cpp/properties_map.h"
+#include "base_cpp/record_offset_index.h"
 #include "molecule/molecule.h"
 #include "reaction/reaction.h"
 #include "molecule/query_molecule.h"
@@ -94,10 +98,22 @@ public:
     bool hasNext() override;
     IndigoObject* at(int index);
     long long tell();
+    int count();
     std::unique_ptr<SdfLoader> sdf_loader;
 
 protected:
+    IndigoObject* _readNext();
+    void _stopPrefetch();
+    void _loadIndex();
+
     std::unique_ptr<Scanner> _own_scanner;
+
+    std::string _filename;
+    std::unique_ptr<RecordOffsetIndex> _index;
+
+    int _prefetch_start;
+    // Declared last to stop the prefetching threads before the loader is destroyed
+    std::unique_ptr<IndigoPrefetcher> _prefetcher;
 };
 
 /*
@@ -130,11 +146,22 @@ public:
     IndigoObject* at(int index);
 
     long long tell();
+    int count();
 
     std::unique_ptr<RdfLoader> rdf_loader;
 
 protected:
+    IndigoObject* _readNext();
+    void _stopPrefetch();
+    void _loadIndex();
+
     std::unique_ptr<Scanner> _own_scanner;
+
+    std::string _filename;
+    std::unique_ptr<RecordOffsetIndex> _index;
+
+    int _prefetch_start;
+    std::unique_ptr<IndigoPrefetcher> _prefetcher;
 };
 
 
@@ -206,11 +233,16 @@ protected:
     std::unique_ptr<Scanner> _own_scanner;
 
     void _advance();
+    IndigoObject* _readNext();
+    void _stopPrefetch();
 
     CP_DECL;
     TL_CP_DECL(Array<long long>, _offsets);
     int _current_number;
     long long _max_offset;
+
+    int _prefetch_start;
+    std::unique_ptr<IndigoPrefetcher> _prefetcher;
 };
 
 namespace indigo
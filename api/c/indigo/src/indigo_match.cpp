@@ -18,6 +18,7 @@
 
 #include "indigo_match.h"
 #include "base_cpp/scanner.h"
+#include "indigo_array.h"
 #include "indigo_mapping.h"
 #include "indigo_molecule.h"
 #include "indigo_reaction.h"
@@ -1031,3 +1032,74 @@ IndigoReactionSubstructureMatcher& IndigoReactionSubstructureMatcher::cast(Indig
 
     return (IndigoReactionSubstructureMatcher&)obj;
 }
+
+IndigoMultiQuerySubstructureMatcher::IndigoMultiQuerySubstructureMatcher() : IndigoObject(MULTI_QUERY_SUBSTRUCTURE_MATCHER)
+{
+}
+
+IndigoMultiQuerySubstructureMatcher::~IndigoMultiQuerySubstructureMatcher()
+{
+}
+
+const char* IndigoMultiQuerySubstructureMatcher::debugInfo()
+{
+    return "<multi-query substructure matcher>";
+}
+
+IndigoMultiQuerySubstructureMatcher& IndigoMultiQuerySubstructureMatcher::cast(IndigoObject& obj)
+{
+    if (obj.type != IndigoObject::MULTI_QUERY_SUBSTRUCTURE_MATCHER)
+        throw IndigoError("%s is not a multi-query matcher object", obj.debugInfo());
+
+    return (IndigoMultiQuerySubstructureMatcher&)obj;
+}
+
+CEXPORT int indigoMultiQuerySubstructureMatcher(int queries, const char* mode_str)
+{
+    INDIGO_BEGIN
+    {
+        IndigoArray& arr = IndigoArray::cast(self.getObject(queries));
+        bool resonance = false;
+
+        if (mode_str != 0 && *mode_str != 0)
+        {
+            if (strcasecmp(mode_str, "RES") == 0)
+                resonance = true;
+            else
+                throw IndigoError("indigoMultiQuerySubstructureMatcher(): unsupported mode %s", mode_str);
+        }
+
+        std::unique_ptr<IndigoMultiQuerySubstructureMatcher> matcher = std::make_unique<IndigoMultiQuerySubstructureMatcher>();
+        matcher->matcher.arom_options = self.arom_options;
+        matcher->matcher.use_pi_systems_matcher = resonance;
+
+        for (int i = 0; i < arr.objects.size(); i++)
+            matcher->matcher.addQuery(arr.objects[i]->getQueryMolecule());
+
+        return self.addObject(matcher.release());
+    }
+    INDIGO_END(-1);
+}
+
+CEXPORT const int* indigoMatchAll(int matcher, int target, int* count_out)
+{
+    INDIGO_BEGIN
+    {
+        IndigoMultiQuerySubstructureMatcher& mq = IndigoMultiQuerySubstructureMatcher::cast(self.getObject(matcher));
+        Molecule& mol = self.getObject(target).getMolecule();
+
+        QS_DEF(Array<int>, ids);
+        mq.matcher.match(mol, ids);
+
+        auto& tmp = self.getThreadTmpData();
+        tmp.string.copy((char*)ids.ptr(), ids.sizeInBytes());
+        // Keep the returned pointer non-null when nothing matched
+        tmp.string.push(0);
+
+        if (count_out != 0)
+            *count_out = ids.size();
+
+        return (const int*)tmp.string.ptr();
+    }
+    INDIGO_END(0);
+}
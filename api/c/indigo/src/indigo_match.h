@@ -24,6 +24,7 @@
 #include "molecule/molecule_substructure_matcher.h"
 #include "molecule/molecule_tautomer_matcher.h"
 #include "molecule/molecule_tautomer_substructure_matcher.h"
+#include "molecule/multi_query_substructure_matcher.h"
 #include "reaction/reaction.h"
 #include "reaction/reaction_substructure_matcher.h"
 
@@ -164,6 +165,20 @@ public:
     Array<int> mol_mapping;
 };
 
+// Matcher class for matching a library of queries on many targets
+class DLLEXPORT IndigoMultiQuerySubstructureMatcher : public IndigoObject
+{
+public:
+    IndigoMultiQuerySubstructureMatcher();
+    ~IndigoMultiQuerySubstructureMatcher() override;
+
+    static IndigoMultiQuerySubstructureMatcher& cast(IndigoObject& obj);
+
+    const char* debugInfo() override;
+
+    MultiQuerySubstructureMatcher matcher;
+};
+
 DLLEXPORT bool _indigoParseTautomerFlags(const char* flags, IndigoTautomerParams& params);
 DLLEXPORT int _indigoParseExactFlags(const char* flags, bool reaction, float* rms_threshold);
 
@@ -32,6 +32,7 @@
 #include "molecule/icm_saver.h"
 #include "molecule/molecule_arom.h"
 #include "molecule/molecule_automorphism_search.h"
+#include "molecule/molecule_canonicalizer.h"
 #include "molecule/molecule_dearom.h"
 #include "molecule/molecule_ionize.h"
 #include "molecule/molecule_standardize.h"
@@ -402,6 +403,26 @@ CEXPORT const char* indigoCanonicalSmiles(int item)
     INDIGO_END(0);
 }
 
+CEXPORT const char* indigoCanonicalHash(int molecule)
+{
+    INDIGO_BEGIN
+    {
+        Molecule& mol = self.getObject(molecule).getMolecule();
+        auto& tmp = self.getThreadTmpData();
+        ArrayOutput out(tmp.string);
+
+        QS_DEF(MoleculeCanonicalizer, canonicalizer);
+        MoleculeCanonicalizer::Hash hash = canonicalizer.hash(mol);
+
+        tmp.string.clear();
+        out.printf("%08x%08x%08x%08x", (dword)(hash.hi >> 32), (dword)hash.hi, (dword)(hash.lo >> 32), (dword)hash.lo);
+        out.writeChar(0);
+
+        return tmp.string.ptr();
+    }
+    INDIGO_END(0);
+}
+
 CEXPORT const char* indigoSmarts(int item)
 {
     INDIGO_BEGIN
@@ -627,10 +648,10 @@ CEXPORT int indigoCount(int item)
             return IndigoArray::cast(obj).objects.size();
 
         if (obj.type == IndigoObject::SDF_LOADER)
-            return ((IndigoSdfLoader&)obj).sdf_loader->count();
+            return ((IndigoSdfLoader&)obj).count();
 
         if (obj.type == IndigoObject::RDF_LOADER)
-            return ((IndigoRdfLoader&)obj).rdf_loader->count();
+            return ((IndigoRdfLoader&)obj).count();
 
         if (obj.type == IndigoObject::MULTILINE_SMILES_LOADER)
             return ((IndigoMultilineSmilesLoader&)obj).count();
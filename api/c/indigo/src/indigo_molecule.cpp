@@ -1448,7 +1448,10 @@ CEXPORT int indigoResetCharge(int atom)
         BaseMolecule& mol = ia.mol;
 
         if (mol.isQueryMolecule())
+        {
             mol.asQueryMolecule().getAtom(ia.idx).removeConstraints(QueryMolecule::ATOM_CHARGE);
+            mol.invalidateAtom(ia.idx, BaseMolecule::CHANGED_ALL);
+        }
         else
             mol.asMolecule().setAtomCharge(ia.idx, 0);
         return 1;
@@ -1464,7 +1467,10 @@ CEXPORT int indigoResetExplicitValence(int atom)
         BaseMolecule& mol = ia.mol;
 
         if (mol.isQueryMolecule())
+        {
             mol.asQueryMolecule().getAtom(ia.idx).removeConstraints(QueryMolecule::ATOM_VALENCE);
+            mol.invalidateAtom(ia.idx, BaseMolecule::CHANGED_ALL);
+        }
         else
             mol.asMolecule().resetExplicitValence(ia.idx);
         return 1;
@@ -1480,7 +1486,10 @@ CEXPORT int indigoResetRadical(int atom)
         BaseMolecule& mol = ia.mol;
 
         if (mol.isQueryMolecule())
+        {
             mol.asQueryMolecule().getAtom(ia.idx).removeConstraints(QueryMolecule::ATOM_RADICAL);
+            mol.invalidateAtom(ia.idx, BaseMolecule::CHANGED_ALL);
+        }
         else
             mol.asMolecule().setAtomRadical(ia.idx, 0);
         return 1;
@@ -1496,7 +1505,10 @@ CEXPORT int indigoResetIsotope(int atom)
         BaseMolecule& mol = ia.mol;
 
         if (mol.isQueryMolecule())
+        {
             mol.asQueryMolecule().getAtom(ia.idx).removeConstraints(QueryMolecule::ATOM_ISOTOPE);
+            mol.invalidateAtom(ia.idx, BaseMolecule::CHANGED_ALL);
+        }
         else
             mol.asMolecule().setAtomIsotope(ia.idx, 0);
         return 1;
@@ -1512,6 +1524,7 @@ CEXPORT int indigoResetRsite(int atom)
         BaseMolecule& mol = ia.mol;
 
         mol.asQueryMolecule().getAtom(ia.idx).removeConstraints(QueryMolecule::ATOM_RSITE);
+        mol.invalidateAtom(ia.idx, BaseMolecule::CHANGED_ALL);
         return 1;
     }
     INDIGO_END(-1);
@@ -124,6 +124,7 @@ IndigoObjectTypes::IndigoObjectTypes()
     emplace(IndigoObject::GROSS_REACTION, "GrossReaction");
     emplace(IndigoObject::JSON_MOLECULE, "JsonMolecule");
     emplace(IndigoObject::JSON_REACTION, "JsonReaction");
+    emplace(IndigoObject::MULTI_QUERY_SUBSTRUCTURE_MATCHER, "MultiQuerySubstructureMatcher");
 
     if (size() != IndigoObject::INDIGO_OBJECT_LAST_TYPE - 1)
     {
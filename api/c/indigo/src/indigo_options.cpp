@@ -277,6 +277,9 @@ void IndigoOptionHandlerSetter::setBasicOptionHandlers(const qword id)
     mgr.setOptionHandlerString("treat-stereo-as", indigoSetStereoOption, indigoGetStereoOption);
     mgr.setOptionHandlerBool("ignore-closing-bond-direction-mismatch", SETTER_GETTER_BOOL_OPTION(indigo.ignore_closing_bond_direction_mismatch));
     mgr.setOptionHandlerBool("ignore-bad-valence", SETTER_GETTER_BOOL_OPTION(indigo.ignore_bad_valence));
+    mgr.setOptionHandlerInt("iterator-threads", SETTER_GETTER_INT_OPTION(indigo.iterator_threads));
+    mgr.setOptionHandlerBool("iterator-ordered", SETTER_GETTER_BOOL_OPTION(indigo.iterator_ordered));
+    mgr.setOptionHandlerBool("iterator-index", SETTER_GETTER_BOOL_OPTION(indigo.iterator_index));
     mgr.setOptionHandlerBool("treat-x-as-pseudoatom", SETTER_GETTER_BOOL_OPTION(indigo.treat_x_as_pseudoatom));
     mgr.setOptionHandlerBool("skip-3d-chirality", SETTER_GETTER_BOOL_OPTION(indigo.skip_3d_chirality));
     mgr.setOptionHandlerBool("deconvolution-aromatization", SETTER_GETTER_BOOL_OPTION(indigo.deconvolution_aromatization));
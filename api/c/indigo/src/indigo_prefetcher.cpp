@@ -0,0 +1,216 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#include "indigo_prefetcher.h"
+
+#include "indigo_molecule.h"
+#include "indigo_reaction.h"
+
+IndigoPrefetcher::IndigoPrefetcher(Reader reader, long long start_offset, int threads, bool ordered)
+    : _reader(reader), _session_id(TL_GET_SESSION_ID()), _ordered(ordered), _read_count(0), _delivered_count(0), _offset(start_offset), _finished(false),
+      _stop(false)
+{
+    if (threads < 1)
+        threads = 1;
+    _capacity = threads * 32;
+
+    _splitter = std::thread(&IndigoPrefetcher::_split, this);
+    for (int i = 0; i < threads; i++)
+        _workers.emplace_back(&IndigoPrefetcher::_work, this);
+}
+
+IndigoPrefetcher::~IndigoPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _reader_cond.notify_all();
+    _worker_cond.notify_all();
+
+    _splitter.join();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+std::unique_ptr<IndigoPrefetcher> IndigoPrefetcher::create(Reader reader, long long start_offset)
+{
+    Indigo& indigo = indigoGetInstance();
+
+    if (indigo.iterator_threads <= 1)
+        return nullptr;
+    return std::make_unique<IndigoPrefetcher>(reader, start_offset, indigo.iterator_threads, indigo.iterator_ordered);
+}
+
+bool IndigoPrefetcher::ordered() const
+{
+    return _ordered;
+}
+
+void IndigoPrefetcher::_split()
+{
+    // Loaders take the parsing options from the session of the consumer
+    TL_SET_SESSION_ID(_session_id);
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _reader_cond.wait(lock, [this]() { return _stop || _read_count - _delivered_count < _capacity; });
+            if (_stop)
+                return;
+        }
+
+        _Record record;
+        std::exception_ptr error;
+
+        try
+        {
+            record.object.reset(_reader(record.end_offset));
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        bool finished = (record.object == nullptr);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (finished)
+            {
+                _error = error;
+                _finished = true;
+            }
+            else
+            {
+                record.index = _read_count++;
+                _queued.push_back(std::move(record));
+            }
+        }
+
+        if (finished)
+        {
+            _worker_cond.notify_all();
+            _consumer_cond.notify_all();
+            return;
+        }
+        _worker_cond.notify_one();
+    }
+}
+
+void IndigoPrefetcher::_work()
+{
+    TL_SET_SESSION_ID(_session_id);
+
+    while (true)
+    {
+        _Record record;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _worker_cond.wait(lock, [this]() { return _stop || _finished || !_queued.empty(); });
+            if (_stop || _queued.empty())
+                return;
+            record = std::move(_queued.front());
+            _queued.pop_front();
+        }
+
+        _parse(*record.object);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            long long index = record.index;
+            _parsed.emplace(index, std::move(record));
+        }
+        _consumer_cond.notify_all();
+    }
+}
+
+void IndigoPrefetcher::_parse(IndigoObject& obj)
+{
+    // Parsing errors are not reported here: the object stays unloaded and
+    // the consumer gets the error when accessing the structure, as usual
+    try
+    {
+        if (IndigoBaseMolecule::is(obj))
+            obj.getBaseMolecule();
+        else if (IndigoBaseReaction::is(obj))
+            obj.getBaseReaction();
+    }
+    catch (...)
+    {
+    }
+}
+
+bool IndigoPrefetcher::_ready()
+{
+    if (!_parsed.empty() && (!_ordered || _parsed.begin()->first == _delivered_count))
+        return true;
+    return _finished && _delivered_count == _read_count;
+}
+
+IndigoObject* IndigoPrefetcher::next()
+{
+    std::unique_ptr<IndigoObject> obj;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _consumer_cond.wait(lock, [this]() { return _ready(); });
+
+        if (_parsed.empty())
+        {
+            if (_error)
+            {
+                std::exception_ptr error = _error;
+                _error = nullptr;
+                std::rethrow_exception(error);
+            }
+            return nullptr;
+        }
+
+        auto it = _parsed.begin();
+        obj = std::move(it->second.object);
+        _offset = it->second.end_offset;
+        _parsed.erase(it);
+        _delivered_count++;
+    }
+
+    _reader_cond.notify_one();
+    return obj.release();
+}
+
+bool IndigoPrefetcher::hasNext()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _consumer_cond.wait(lock, [this]() { return _ready(); });
+    // Let next() report the error
+    return !_parsed.empty() || _error != nullptr;
+}
+
+long long IndigoPrefetcher::tell()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _offset;
+}
+
+long long IndigoPrefetcher::deliveredCount()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _delivered_count;
+}
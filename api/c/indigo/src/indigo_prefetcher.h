@@ -0,0 +1,109 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#ifndef __indigo_prefetcher__
+#define __indigo_prefetcher__
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "indigo_internal.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+// Reads records of a file iterator ahead of the consumer. One thread splits
+// the records with the reader function, worker threads parse molecules and
+// reactions, and the consumer receives the parsed objects either in the
+// original order or as soon as they are ready. The number of records that are
+// read but not yet delivered is bounded.
+class IndigoPrefetcher
+{
+public:
+    // Returns the next unparsed record, or nullptr at the end of the input.
+    // end_offset receives the input position after the record.
+    typedef std::function<IndigoObject*(long long& end_offset)> Reader;
+
+    IndigoPrefetcher(Reader reader, long long start_offset, int threads, bool ordered);
+    ~IndigoPrefetcher();
+
+    // Creates a prefetcher according to the iterator options of the session,
+    // or returns nullptr if the records should be read sequentially
+    static std::unique_ptr<IndigoPrefetcher> create(Reader reader, long long start_offset);
+
+    bool ordered() const;
+
+    // Blocks until the next record is parsed. Returns nullptr at the end of the input;
+    // errors of the reader are rethrown after all the preceding records are delivered.
+    IndigoObject* next();
+    bool hasNext();
+
+    // Input position after the last delivered record
+    long long tell();
+    // Number of records delivered so far. In the ordered mode these are
+    // exactly the first records of the input.
+    long long deliveredCount();
+
+private:
+    struct _Record
+    {
+        long long index;
+        long long end_offset;
+        std::unique_ptr<IndigoObject> object;
+    };
+
+    void _split();
+    void _work();
+    static void _parse(IndigoObject& obj);
+
+    bool _ready();
+
+    Reader _reader;
+    qword _session_id;
+    bool _ordered;
+    int _capacity;
+
+    std::mutex _mutex;
+    std::condition_variable _reader_cond, _worker_cond, _consumer_cond;
+
+    std::deque<_Record> _queued;
+    std::map<long long, _Record> _parsed;
+
+    long long _read_count, _delivered_count;
+    long long _offset;
+    bool _finished, _stop;
+    std::exception_ptr _error;
+
+    std::thread _splitter;
+    std::vector<std::thread> _workers;
+};
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
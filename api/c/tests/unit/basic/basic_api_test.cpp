@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include <molecule/molecule_mass.h>
@@ -253,4 +257,85 @@ TEST(IndigoBasicApiTest, test_getter_function)
 
     indigoRendererDispose();
     indigoReleaseSessionId(session);
-}
\ No newline at end of file
+}
+
+TEST(IndigoBasicApiTest, test_object_handles)
+{
+    qword session = indigoAllocSessionId();
+    indigoSetSessionId(session);
+
+    int mol = indigoCreateMolecule();
+    ASSERT_GT(mol, 0);
+    ASSERT_EQ(indigoCountReferences(), 1);
+    indigoFree(mol);
+    ASSERT_EQ(indigoCountReferences(), 0);
+
+    // Freed handle must stay invalid even when its slot is reused
+    int other = indigoCreateMolecule();
+    ASSERT_NE(other, mol);
+    ASSERT_EQ(indigoCountAtoms(mol), -1);
+    ASSERT_EQ(indigoCountAtoms(other), 0);
+    indigoFree(other);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([session]() {
+            indigoSetSessionId(session);
+            std::vector<int> handles;
+            for (int i = 0; i < 1000; i++)
+            {
+                handles.push_back(indigoCreateMolecule());
+                if (i % 3 == 0)
+                {
+                    indigoFree(handles.back());
+                    handles.pop_back();
+                }
+            }
+            for (int handle : handles)
+            {
+                ASSERT_EQ(indigoCountAtoms(handle), 0);
+                indigoFree(handle);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(indigoCountReferences(), 0);
+    indigoReleaseSessionId(session);
+}
+
+TEST(IndigoBasicApiTest, test_object_handles_freed_by_other_thread)
+{
+    qword session = indigoAllocSessionId();
+    indigoSetSessionId(session);
+
+    // Slots freed by one thread must be reused by another one instead of growing the table
+    const int count = 100;
+    int max_slot = 0;
+    for (int round = 0; round < 20; round++)
+    {
+        std::vector<int> handles;
+        std::thread producer([session, &handles]() {
+            indigoSetSessionId(session);
+            for (int i = 0; i < count; i++)
+                handles.push_back(indigoCreateMolecule());
+        });
+        producer.join();
+
+        std::thread consumer([session, &handles]() {
+            indigoSetSessionId(session);
+            for (int handle : handles)
+                indigoFree(handle);
+        });
+        consumer.join();
+
+        for (int handle : handles)
+            max_slot = std::max(max_slot, handle & 0xFFFFFF);
+    }
+
+    ASSERT_LT(max_slot, count);
+    ASSERT_EQ(indigoCountReferences(), 0);
+    indigoReleaseSessionId(session);
+}
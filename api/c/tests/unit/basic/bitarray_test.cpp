@@ -0,0 +1,83 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_c/bitarray.h>
+
+namespace
+{
+    int referenceOnesCount(const std::vector<byte>& data)
+    {
+        int count = 0;
+        for (byte b : data)
+            count += bitGetOnesCountByte(b);
+        return count;
+    }
+
+    std::vector<byte> randomBits(std::mt19937& rng, int size)
+    {
+        std::vector<byte> data(size + sizeof(qword));
+        for (auto& b : data)
+            b = static_cast<byte>(rng() & 0xFF);
+        data.resize(size);
+        return data;
+    }
+}
+
+TEST(IndigoBitarrayTest, test_word_kernels)
+{
+    std::mt19937 rng(42);
+    for (int size : {0, 1, 7, 8, 9, 31, 64, 65, 128, 333, 512})
+    {
+        auto a = randomBits(rng, size);
+        auto b = randomBits(rng, size);
+        auto c = randomBits(rng, size);
+
+        ASSERT_EQ(bitGetOnesCount(a.data(), size), referenceOnesCount(a));
+
+        std::vector<byte> expected_and(size), expected_or(size), expected_abc(size);
+        int common = 0;
+        for (int i = 0; i < size; i++)
+        {
+            expected_and[i] = a[i] & b[i];
+            expected_or[i] = a[i] | b[i];
+            expected_abc[i] = a[i] & (b[i] ^ ~c[i]);
+            common += bitGetOnesCountByte(expected_and[i]);
+        }
+        ASSERT_EQ(bitCommonOnes(a.data(), b.data(), size), common);
+
+        auto r = a;
+        bitAnd(r.data(), b.data(), size);
+        ASSERT_EQ(r, expected_and);
+        r = a;
+        bitOr(r.data(), b.data(), size);
+        ASSERT_EQ(r, expected_or);
+        r.assign(size, 0);
+        bitGetAandBxorNotC(a.data(), b.data(), c.data(), r.data(), size * 8);
+        ASSERT_EQ(r, expected_abc);
+
+        ASSERT_TRUE(bitTestEquality(a.data(), a.data(), size * 8));
+        ASSERT_TRUE(bitTestEqualityByMask(a.data(), b.data(), std::vector<byte>(size, 0).data(), size * 8));
+        if (size > 0)
+        {
+            r = a;
+            r[size - 1] ^= 0x80;
+            ASSERT_FALSE(bitTestEquality(a.data(), r.data(), size * 8));
+            ASSERT_TRUE(bitTestEquality(a.data(), r.data(), size * 8 - 1));
+        }
+
+        std::vector<byte> zero(size, 0);
+        ASSERT_TRUE(bitIsAllZero(zero.data(), size));
+        if (size > 0)
+        {
+            zero[size - 1] = 1;
+            ASSERT_FALSE(bitIsAllZero(zero.data(), size));
+        }
+    }
+
+    ASSERT_EQ(bitGetOneLOIndexQword(0), 64);
+    ASSERT_EQ(bitGetOneLOIndexQword(1), 0);
+    ASSERT_EQ(bitGetOneLOIndexQword(1ULL << 63), 63);
+    ASSERT_EQ(bitGetOneLOIndexQword(0x0000010000000100ULL), 8);
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/output.h>
+#include <base_cpp/scanner.h>
+#include <molecule/canonical_smiles_saver.h>
+#include <molecule/molecule.h>
+#include <molecule/molecule_canonicalizer.h>
+#include <molecule/sdf_loader.h>
+#include <molecule/smiles_loader.h>
+
+#include "common.h"
+
+using namespace indigo;
+
+namespace
+{
+    std::string canonicalSmiles(Molecule& mol)
+    {
+        Array<char> buf;
+        ArrayOutput output(buf);
+        CanonicalSmilesSaver saver(output);
+        saver.saveMolecule(mol);
+        return std::string(buf.ptr(), buf.size());
+    }
+
+    void loadTestMolecules(ObjArray<Molecule>& mols)
+    {
+        FileScanner smiles_scanner(dataPath("molecules/basic/pubchem_slice_5000.smi").c_str());
+        Array<char> line;
+
+        for (int n = 0; n < 500 && !smiles_scanner.isEOF(); n++)
+        {
+            smiles_scanner.readLine(line, true);
+            BufferScanner scanner(line.ptr());
+            SmilesLoader loader(scanner);
+            loader.loadMolecule(mols.push());
+        }
+
+        FileScanner sdf_scanner(dataPath("molecules/stereo/stereo_cis_trans.sdf").c_str());
+        SdfLoader sdf(sdf_scanner);
+
+        while (!sdf.isEOF())
+        {
+            sdf.readNext();
+            loadMolecule(sdf.data.ptr(), mols.push());
+        }
+    }
+}
+
+TEST(IndigoCanonicalizerTest, test_smiles_and_hash)
+{
+    ObjArray<Molecule> mols;
+    loadTestMolecules(mols);
+
+    MoleculeCanonicalizer canonicalizer;
+    std::mt19937 rng(42);
+    std::map<std::string, std::pair<qword, qword>> hash_by_smiles;
+    std::map<std::pair<qword, qword>, std::string> smiles_by_hash;
+
+    for (int i = 0; i < mols.size(); i++)
+    {
+        Molecule& mol = mols[i];
+        std::string expected = canonicalSmiles(mol);
+
+        Array<char> buf;
+        ArrayOutput output(buf);
+        canonicalizer.saveSmiles(mol, output);
+        ASSERT_EQ(expected, std::string(buf.ptr(), buf.size()));
+
+        MoleculeCanonicalizer::Hash hash = canonicalizer.hash(mol);
+
+        // Same molecule with shuffled atoms
+        Array<int> vertices;
+        for (int v = mol.vertexBegin(); v != mol.vertexEnd(); v = mol.vertexNext(v))
+            vertices.push(v);
+        std::shuffle(vertices.ptr(), vertices.ptr() + vertices.size(), rng);
+
+        Molecule shuffled;
+        shuffled.makeSubmolecule(mol, vertices, 0);
+
+        ASSERT_EQ(expected, canonicalSmiles(shuffled)) << i;
+        MoleculeCanonicalizer::Hash shuffled_hash = canonicalizer.hash(shuffled);
+        ASSERT_EQ(hash.lo, shuffled_hash.lo) << expected;
+        ASSERT_EQ(hash.hi, shuffled_hash.hi) << expected;
+
+        // Equal hashes only for equal canonical SMILES
+        auto key = std::make_pair(hash.lo, hash.hi);
+        auto by_smiles = hash_by_smiles.emplace(expected, key);
+        ASSERT_TRUE(by_smiles.first->second == key) << expected;
+        auto by_hash = smiles_by_hash.emplace(key, expected);
+        ASSERT_EQ(expected, by_hash.first->second);
+    }
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/scanner.h>
+#include <indigo.h>
+#include <molecule/molecule.h>
+#include <molecule/molecule_fingerprint.h>
+#include <molecule/molecule_morgan_fingerprint_builder.h>
+#include <molecule/molfile_loader.h>
+#include <molecule/query_molecule.h>
+#include <molecule/sdf_loader.h>
+#include <molecule/smiles_loader.h>
+
+#include "common.h"
+
+using namespace indigo;
+
+namespace
+{
+    MoleculeFingerprintParameters defaultParameters()
+    {
+        MoleculeFingerprintParameters parameters;
+        parameters.ext = true;
+        parameters.ord_qwords = 25;
+        parameters.any_qwords = 15;
+        parameters.tau_qwords = 10;
+        parameters.sim_qwords = 8;
+        parameters.similarity_type = SimilarityType::SIM;
+        return parameters;
+    }
+
+    void buildFingerprint(BaseMolecule& mol, const MoleculeFingerprintParameters& parameters, const char* type, bool query, bool fused, Array<byte>& fp)
+    {
+        MoleculeFingerprintBuilder builder(mol, parameters);
+        builder.parseFingerprintType(type, query);
+        builder.fused_hashing = fused;
+        builder.process();
+        fp.copy(builder.get(), parameters.fingerprintSize());
+    }
+}
+
+TEST(IndigoFingerprintTest, test_fused_hashing_molecules)
+{
+    MoleculeFingerprintParameters parameters = defaultParameters();
+    FileScanner scanner(dataPath("molecules/basic/pubchem_slice_5000.smi").c_str());
+    Array<char> line;
+    Array<byte> fp_fused, fp_plain;
+
+    for (int n = 0; n < 300 && !scanner.isEOF(); n++)
+    {
+        scanner.readLine(line, true);
+
+        Molecule mol;
+        BufferScanner smiles(line.ptr());
+        SmilesLoader loader(smiles);
+        loader.loadMolecule(mol);
+        mol.aromatize(AromaticityOptions());
+
+        for (const char* type : {"full", "sim"})
+        {
+            buildFingerprint(mol, parameters, type, false, true, fp_fused);
+            buildFingerprint(mol, parameters, type, false, false, fp_plain);
+            ASSERT_EQ(0, memcmp(fp_fused.ptr(), fp_plain.ptr(), fp_plain.size())) << line.ptr() << " " << type;
+        }
+    }
+}
+
+TEST(IndigoFingerprintTest, test_fused_hashing_queries)
+{
+    MoleculeFingerprintParameters parameters = defaultParameters();
+    FileScanner scanner(dataPath("molecules/basic/rand_queries_small.sdf").c_str());
+    SdfLoader sdf(scanner);
+    Array<byte> fp_fused, fp_plain;
+
+    while (!sdf.isEOF())
+    {
+        sdf.readNext();
+
+        QueryMolecule qmol;
+        BufferScanner molfile(sdf.data);
+        MolfileLoader loader(molfile);
+        loader.loadQueryMolecule(qmol);
+        qmol.aromatize(AromaticityOptions());
+
+        for (const char* type : {"sub", "sub-tau"})
+        {
+            buildFingerprint(qmol, parameters, type, true, true, fp_fused);
+            buildFingerprint(qmol, parameters, type, true, false, fp_plain);
+            ASSERT_EQ(0, memcmp(fp_fused.ptr(), fp_plain.ptr(), fp_plain.size())) << sdf.currentNumber() << " " << type;
+        }
+    }
+}
+
+TEST(IndigoFingerprintTest, test_morgan_features_batch)
+{
+    FileScanner scanner(dataPath("molecules/basic/pubchem_slice_5000.smi").c_str());
+    Array<char> line;
+    ObjArray<Molecule> mols;
+
+    for (int n = 0; n < 200 && !scanner.isEOF(); n++)
+    {
+        scanner.readLine(line, true);
+        BufferScanner smiles(line.ptr());
+        SmilesLoader loader(smiles);
+        loader.loadMolecule(mols.push());
+    }
+
+    MoleculeMorganFeaturesBatch batch;
+    Array<dword> expected;
+
+    for (int depth = 1; depth <= 4; depth++)
+    {
+        batch.clear();
+        for (int i = 0; i < mols.size(); i++)
+            ASSERT_EQ(i, batch.addECFP(mols[i], depth));
+        ASSERT_EQ(mols.size(), batch.count());
+
+        for (int i = 0; i < mols.size(); i++)
+        {
+            MoleculeMorganFingerprintBuilder builder(mols[i]);
+            builder.calculateDescriptorsECFP(depth, expected);
+            std::sort(expected.ptr(), expected.ptr() + expected.size());
+
+            const dword* ids;
+            const int* counts;
+            int n = batch.getFeatures(i, ids, counts);
+
+            int pos = 0;
+            for (int j = 0; j < n; j++)
+            {
+                ASSERT_GT(counts[j], 0);
+                for (int k = 0; k < counts[j]; k++, pos++)
+                {
+                    ASSERT_LT(pos, expected.size()) << i << " " << depth;
+                    ASSERT_EQ(expected[pos], ids[j]) << i << " " << depth;
+                }
+            }
+            ASSERT_EQ(expected.size(), pos) << i << " " << depth;
+        }
+    }
+}
+
+TEST(IndigoFingerprintTest, test_morgan_features_api)
+{
+    qword session = indigoAllocSessionId();
+    indigoSetSessionId(session);
+    indigoSetErrorHandler(errorHandling, 0);
+
+    int arr = indigoCreateArray();
+    int m1 = indigoLoadMoleculeFromString("c1ccccc1O");
+    int m2 = indigoLoadMoleculeFromString("CCN");
+    indigoArrayAdd(arr, m1);
+    indigoArrayAdd(arr, m2);
+
+    int count = 0;
+    const int* buf = indigoMorganFeatures(arr, "ECFP4", &count);
+    ASSERT_NE(nullptr, buf);
+
+    int pos = 0, molecules = 0, last = 0;
+    while (pos < count)
+    {
+        int n = buf[pos];
+        ASSERT_GT(n, 0);
+        for (int j = 1; j < n; j++)
+            ASSERT_LT((dword)buf[pos + 2 * j - 1], (dword)buf[pos + 2 * j + 1]);
+        last = n;
+        pos += 1 + 2 * n;
+        molecules++;
+    }
+    ASSERT_EQ(count, pos);
+    ASSERT_EQ(2, molecules);
+
+    int single = 0;
+    indigoMorganFeatures(m2, "ECFP4", &single);
+    ASSERT_EQ(1 + 2 * last, single);
+
+    ASSERT_THROW(indigoMorganFeatures(m1, "sim", &count), Exception);
+
+    indigoFree(m1);
+    indigoFree(m2);
+    indigoFree(arr);
+    indigoReleaseSessionId(session);
+}
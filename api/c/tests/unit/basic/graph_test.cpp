@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <graph/cycle_basis.h>
+#include <graph/graph.h>
+
+using namespace indigo;
+
+static void checkCSR(const Graph& graph)
+{
+    const GraphCSR& csr = graph.getCSR();
+
+    int count = 0;
+    for (int v = graph.vertexBegin(); v != graph.vertexEnd(); v = graph.vertexNext(v))
+    {
+        ASSERT_EQ(csr.vertices()[count++], v);
+
+        const Vertex& vertex = graph.getVertex(v);
+        ASSERT_EQ(csr.degree(v), vertex.degree());
+
+        int j = 0;
+        for (int i = vertex.neiBegin(); i != vertex.neiEnd(); i = vertex.neiNext(i), j++)
+        {
+            ASSERT_EQ(csr.neiVertices(v)[j], vertex.neiVertex(i));
+            ASSERT_EQ(csr.neiEdges(v)[j], vertex.neiEdge(i));
+            ASSERT_EQ(csr.findEdgeIndex(v, vertex.neiVertex(i)), vertex.neiEdge(i));
+        }
+    }
+    ASSERT_EQ(csr.vertexCount(), count);
+
+    for (int e = graph.edgeBegin(); e != graph.edgeEnd(); e = graph.edgeNext(e))
+    {
+        ASSERT_EQ(csr.getEdge(e).beg, graph.getEdge(e).beg);
+        ASSERT_EQ(csr.getEdge(e).end, graph.getEdge(e).end);
+    }
+}
+
+TEST(IndigoGraphTest, test_csr_snapshot)
+{
+    Graph graph;
+    for (int i = 0; i < 6; i++)
+        graph.addVertex();
+    for (int i = 0; i < 6; i++)
+        graph.addEdge(i, (i + 1) % 6);
+    checkCSR(graph);
+
+    // The snapshot must follow modifications of the graph
+    graph.addEdge(0, 3);
+    checkCSR(graph);
+
+    graph.removeVertex(4);
+    checkCSR(graph);
+    ASSERT_EQ(graph.getCSR().degree(4), 0);
+    ASSERT_EQ(graph.getCSR().findEdgeIndex(3, 5), -1);
+
+    graph.swapEdgeEnds(graph.findEdgeIndex(0, 3));
+    checkCSR(graph);
+}
+
+TEST(IndigoGraphTest, test_csr_concurrent)
+{
+    Graph graph;
+    for (int i = 0; i < 1000; i++)
+        graph.addVertex();
+    for (int i = 0; i < 999; i++)
+        graph.addEdge(i, i + 1);
+
+    // Readers of an unmodified graph share one snapshot
+    std::vector<const GraphCSR*> snapshots(8);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < (int)snapshots.size(); i++)
+        threads.emplace_back([&graph, &snapshots, i]() { snapshots[i] = &graph.getCSR(); });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const GraphCSR* snapshot : snapshots)
+        ASSERT_EQ(&graph.getCSR(), snapshot);
+    checkCSR(graph);
+}
+
+TEST(IndigoGraphTest, test_cycle_basis)
+{
+    // Hexagon 0-5, bridge 5-6, fused squares 6-7-8-9 and 8-9-10-11, chain 11-12
+    Graph graph;
+    graph.reserve(13, 16);
+    for (int i = 0; i < 13; i++)
+        graph.addVertex();
+    for (int i = 0; i < 6; i++)
+        graph.addEdge(i, (i + 1) % 6);
+    graph.addEdge(5, 6);
+    graph.addEdge(6, 7);
+    graph.addEdge(7, 8);
+    graph.addEdge(8, 9);
+    graph.addEdge(9, 6);
+    graph.addEdge(8, 10);
+    graph.addEdge(10, 11);
+    graph.addEdge(11, 9);
+    graph.addEdge(11, 12);
+
+    CycleBasis basis;
+    basis.create(graph);
+    ASSERT_EQ(3, basis.getCyclesCount());
+
+    std::vector<int> sizes;
+    for (int i = 0; i < basis.getCyclesCount(); i++)
+    {
+        // Edges of a cycle go one after another
+        const Array<int>& cycle = basis.getCycle(i);
+        for (int j = 0; j < cycle.size(); j++)
+        {
+            const Edge& edge = graph.getEdge(cycle[j]);
+            const Edge& next = graph.getEdge(cycle[(j + 1) % cycle.size()]);
+            ASSERT_TRUE(edge.beg == next.beg || edge.beg == next.end || edge.end == next.beg || edge.end == next.end);
+        }
+        sizes.push_back(cycle.size());
+    }
+    std::sort(sizes.begin(), sizes.end());
+    ASSERT_EQ(std::vector<int>({4, 4, 6}), sizes);
+
+    ASSERT_TRUE(basis.containsVertex(11));
+    ASSERT_FALSE(basis.containsVertex(12));
+    ASSERT_EQ(6, graph.vertexSmallestRingSize(0));
+    ASSERT_EQ(4, graph.vertexSmallestRingSize(8));
+    ASSERT_EQ(0, graph.edgeSmallestRingSize(graph.findEdgeIndex(5, 6)));
+    ASSERT_EQ(3, graph.sssrCount());
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/output.h>
+#include <base_cpp/scanner.h>
+#include <gzip/gzip_output.h>
+#include <gzip/gzip_scanner.h>
+#include <molecule/sdf_loader.h>
+
+#include "common.h"
+
+using namespace indigo;
+
+namespace
+{
+    void loadData(Array<char>& data)
+    {
+        FileScanner scanner(dataPath("molecules/basic/pubchem_slice_5000.smi").c_str());
+        Array<char> chunk;
+        scanner.readAll(chunk);
+
+        // About 3 MB, more than the blocks inflated before starting the threads
+        data.clear();
+        for (int i = 0; i < 10; i++)
+            data.concat(chunk);
+    }
+
+    void compress(const Array<char>& data, int threads, Array<char>& compressed)
+    {
+        compressed.clear();
+        ArrayOutput output(compressed);
+        GZipOutput gzip(output, 6, threads);
+
+        // Uneven writes to cross the block boundaries
+        for (int pos = 0; pos < data.size();)
+        {
+            int n = std::min(data.size() - pos, 1000 + pos % 70000);
+            gzip.write(data.ptr() + pos, n);
+            pos += n;
+        }
+    }
+
+    void decompress(const Array<char>& compressed, int threads, Array<char>& data)
+    {
+        BufferScanner input(compressed);
+        GZipScanner gzip(input, threads);
+        data.clear();
+
+        // Mix the reading methods
+        for (int i = 0; i < 5000 && !gzip.isEOF(); i++)
+        {
+            int next = gzip.lookNext();
+            ASSERT_EQ(next, (byte)gzip.readChar());
+            data.push((char)next);
+        }
+        ASSERT_EQ(data.size(), gzip.tell());
+
+        Array<char> chunk;
+        chunk.resize(100000);
+        gzip.read(chunk.size(), chunk.ptr());
+        data.concat(chunk);
+        ASSERT_EQ(data.size(), gzip.tell());
+
+        Array<char> rest;
+        gzip.readAll(rest);
+        data.concat(rest);
+        ASSERT_TRUE(gzip.isEOF());
+        ASSERT_EQ(data.size(), gzip.tell());
+    }
+}
+
+TEST(IndigoGZipTest, test_stream_round_trip)
+{
+    Array<char> data, compressed, result;
+    loadData(data);
+
+    compress(data, 0, compressed);
+    for (int threads : {0, 4})
+    {
+        decompress(compressed, threads, result);
+        ASSERT_EQ(std::string(data.ptr(), data.size()), std::string(result.ptr(), result.size())) << threads;
+    }
+}
+
+TEST(IndigoGZipTest, test_bgzf_round_trip)
+{
+    Array<char> data, compressed, result;
+    loadData(data);
+
+    compress(data, 4, compressed);
+
+    // BGZF member header with the "BC" extra subfield
+    ASSERT_EQ(0x1f, (byte)compressed[0]);
+    ASSERT_EQ(0x8b, (byte)compressed[1]);
+    ASSERT_EQ(4, compressed[3]);
+    ASSERT_EQ('B', compressed[12]);
+    ASSERT_EQ('C', compressed[13]);
+
+    for (int threads : {0, 4})
+    {
+        decompress(compressed, threads, result);
+        ASSERT_EQ(std::string(data.ptr(), data.size()), std::string(result.ptr(), result.size())) << threads;
+    }
+}
+
+TEST(IndigoGZipTest, test_multiple_members)
+{
+    Array<char> data, compressed, second, result;
+    loadData(data);
+
+    // gzip stream followed by a BGZF file and trailing zeros
+    compress(data, 0, compressed);
+    compress(data, 4, second);
+    compressed.concat(second);
+    for (int i = 0; i < 16; i++)
+        compressed.push(0);
+
+    Array<char> expected;
+    expected.concat(data);
+    expected.concat(data);
+
+    for (int threads : {0, 4})
+    {
+        decompress(compressed, threads, result);
+        ASSERT_EQ(expected.size(), result.size()) << threads;
+        ASSERT_TRUE(memcmp(expected.ptr(), result.ptr(), expected.size()) == 0) << threads;
+    }
+}
+
+TEST(IndigoGZipTest, test_errors)
+{
+    Array<char> data, compressed, result;
+    loadData(data);
+
+    for (int threads : {0, 4})
+    {
+        compress(data, threads, compressed);
+        compressed.resize(compressed.size() / 2);
+
+        BufferScanner input(compressed);
+        GZipScanner gzip(input, threads);
+        ASSERT_THROW(gzip.readAll(result), Exception) << threads;
+    }
+}
+
+TEST(IndigoGZipTest, test_bgzf_bad_isize)
+{
+    Array<char> data, compressed, result;
+    loadData(data);
+    compress(data, 4, compressed);
+
+    // Compressed size of the first member from the BSIZE field of its header
+    int member_size = ((byte)compressed[16] | ((byte)compressed[17] << 8)) + 1;
+    for (int i = member_size - 4; i < member_size; i++)
+        compressed[i] = (char)0xff;
+
+    for (int threads : {0, 4})
+    {
+        BufferScanner input(compressed);
+        GZipScanner gzip(input, threads);
+        ASSERT_THROW(gzip.readAll(result), Exception) << threads;
+    }
+}
+
+TEST(IndigoGZipTest, test_sdf)
+{
+    FileScanner scanner(dataPath("molecules/basic/zinc-slice.sdf.gz").c_str());
+    SdfLoader loader(scanner);
+    int count = 0;
+
+    while (!loader.isEOF())
+    {
+        loader.readNext();
+        count++;
+    }
+    ASSERT_EQ(992, count);
+}
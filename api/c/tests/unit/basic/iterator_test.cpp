@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/output.h>
+#include <base_cpp/record_offset_index.h>
+#include <base_cpp/scanner.h>
+#include <indigo.h>
+#include <molecule/sdf_loader.h>
+
+#include "common.h"
+
+using namespace indigo;
+
+namespace
+{
+    typedef std::pair<int, std::string> Record;
+
+    std::string recordSmiles(int item)
+    {
+        try
+        {
+            return indigoCanonicalSmiles(item);
+        }
+        catch (Exception&)
+        {
+            return "error";
+        }
+    }
+
+    std::vector<Record> readAll(int iterator, int limit = -1)
+    {
+        std::vector<Record> records;
+        int item;
+
+        while ((limit < 0 || (int)records.size() < limit) && (item = indigoNext(iterator)) != 0)
+        {
+            records.emplace_back(indigoIndex(item), recordSmiles(item));
+            indigoFree(item);
+        }
+        return records;
+    }
+
+    std::vector<Record> readFile(const std::string& path, int limit = -1)
+    {
+        int iterator = path.find(".sdf") != std::string::npos ? indigoIterateSDFile(path.c_str()) : indigoIterateSmilesFile(path.c_str());
+        std::vector<Record> records = readAll(iterator, limit);
+        indigoFree(iterator);
+        return records;
+    }
+
+    void copyFile(const std::string& from, const std::string& to, bool append = false)
+    {
+        std::ifstream in(from, std::ios::binary);
+        std::ofstream out(to, append ? std::ios::binary | std::ios::app : std::ios::binary);
+        out << in.rdbuf();
+    }
+
+    bool fileExists(const std::string& path)
+    {
+        return std::ifstream(path).good();
+    }
+}
+
+class IndigoIteratorTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        session = indigoAllocSessionId();
+        indigoSetSessionId(session);
+        indigoSetErrorHandler(errorHandling, 0);
+    }
+
+    void TearDown() override
+    {
+        indigoReleaseSessionId(session);
+    }
+
+    qword session;
+};
+
+TEST_F(IndigoIteratorTest, test_prefetch_ordered)
+{
+    for (const char* file : {"molecules/basic/pubchem_slice_5000.smi", "molecules/basic/thiazolidines.sdf"})
+    {
+        std::string path = dataPath(file);
+
+        indigoSetOptionInt("iterator-threads", 0);
+        std::vector<Record> expected = readFile(path);
+
+        indigoSetOptionInt("iterator-threads", 4);
+        ASSERT_EQ(expected, readFile(path)) << file;
+    }
+}
+
+TEST_F(IndigoIteratorTest, test_prefetch_unordered)
+{
+    std::string path = dataPath("molecules/basic/pubchem_slice_5000.smi");
+
+    indigoSetOptionInt("iterator-threads", 0);
+    std::vector<Record> expected = readFile(path);
+
+    indigoSetOptionInt("iterator-threads", 4);
+    indigoSetOptionBool("iterator-ordered", false);
+    std::vector<Record> records = readFile(path);
+    std::sort(records.begin(), records.end());
+    ASSERT_EQ(expected, records);
+
+    // Counting is not possible while unordered prefetching is running
+    int iterator = indigoIterateSmilesFile(path.c_str());
+    readAll(iterator, 10);
+    ASSERT_THROW(indigoCount(iterator), Exception);
+    indigoFree(iterator);
+
+    indigoSetOptionBool("iterator-ordered", true);
+}
+
+TEST_F(IndigoIteratorTest, test_prefetch_random_access)
+{
+    for (const char* file : {"molecules/basic/pubchem_slice_5000.smi", "molecules/basic/thiazolidines.sdf"})
+    {
+        std::string path = dataPath(file);
+
+        indigoSetOptionInt("iterator-threads", 0);
+        std::vector<Record> expected = readFile(path);
+        int total = (int)expected.size();
+
+        indigoSetOptionInt("iterator-threads", 4);
+        int iterator = path.find(".sdf") != std::string::npos ? indigoIterateSDFile(path.c_str()) : indigoIterateSmilesFile(path.c_str());
+
+        // Counting continues the iteration after the delivered records
+        std::vector<Record> records = readAll(iterator, 20);
+        ASSERT_EQ(total, indigoCount(iterator));
+        std::vector<Record> rest = readAll(iterator, 20);
+        records.insert(records.end(), rest.begin(), rest.end());
+        ASSERT_TRUE(std::equal(records.begin(), records.end(), expected.begin())) << file;
+
+        // Iteration continues after the record returned by indigoAt
+        int item = indigoAt(iterator, 5);
+        ASSERT_EQ(expected[5].second, recordSmiles(item));
+        indigoFree(item);
+        rest = readAll(iterator);
+        ASSERT_EQ(std::vector<Record>(expected.begin() + 6, expected.end()), rest) << file;
+
+        indigoFree(iterator);
+    }
+}
+
+TEST_F(IndigoIteratorTest, test_offset_index)
+{
+    std::string source = dataPath("molecules/basic/thiazolidines.sdf");
+    std::string path = "iterator_test_offset_index.sdf";
+    std::string index_path = path + ".idx";
+
+    copyFile(source, path);
+    std::remove(index_path.c_str());
+
+    indigoSetOptionInt("iterator-threads", 0);
+    std::vector<Record> expected = readFile(path);
+    int total = (int)expected.size();
+
+    indigoSetOptionBool("iterator-index", true);
+
+    // The index is built on the first random access and used by the next iterators
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int iterator = indigoIterateSDFile(path.c_str());
+        ASSERT_EQ(total, indigoCount(iterator));
+        ASSERT_TRUE(fileExists(index_path));
+
+        for (int index : {total - 1, 0, total / 2})
+        {
+            int item = indigoAt(iterator, index);
+            ASSERT_EQ(index, indigoIndex(item));
+            ASSERT_EQ(expected[index].second, recordSmiles(item));
+            indigoFree(item);
+        }
+        ASSERT_EQ(std::vector<Record>(expected.begin() + total / 2 + 1, expected.end()), readAll(iterator));
+        ASSERT_THROW(indigoAt(iterator, total), Exception);
+        indigoFree(iterator);
+    }
+
+    // The index of a modified file is rebuilt
+    copyFile(source, path, true);
+    int iterator = indigoIterateSDFile(path.c_str());
+    ASSERT_EQ(total * 2, indigoCount(iterator));
+    int item = indigoAt(iterator, total + 3);
+    ASSERT_EQ(expected[3].second, recordSmiles(item));
+    indigoFree(item);
+    indigoFree(iterator);
+
+    indigoSetOptionBool("iterator-index", false);
+    std::remove(path.c_str());
+    std::remove(index_path.c_str());
+}
+
+TEST_F(IndigoIteratorTest, test_offset_index_gzip)
+{
+    std::string path = "iterator_test_offset_index.sdf.gz";
+    std::string index_path = path + ".idx";
+
+    copyFile(dataPath("molecules/basic/zinc-slice.sdf.gz"), path);
+    std::remove(index_path.c_str());
+
+    // Gzipped files can not be indexed and no index file is left behind
+    indigoSetOptionBool("iterator-index", true);
+    int iterator = indigoIterateSDFile(path.c_str());
+    int item = indigoNext(iterator);
+    ASSERT_GT(item, 0);
+    indigoFree(item);
+    ASSERT_THROW(indigoAt(iterator, 0), Exception);
+    indigoFree(iterator);
+    ASSERT_FALSE(fileExists(index_path));
+
+    indigoSetOptionBool("iterator-index", false);
+    std::remove(path.c_str());
+}
+
+TEST(IndigoOffsetIndexTest, test_source_changes)
+{
+    std::string path = dataPath("molecules/basic/thiazolidines.sdf");
+    std::string index_path = "iterator_test_changes.sdf.idx";
+
+    FileScanner scanner(path.c_str());
+    SdfLoader loader(scanner);
+    {
+        FileOutput output(index_path.c_str());
+        loader.saveIndex(output, 1000);
+    }
+
+    RecordOffsetIndex index;
+    ASSERT_TRUE(index.load(ENCODING_ASCII, index_path.c_str(), scanner, 1000));
+
+    SdfLoader indexed(scanner);
+    indexed.useIndex(&index);
+    ASSERT_EQ(loader.count(), indexed.count());
+
+    // A source with another modification time, e.g. edited in the middle
+    // without changing its length, does not match the index
+    ASSERT_FALSE(index.load(ENCODING_ASCII, index_path.c_str(), scanner, 1001));
+
+    // An index does not match other sources
+    BufferScanner other("CCO");
+    ASSERT_FALSE(index.load(ENCODING_ASCII, index_path.c_str(), other, 1000));
+
+    std::remove(index_path.c_str());
+}
+
+TEST(IndigoOffsetIndexTest, test_invalid_offsets)
+{
+    std::string index_path = "iterator_test_invalid.idx";
+    const char* text = "$$$$\n$$$$\n";
+    BufferScanner source(text);
+    RecordOffsetIndex index;
+
+    auto saveOffsets = [&](std::vector<long long> values) {
+        Array<long long> offsets;
+        for (long long value : values)
+            offsets.push(value);
+        FileOutput output(index_path.c_str());
+        RecordOffsetIndex::save(output, source, 0, offsets);
+    };
+
+    saveOffsets({0, 5, 10});
+    ASSERT_TRUE(index.load(ENCODING_ASCII, index_path.c_str(), source, 0));
+    ASSERT_EQ(2, index.count());
+
+    // Offsets out of order or beyond the end of the source are rejected
+    saveOffsets({5, 0, 10});
+    ASSERT_FALSE(index.load(ENCODING_ASCII, index_path.c_str(), source, 0));
+    saveOffsets({0, 5, 100});
+    ASSERT_FALSE(index.load(ENCODING_ASCII, index_path.c_str(), source, 0));
+
+    // A corrupted offset is rejected
+    saveOffsets({0, 5, 10});
+    {
+        std::fstream file(index_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-(long long)sizeof(long long), std::ios::end);
+        long long bad = 1000;
+        file.write((const char*)&bad, sizeof(bad));
+    }
+    ASSERT_FALSE(index.load(ENCODING_ASCII, index_path.c_str(), source, 0));
+
+    std::remove(index_path.c_str());
+}
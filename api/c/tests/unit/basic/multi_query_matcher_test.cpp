@@ -0,0 +1,107 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/scanner.h>
+#include <indigo.h>
+#include <molecule/molecule.h>
+#include <molecule/molecule_substructure_matcher.h>
+#include <molecule/multi_query_substructure_matcher.h>
+#include <molecule/query_molecule.h>
+#include <molecule/smiles_loader.h>
+
+#include "common.h"
+
+using namespace indigo;
+
+TEST(IndigoBasicApiTest, test_match_all)
+{
+    qword session = indigoAllocSessionId();
+    indigoSetSessionId(session);
+    indigoSetErrorHandler(errorHandling, 0);
+
+    const char* queries[] = {"c1ccccc1", "[OH]C=O", "[N;!H0]", "[$(C=O)]N", "[#1]", "C(F)(F)F", "[Cl,Br,I]", "*~*~*~*~*~*~*~*~*~*~*~*"};
+    const char* targets[] = {"OC(=O)c1ccc(N)cc1", "CC(=O)NC", "FC(F)(F)c1ccccc1Cl", "C", "CCCC"};
+
+    int arr = indigoCreateArray();
+    for (auto smarts : queries)
+        indigoArrayAdd(arr, indigoLoadSmartsFromString(smarts));
+
+    int multi = indigoMultiQuerySubstructureMatcher(arr, "");
+
+    for (auto smiles : targets)
+    {
+        int target = indigoLoadMoleculeFromString(smiles);
+
+        int count = 0;
+        const int* ids = indigoMatchAll(multi, target, &count);
+        ASSERT_NE(nullptr, ids);
+
+        std::vector<int> expected;
+        int matcher = indigoSubstructureMatcher(target, "");
+        for (int i = 0; i < indigoCount(arr); i++)
+        {
+            int match = indigoMatch(matcher, indigoAt(arr, i));
+            if (match != 0)
+            {
+                expected.push_back(i);
+                indigoFree(match);
+            }
+        }
+        indigoFree(matcher);
+
+        ASSERT_EQ(expected, std::vector<int>(ids, ids + count)) << smiles;
+        indigoFree(target);
+    }
+
+    indigoFree(multi);
+    indigoFree(arr);
+    indigoReleaseSessionId(session);
+}
+
+TEST(IndigoBasicApiTest, test_match_all_3d_constraints)
+{
+    QueryMolecule query;
+    BufferScanner scanner("[#6][#1,#8]");
+    SmilesLoader loader(scanner);
+    loader.smarts_mode = true;
+    loader.loadQueryMolecule(query);
+
+    // The constrained query atom can not be mapped to an implicit target
+    // hydrogen, which has no position
+    typedef Molecule3dConstraints MC;
+    for (int i = 0; i < 2; i++)
+    {
+        std::unique_ptr<MC::PointByAtom> point = std::make_unique<MC::PointByAtom>();
+        point->atom_idx = i;
+        query.spatial_constraints.add(point.release());
+    }
+    std::unique_ptr<MC::DistanceByPoints> distance = std::make_unique<MC::DistanceByPoints>();
+    distance->beg_id = 0;
+    distance->end_id = 1;
+    distance->bottom = 0;
+    distance->top = 100;
+    query.spatial_constraints.add(distance.release());
+
+    MultiQuerySubstructureMatcher multi;
+    multi.addQuery(query);
+
+    std::pair<const char*, bool> targets[] = {{"C", false}, {"CO", true}};
+    for (auto& target_match : targets)
+    {
+        const char* smiles = target_match.first;
+        Molecule target;
+        loadMolecule(smiles, target);
+
+        MoleculeSubstructureMatcher matcher(target);
+        matcher.setQuery(query);
+        bool expected = matcher.find();
+        ASSERT_EQ(target_match.second, expected) << smiles;
+
+        Array<int> ids;
+        multi.match(target, ids);
+        ASSERT_EQ(expected, ids.size() == 1) << smiles;
+    }
+}
@@ -0,0 +1,42 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/profiling.h>
+
+using namespace indigo;
+
+TEST(IndigoProfilingTest, test_merge_threads)
+{
+    profTimersResetSession();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 1000; i++)
+                profIncCounter("profiling_test_counter", 2);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    profIncCounter("profiling_test_counter", 2);
+
+    ProfilingSystem& inst = ProfilingSystem::getInstance();
+    ASSERT_TRUE(inst.hasLabel("profiling_test_counter"));
+    ASSERT_EQ(inst.getLabelCallCount("profiling_test_counter"), 4001);
+    ASSERT_EQ(inst.getLabelValue("profiling_test_counter"), 8002);
+
+    profTimersReset();
+    ASSERT_EQ(inst.getLabelCallCount("profiling_test_counter"), 0);
+    ASSERT_EQ(inst.getLabelCallCount("profiling_test_counter", true), 4001);
+}
+
+TEST(IndigoProfilingTest, test_labels_over_capacity)
+{
+    ProfilingSystem& inst = ProfilingSystem::getInstance();
+    ASSERT_NO_THROW(inst.addCounter(1 << 20, 1));
+    ASSERT_NO_THROW(inst.addTimer(1 << 20, 1));
+}
@@ -0,0 +1,95 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/scanner.h>
+#include <molecule/elements.h>
+#include <molecule/molecule.h>
+#include <molecule/molecule_substructure_matcher.h>
+#include <molecule/query_molecule.h>
+#include <molecule/smiles_loader.h>
+
+#include "common.h"
+
+using namespace indigo;
+
+TEST(IndigoQueryProgramTest, test_program_matches_tree)
+{
+    const char* queries[] = {"[#6,#7,#8;!$(C=O)]-,:[!#1;X3]", "[N,O;+0,-1;!H0]", "[!C;!N;R]=,#[c,n]", "[$([CX3]=O),$([SX4](=O)=O)][OH1]", "[*;A;D2;!R]~[#9,#17,#35,#53]", "[!#6!#1]!@*"};
+    const char* targets[] = {"OC(=O)c1ccc(N)cc1", "C[N+](C)(C)CC([O-])=O", "FC(Cl)(Br)C#N", "CS(=O)(=O)O", "c1ccncc1CCI"};
+
+    for (auto smarts : queries)
+    {
+        QueryMolecule query;
+        BufferScanner scanner(smarts);
+        SmilesLoader loader(scanner);
+        loader.smarts_mode = true;
+        loader.loadQueryMolecule(query);
+
+        for (auto smiles : targets)
+        {
+            Molecule target;
+            loadMolecule(smiles, target);
+
+            for (dword flags : {0xFFFFFFFFU, 0xFFFFFFFFU & ~(dword)MoleculeSubstructureMatcher::MATCH_ATOM_CHARGE})
+            {
+                for (int i = query.vertexBegin(); i != query.vertexEnd(); i = query.vertexNext(i))
+                    for (int j = target.vertexBegin(); j != target.vertexEnd(); j = target.vertexNext(j))
+                    {
+                        MoleculeSubstructureMatcher::FragmentMatchCache cache1, cache2;
+                        bool tree = MoleculeSubstructureMatcher::matchQueryAtom(&query.getAtom(i), target, j, &cache1, flags);
+                        bool program = MoleculeSubstructureMatcher::matchQueryAtom(query.getAtomProgram(i), target, j, &cache2, flags);
+                        ASSERT_EQ(tree, program) << smarts << " " << smiles << " " << i << " " << j;
+                    }
+
+                for (int i = query.edgeBegin(); i != query.edgeEnd(); i = query.edgeNext(i))
+                    for (int j = target.edgeBegin(); j != target.edgeEnd(); j = target.edgeNext(j))
+                    {
+                        bool tree = MoleculeSubstructureMatcher::matchQueryBond(&query.getBond(i), target, i, j, 0, flags);
+                        bool program = MoleculeSubstructureMatcher::matchQueryBond(query.getBondProgram(i), target, i, j, 0, flags);
+                        ASSERT_EQ(tree, program) << smarts << " " << smiles << " " << i << " " << j;
+                    }
+            }
+        }
+    }
+}
+
+TEST(IndigoQueryProgramTest, test_programs_shared)
+{
+    QueryMolecule query;
+    BufferScanner scanner("[#6,#7;!R]-,:[N,O;+0,-1;!H0]");
+    SmilesLoader loader(scanner);
+    loader.smarts_mode = true;
+    loader.loadQueryMolecule(query);
+
+    Molecule target;
+    loadMolecule("CCN", target);
+
+    // Matchers on several threads share the programs compiled once
+    std::vector<const QueryMolecule::Program*> programs(8);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < (int)programs.size(); i++)
+        threads.emplace_back([&query, &programs, i]() { programs[i] = &query.getAtomProgram(1); });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const QueryMolecule::Program* program : programs)
+        ASSERT_EQ(&query.getAtomProgram(1), program);
+
+    MoleculeSubstructureMatcher::FragmentMatchCache cache;
+    ASSERT_TRUE(MoleculeSubstructureMatcher::matchQueryAtom(query.getAtomProgram(1), target, 2, &cache, 0xFFFFFFFFU));
+
+    // Invalidating an atom recompiles only its program and keeps the old one alive
+    const QueryMolecule::Program& program0 = query.getAtomProgram(0);
+    const QueryMolecule::Program& program1 = query.getAtomProgram(1);
+    query.invalidateAtom(0, BaseMolecule::CHANGED_ATOM_NUMBER);
+    ASSERT_EQ(&query.getAtomProgram(1), &program1);
+    ASSERT_NE(&query.getAtomProgram(0), &program0);
+    ASSERT_EQ(program0.start(), query.getAtomProgram(0).start());
+    ASSERT_TRUE(MoleculeSubstructureMatcher::matchQueryAtom(program1, target, 2, &cache, 0xFFFFFFFFU));
+
+    // Replacing an atom recompiles the programs
+    query.resetAtom(1, new QueryMolecule::Atom(QueryMolecule::ATOM_NUMBER, ELEM_O));
+    ASSERT_FALSE(MoleculeSubstructureMatcher::matchQueryAtom(query.getAtomProgram(1), target, 2, &cache, 0xFFFFFFFFU));
+}
@@ -0,0 +1,82 @@
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <base_cpp/array.h>
+#include <base_cpp/scanner.h>
+
+#include "common.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace indigo;
+
+TEST(IndigoScannerTest, test_mapped_file_scanner)
+{
+    const std::string path = dataPath("molecules/basic/thiazolidines.sdf");
+
+    FileScanner file_scanner(path.c_str());
+    MappedFileScanner mapped_scanner(ENCODING_ASCII, path.c_str());
+    ASSERT_TRUE(mapped_scanner.isMapped());
+    ASSERT_EQ(mapped_scanner.length(), file_scanner.length());
+
+    Array<char> file_line, mapped_line;
+    while (!file_scanner.isEOF())
+    {
+        ASSERT_FALSE(mapped_scanner.isEOF());
+        file_scanner.readLine(file_line, true);
+        mapped_scanner.readLine(mapped_line, true);
+        ASSERT_STREQ(mapped_line.ptr(), file_line.ptr());
+        ASSERT_EQ(mapped_scanner.tell(), file_scanner.tell());
+    }
+    ASSERT_TRUE(mapped_scanner.isEOF());
+    ASSERT_EQ(mapped_scanner.lookNext(), -1);
+
+    Array<char> file_data, mapped_data;
+    file_scanner.seek(0, SEEK_SET);
+    mapped_scanner.seek(0, SEEK_SET);
+    file_scanner.readAll(file_data);
+    mapped_scanner.readAll(mapped_data);
+    ASSERT_EQ(mapped_data.size(), file_data.size());
+    ASSERT_EQ(memcmp(mapped_data.ptr(), file_data.ptr(), file_data.size()), 0);
+}
+
+#ifndef _WIN32
+TEST(IndigoScannerTest, test_mapped_file_scanner_fifo)
+{
+    const std::string path = "scanner_test_fifo";
+    const std::string content = "CCO\nc1ccccc1\n";
+
+    unlink(path.c_str());
+    ASSERT_EQ(mkfifo(path.c_str(), 0600), 0);
+
+    // The writer is blocked until the only reader opens the pipe
+    std::thread writer([&path, &content]() {
+        int fd = open(path.c_str(), O_WRONLY);
+        if (fd < 0)
+            return;
+        ssize_t written = write(fd, content.c_str(), content.size());
+        (void)written;
+        close(fd);
+    });
+
+    Array<char> data;
+    bool mapped;
+    {
+        MappedFileScanner scanner(ENCODING_ASCII, path.c_str());
+        mapped = scanner.isMapped();
+        while (scanner.lookNext() != -1)
+            data.push(scanner.readChar());
+    }
+    writer.join();
+    unlink(path.c_str());
+
+    ASSERT_FALSE(mapped);
+    ASSERT_EQ(content, std::string(data.ptr(), data.size()));
+}
+#endif
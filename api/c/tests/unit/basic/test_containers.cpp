@@ -2,6 +2,7 @@
 
 #include <base_cpp/array.h>
 #include <base_cpp/red_black.h>
+#include <base_cpp/tlscont.h>
 
 using namespace indigo;
 
@@ -31,3 +32,21 @@ TEST(IndigoContainersTest, test_red_black)
     map.clear();
     ASSERT_EQ(map.size(), 0);
 }
+
+TEST(IndigoContainersTest, test_session_local_container)
+{
+    // Containers rely on static storage, as TL_DECL declares them
+    static _SessionLocalContainer<int> container;
+    container.getLocalCopy(1) = 10;
+    container.getLocalCopy(2) = 20;
+    ASSERT_EQ(container.getLocalCopy(1), 10);
+    ASSERT_EQ(container.getLocalCopy(2), 20);
+
+    // Removed copy must not be returned from the lookup cache
+    container.removeLocalCopy(1);
+    ASSERT_EQ(container.getLocalCopy(1), 0);
+    ASSERT_EQ(container.getLocalCopy(2), 20);
+
+    static _SessionLocalContainer<int> other;
+    ASSERT_EQ(other.getLocalCopy(2), 0);
+}
@@ -1,7 +1,18 @@
+#include <algorithm>
+#include <cstdio>
 #include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
 
 #include <gtest/gtest.h>
 
+#include <base_c/os_dir.h>
 #include <base_cpp/output.h>
 #include <base_cpp/profiling.h>
 #include <base_cpp/scanner.h>
@@ -19,10 +30,46 @@
 
 using namespace indigo;
 
-TEST(BingoNosqlTest, test_enumerate_id)
+class BingoNosqlTest : public ::testing::Test
 {
+protected:
+    void TearDown() override
+    {
+        for (const std::string& path : _databases)
+            removeDatabase(path);
+    }
+
+    // Databases are created in the temporary directory and removed after the test
+    std::string databasePath(const char* name)
+    {
+        std::string path = ::testing::TempDir() + name;
+        removeDatabase(path);
+        _databases.push_back(path);
+        return path;
+    }
 
-    int db = bingoCreateDatabaseFile("test.db", "molecule", "");
+private:
+    static void removeDatabase(const std::string& path)
+    {
+        OsDirIter iter;
+        if (osDirSearch(path.c_str(), 0, &iter) != OS_DIR_OK)
+            return;
+        while (osDirNext(&iter) == OS_DIR_OK)
+            std::remove(iter.path);
+#ifdef _WIN32
+        _rmdir(path.c_str());
+#else
+        rmdir(path.c_str());
+#endif
+    }
+
+    std::vector<std::string> _databases;
+};
+
+TEST_F(BingoNosqlTest, test_enumerate_id)
+{
+
+    int db = bingoCreateDatabaseFile(databasePath("test.db").c_str(), "molecule", "");
     int obj = indigoLoadMoleculeFromString("C1CCNCC1");
     bingoInsertRecordObj(db, obj);
     bingoInsertRecordObj(db, obj);
@@ -41,7 +88,7 @@ TEST(BingoNosqlTest, test_enumerate_id)
     ASSERT_EQ(count, 3);
 }
 
-TEST(BingoNosqlTest, test_loadtargetscmf)
+TEST_F(BingoNosqlTest, test_loadtargetscmf)
 {
     FileScanner sc(dataPath("molecules/resonance/resonance.sdf").c_str());
 
@@ -81,4 +128,95 @@ TEST(BingoNosqlTest, test_loadtargetscmf)
     {
         ASSERT_STREQ("", e.message());
     }
-}
\ No newline at end of file
+}
+TEST_F(BingoNosqlTest, test_parallel_search)
+{
+    const char* smiles[] = {"C1CCNCC1", "c1ccccc1", "c1ccccc1N", "c1ccccc1O", "CCO", "CCN", "c1ccc2ccccc2c1", "OCC1CCNCC1", "Nc1ccc(O)cc1", "CC(=O)O"};
+
+    int db = bingoCreateDatabaseFile(databasePath("test_parallel.db").c_str(), "molecule", "");
+    for (int i = 0; i < 50; i++)
+    {
+        int obj = indigoLoadMoleculeFromString(smiles[i % 10]);
+        bingoInsertRecordObj(db, obj);
+        indigoFree(obj);
+    }
+
+    auto collect = [](int search) {
+        std::vector<int> ids;
+        while (bingoNext(search) > 0)
+            ids.push_back(bingoGetCurrentId(search));
+        bingoEndSearch(search);
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    int query = indigoLoadQueryMoleculeFromString("c1ccccc1");
+    auto serial_sub = collect(bingoSearchSub(db, query, ""));
+    auto parallel_sub = collect(bingoSearchSub(db, query, "threads:4"));
+    ASSERT_EQ(serial_sub.size(), 25);
+    ASSERT_EQ(serial_sub, parallel_sub);
+
+    int sim_query = indigoLoadMoleculeFromString("c1ccccc1N");
+    auto serial_sim = collect(bingoSearchSim(db, sim_query, 0.5f, 1.0f, ""));
+    auto parallel_sim = collect(bingoSearchSim(db, sim_query, 0.5f, 1.0f, "threads:4"));
+    ASSERT_FALSE(serial_sim.empty());
+    ASSERT_EQ(serial_sim, parallel_sim);
+
+    // The workers of an unfinished search are stopped when it ends
+    int search = bingoSearchSub(db, query, "threads:4");
+    ASSERT_GT(bingoNext(search), 0);
+    bingoEndSearch(search);
+
+    bingoCloseDatabase(db);
+}
+
+TEST_F(BingoNosqlTest, test_insert_batch)
+{
+    const char* smiles[] = {"C1CCNCC1", "c1ccccc1", "c1ccccc1N", "c1ccccc1O", "CCO", "CCN", "c1ccc2ccccc2c1", "OCC1CCNCC1", "Nc1ccc(O)cc1", "CC(=O)O"};
+
+    indigoSetErrorHandler(errorHandling, 0);
+
+    int db = bingoCreateDatabaseFile(databasePath("test_insert_batch.db").c_str(), "molecule", "");
+    int arr = indigoCreateArray();
+    std::vector<int> ids;
+    for (int i = 0; i < 50; i++)
+    {
+        int obj = indigoLoadMoleculeFromString(smiles[i % 10]);
+        indigoArrayAdd(arr, obj);
+        indigoFree(obj);
+        ids.push_back(1000 + i);
+    }
+
+    ASSERT_EQ(bingoInsertRecordObjBatch(db, arr, ids.data(), (int)ids.size(), "threads:4;bulk-load:true"), 50);
+    ASSERT_THROW(bingoInsertRecordObjBatch(db, arr, ids.data(), (int)ids.size(), "threads:4"), Exception);
+
+    // Only the records with ids are inserted
+    int short_ids[] = {2000, 2001, 2002, 2003, 2004};
+    ASSERT_EQ(bingoInsertRecordObjBatch(db, arr, short_ids, 5, "threads:4"), 5);
+
+    // A batch with an object of a wrong type is rejected before any record is inserted
+    int mixed = indigoCreateArray();
+    int mol = indigoLoadMoleculeFromString("c1ccccc1C");
+    int rxn = indigoLoadReactionFromString("CC>>CO");
+    indigoArrayAdd(mixed, mol);
+    indigoArrayAdd(mixed, rxn);
+    int mixed_ids[] = {3000, 3001};
+    ASSERT_THROW(bingoInsertRecordObjBatch(db, mixed, mixed_ids, 2, ""), Exception);
+    indigoFree(mol);
+    indigoFree(rxn);
+    indigoFree(mixed);
+    bingoOptimize(db);
+
+    int query = indigoLoadQueryMoleculeFromString("c1ccccc1");
+    int search = bingoSearchSub(db, query, "");
+    std::vector<int> found;
+    while (bingoNext(search) > 0)
+        found.push_back(bingoGetCurrentId(search));
+    bingoEndSearch(search);
+    ASSERT_EQ(found.size(), 28);
+    for (int id : found)
+        ASSERT_TRUE(((id >= 1000 && id < 1050) || (id >= 2000 && id < 2005)) && (id % 10 == 1 || id % 10 == 2 || id % 10 == 3 || id % 10 == 6 || id % 10 == 8));
+
+    indigoFree(arr);
+    bingoCloseDatabase(db);
+}
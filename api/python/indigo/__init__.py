@@ -1734,6 +1734,12 @@ class IndigoObject(object):
             Indigo._lib.indigoCanonicalSmiles(self.id)
         )
 
+    def canonicalHash(self):
+        self.dispatcher._setSessionId()
+        return self.dispatcher._checkResultString(
+            Indigo._lib.indigoCanonicalHash(self.id)
+        )
+
     def canonicalSmarts(self):
         self.dispatcher._setSessionId()
         return self.dispatcher._checkResultString(
@@ -2106,6 +2112,17 @@ class IndigoObject(object):
         else:
             return self.dispatcher.IndigoObject(self.dispatcher, newobj, self)
 
+    def matchAll(self, target):
+        c_size = c_int()
+        self.dispatcher._setSessionId()
+        c_buf = self.dispatcher._checkResultPtr(
+            Indigo._lib.indigoMatchAll(self.id, target.id, pointer(c_size))
+        )
+        res = array("i")
+        for i in range(c_size.value):
+            res.append(c_buf[i])
+        return res
+
     def countMatches(self, query):
         self.dispatcher._setSessionId()
         return self.dispatcher._checkResult(
@@ -2512,6 +2529,12 @@ class Indigo(object):
         Indigo._lib.indigoCommonBits.argtypes = [c_int, c_int]
         Indigo._lib.indigoSimilarity.restype = c_float
         Indigo._lib.indigoSimilarity.argtypes = [c_int, c_int, c_char_p]
+        Indigo._lib.indigoMorganFeatures.restype = POINTER(c_int)
+        Indigo._lib.indigoMorganFeatures.argtypes = [
+            c_int,
+            c_char_p,
+            POINTER(c_int),
+        ]
         Indigo._lib.indigoIterateSDF.restype = c_int
         Indigo._lib.indigoIterateSDF.argtypes = [c_int]
         Indigo._lib.indigoIterateRDF.restype = c_int
@@ -2540,6 +2563,13 @@ class Indigo(object):
         Indigo._lib.indigoCreateArray.argtypes = None
         Indigo._lib.indigoSubstructureMatcher.restype = c_int
         Indigo._lib.indigoSubstructureMatcher.argtypes = [c_int, c_char_p]
+        Indigo._lib.indigoMultiQuerySubstructureMatcher.restype = c_int
+        Indigo._lib.indigoMultiQuerySubstructureMatcher.argtypes = [
+            c_int,
+            c_char_p,
+        ]
+        Indigo._lib.indigoMatchAll.restype = POINTER(c_int)
+        Indigo._lib.indigoMatchAll.argtypes = [c_int, c_int, POINTER(c_int)]
         Indigo._lib.indigoExtractCommonScaffold.restype = c_int
         Indigo._lib.indigoExtractCommonScaffold.argtypes = [c_int, c_char_p]
         Indigo._lib.indigoDecomposeMolecules.restype = c_int
@@ -3062,6 +3092,8 @@ class Indigo(object):
         Indigo._lib.indigoMassComposition.argtypes = [c_int]
         Indigo._lib.indigoCanonicalSmiles.restype = c_char_p
         Indigo._lib.indigoCanonicalSmiles.argtypes = [c_int]
+        Indigo._lib.indigoCanonicalHash.restype = c_char_p
+        Indigo._lib.indigoCanonicalHash.argtypes = [c_int]
         Indigo._lib.indigoCanonicalSmarts.restype = c_char_p
         Indigo._lib.indigoCanonicalSmarts.argtypes = [c_int]
         Indigo._lib.indigoLayeredCode.restype = c_char_p
@@ -3806,6 +3838,29 @@ class Indigo(object):
             )
         )
 
+    def morganFeatures(self, molecules, type="ECFP4"):
+        molecules = self.convertToArray(molecules)
+        if type is None:
+            type = "ECFP4"
+        c_size = c_int()
+        self._setSessionId()
+        c_buf = self._checkResultPtr(
+            Indigo._lib.indigoMorganFeatures(
+                molecules.id, type.encode(ENCODE_ENCODING), pointer(c_size)
+            )
+        )
+        res = []
+        pos = 0
+        while pos < c_size.value:
+            n = c_buf[pos]
+            features = {}
+            for i in range(n):
+                feature_id = c_buf[pos + 1 + 2 * i] & 0xFFFFFFFF
+                features[feature_id] = c_buf[pos + 2 + 2 * i]
+            res.append(features)
+            pos += 1 + 2 * n
+        return res
+
     def iterateSDFile(self, filename):
         self._setSessionId()
         return self.IndigoObject(
@@ -3904,6 +3959,20 @@ class Indigo(object):
             target,
         )
 
+    def multiQuerySubstructureMatcher(self, queries, mode=""):
+        queries = self.convertToArray(queries)
+        if mode is None:
+            mode = ""
+        self._setSessionId()
+        return self.IndigoObject(
+            self,
+            self._checkResult(
+                Indigo._lib.indigoMultiQuerySubstructureMatcher(
+                    queries.id, mode.encode(ENCODE_ENCODING)
+                )
+            ),
+        )
+
     def extractCommonScaffold(self, structures, options=""):
         structures = self.convertToArray(structures)
         if options is None:
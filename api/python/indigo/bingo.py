@@ -54,6 +54,8 @@ class Bingo(object):
         self._lib.bingoInsertRecordObjWithId.argtypes = [c_int, c_int, c_int]
         self._lib.bingoInsertRecordObjWithIdAndExtFP.restype = c_int
         self._lib.bingoInsertRecordObjWithIdAndExtFP.argtypes = [c_int, c_int, c_int, c_int]
+        self._lib.bingoInsertRecordObjBatch.restype = c_int
+        self._lib.bingoInsertRecordObjBatch.argtypes = [c_int, c_int, POINTER(c_int), c_int, c_char_p]
         self._lib.bingoDeleteRecord.restype = c_int
         self._lib.bingoDeleteRecord.argtypes = [c_int, c_int]
         self._lib.bingoSearchSub.restype = c_int
@@ -182,6 +184,18 @@ class Bingo(object):
             return Bingo._checkResult(self._indigo,
                                       self._lib.bingoInsertRecordObjWithIdAndExtFP(self._id, indigoObject.id, index, ext_fp.id))
 
+    def insertBatch(self, indigoObjects, indexes=None, options=''):
+        self._indigo._setSessionId()
+        if not options:
+            options = ''
+        ids = None
+        ids_count = 0
+        if indexes:
+            ids = (c_int * len(indexes))(*indexes)
+            ids_count = len(indexes)
+        return Bingo._checkResult(self._indigo,
+                                  self._lib.bingoInsertRecordObjBatch(self._id, indigoObjects.id, ids, ids_count, options.encode('ascii')))
+
     def delete(self, index):
         self._indigo._setSessionId()
         Bingo._checkResult(self._indigo, self._lib.bingoDeleteRecord(self._id, index))
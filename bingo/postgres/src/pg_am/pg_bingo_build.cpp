@@ -30,7 +30,7 @@ extern "C"
 
 enum
 {
-    BINGO_AM_STRATEGIES = 7,
+    BINGO_AM_STRATEGIES = 8,
     BINGO_AM_SUPPORT = 7
 };
 
@@ -69,6 +69,12 @@ PG_MODULE_MAGIC;
     CEXPORT void bingo_rescan(IndexScanDesc, ScanKey, int, ScanKey, int);
     CEXPORT void bingo_endscan(IndexScanDesc);
     CEXPORT bool bingo_gettuple(IndexScanDesc, ScanDirection);
+    CEXPORT int64 bingo_getbitmap(IndexScanDesc, TIDBitmap*);
+#if PG_VERSION_NUM / 100 >= 1000
+    CEXPORT Size bingo_estimateparallelscan(void);
+    CEXPORT void bingo_initparallelscan(void*);
+    CEXPORT void bingo_parallelrescan(IndexScanDesc);
+#endif
 
 #else
     BINGO_FUNCTION_EXPORT(bingo_build);
@@ -88,7 +94,7 @@ Datum bingo_handler(PG_FUNCTION_ARGS)
     amroutine->amstrategies = BINGO_AM_STRATEGIES;
     amroutine->amsupport = BINGO_AM_SUPPORT;
     amroutine->amcanorder = false;
-    amroutine->amcanorderbyop = false;
+    amroutine->amcanorderbyop = true;
     amroutine->amcanbackward = true;
     amroutine->amcanunique = false;
     amroutine->amcanmulticol = false;
@@ -108,10 +114,10 @@ Datum bingo_handler(PG_FUNCTION_ARGS)
     amroutine->amcanreturn = NULL;
 
 #if PG_VERSION_NUM / 100 >= 1000
-    amroutine->amcanparallel = false;
-    amroutine->amestimateparallelscan = NULL;
-    amroutine->aminitparallelscan = NULL;
-    amroutine->amparallelrescan = NULL;
+    amroutine->amcanparallel = true;
+    amroutine->amestimateparallelscan = bingo_estimateparallelscan;
+    amroutine->aminitparallelscan = bingo_initparallelscan;
+    amroutine->amparallelrescan = bingo_parallelrescan;
 #endif
 
 #if PG_VERSION_NUM / 100 >= 1200
@@ -129,7 +135,7 @@ Datum bingo_handler(PG_FUNCTION_ARGS)
     amroutine->amrescan = bingo_rescan;
     amroutine->amgettuple = bingo_gettuple;
     amroutine->amendscan = bingo_endscan;
-    amroutine->amgetbitmap = NULL;
+    amroutine->amgetbitmap = bingo_getbitmap;
     amroutine->ammarkpos = NULL;
     amroutine->amrestrpos = NULL;
 
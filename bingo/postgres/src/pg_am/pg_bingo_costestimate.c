@@ -309,6 +309,37 @@
 
 
 
+/*
+ * The search screens the fingerprints of all the structures in all the
+ * sections, so the CPU cost grows with the index size. One cpu_operator_cost
+ * is charged per structure. The same cost is reported for the serial and the
+ * partial paths, and the split between the workers is left to cost_index
+ */
+static Cost bingo_screening_cost(IndexPath* path)
+{
+    return Max(path->indexinfo->tuples, 1.0) * cpu_operator_cost;
+}
+
+/*
+ * An ordered scan returns all the structures in the order of the distance,
+ * and the index conditions are not screened but rechecked by the executor on
+ * every returned row. So the conditions do not reduce the fetched rows, and
+ * their evaluation is charged per structure
+ */
+static void bingo_ordered_scan_cost(PlannerInfo* root, IndexPath* path, List* indexQuals, Cost* indexTotalCost, Selectivity* indexSelectivity)
+{
+    QualCost recheck_cost;
+
+    if (path->indexorderbys == NIL)
+        return;
+
+    *indexSelectivity = 1.0;
+    if (indexQuals == NIL)
+        return;
+
+    cost_qual_eval(&recheck_cost, indexQuals, root);
+    *indexTotalCost += recheck_cost.startup + Max(path->indexinfo->tuples, 1.0) * recheck_cost.per_tuple;
+}
 
 #if PG_VERSION_NUM / 100 >= 1200
 
@@ -322,9 +353,13 @@ void bingo_costestimate120(struct PlannerInfo* root, struct IndexPath* path, dou
     costs.numIndexPages = 1;
     genericcostestimate(root, path, loop_count, &costs);
 
-    costs.indexTotalCost = 1;
+    costs.indexTotalCost += bingo_screening_cost(path);
+    bingo_ordered_scan_cost(root, path, get_quals_from_indexclauses(path->indexclauses), &costs.indexTotalCost, &costs.indexSelectivity);
     costs.indexCorrelation = -1;
-    costs.numIndexPages = 1;
+    /*
+     * All the sections are scanned, and the index size defines the number of parallel workers
+     */
+    costs.numIndexPages = Max(path->indexinfo->pages, 1);
 
     *indexStartupCost = costs.indexStartupCost;
 	*indexTotalCost = costs.indexTotalCost;
@@ -560,7 +595,8 @@ static void genericcostestimate92(PlannerInfo* root, IndexPath* path, double loo
      * life of the scan node.
      */
     *indexTotalCost += num_sa_scans * 100.0 * cpu_operator_cost;
-    *indexTotalCost = 1.0;
+    *indexTotalCost += bingo_screening_cost(path);
+    bingo_ordered_scan_cost(root, path, indexQuals, indexTotalCost, indexSelectivity);
 
     /*
      * Generic assumption about index correlation: there isn't any.
@@ -580,7 +616,10 @@ void bingo_costestimate101(struct PlannerInfo* root, struct IndexPath* path, dou
 
     genericcostestimate92(root, path, loop_count, 1.0, indexStartupCost, indexTotalCost, indexSelectivity, indexCorrelation);
 
-    *indexPages = 1;
+    /*
+     * All the sections are scanned, and the index size defines the number of parallel workers
+     */
+    *indexPages = Max(path->indexinfo->pages, 1);
 }
 #endif
 
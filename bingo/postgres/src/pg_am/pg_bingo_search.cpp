@@ -7,6 +7,7 @@ extern "C"
 #include "access/skey.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "nodes/tidbitmap.h"
 #include "utils/rel.h"
 #include "utils/relcache.h"
 #if PG_VERSION_NUM / 100 >= 1200
@@ -30,10 +31,6 @@ extern "C"
     BINGO_FUNCTION_EXPORT(bingo_beginscan);
 
     BINGO_FUNCTION_EXPORT(bingo_gettuple);
-    /*
-     * Turn off bitmap scan
-     */
-    // BINGO_FUNCTION_EXPORT(bingo_getbitmap);
 
     BINGO_FUNCTION_EXPORT(bingo_rescan);
 
@@ -127,6 +124,12 @@ Datum bingo_rescan(PG_FUNCTION_ARGS)
         {
             memmove(scan->keyData, scankey, scan->numberOfKeys * sizeof(ScanKeyData));
         }
+#if PG_VERSION_NUM / 100 >= 906
+        if (orderbys && scan->numberOfOrderBys > 0)
+        {
+            memmove(scan->orderByData, orderbys, scan->numberOfOrderBys * sizeof(ScanKeyData));
+        }
+#endif
 
         so = (BingoPgSearch*)scan->opaque;
         if (so != NULL)
@@ -171,42 +174,56 @@ Datum bingo_endscan(PG_FUNCTION_ARGS)
     PG_RETURN_VOID();
 #endif
 }
+#if PG_VERSION_NUM / 100 >= 1000
+/*
+ * Size of the shared state of a parallel scan
+ */
+CEXPORT Size bingo_estimateparallelscan(void)
+{
+    return BingoPgSearchEngine::getParallelScanSize();
+}
+
+/*
+ * Initialize the shared state of a parallel scan
+ */
+CEXPORT void bingo_initparallelscan(void* target)
+{
+    BingoPgSearchEngine::initParallelScan(target);
+}
+
+/*
+ * Reset the shared state of a parallel scan before a rescan
+ */
+CEXPORT void bingo_parallelrescan(IndexScanDesc scan)
+{
+    PG_OBJECT parallel_scan = BingoPgSearchEngine::getParallelScan(scan);
+    if (parallel_scan != 0)
+        BingoPgSearchEngine::initParallelScan(parallel_scan);
+}
+#endif
+
+#if PG_VERSION_NUM / 100 >= 906
 /*
  * Get all tuples at once
  */
-// Datum
-// bingo_getbitmap(PG_FUNCTION_ARGS) {
-//   IndexScanDesc scan = (IndexScanDesc) PG_GETARG_POINTER(0);
-//   TIDBitmap *tbm = (TIDBitmap *) PG_GETARG_POINTER(1);
-//
-//   qword item_size = 0;
-//   BingoPgSearch* search_engine = (BingoPgSearch*) scan->opaque;
-//   PG_BINGO_BEGIN
-//   {
-//      /*
-//       * Create search engine
-//       */
-//      /*
-//       * Fetch to the next item and add result to the bitmap
-//       */
-//      indigo::Array<ItemPointerData> found_items;
-//      ItemPointer item_ptr;
-//      do {
-//         item_ptr = &found_items.push();
-//      } while (search_engine->next(scan, item_ptr));
-//      /*
-//       * Pop the last element
-//       */
-//      found_items.pop();
-//      item_size = found_items.size();
-//      BINGO_PG_TRY {
-//         tbm_add_tuples(tbm, found_items.ptr(), found_items.size(), false);
-//      } BINGO_PG_HANDLE(throw BingoPgError("internal error: can not add bitmap solution: %s", message));
-//   }
-//   PG_BINGO_HANDLE(delete search_engine);
-//
-//   PG_RETURN_INT64(item_size);
-//}
+CEXPORT int64 bingo_getbitmap(IndexScanDesc scan, TIDBitmap* tbm)
+{
+    int64 result = 0;
+
+    BingoPgSearch* search_engine = (BingoPgSearch*)scan->opaque;
+    if (search_engine == NULL)
+        elog(ERROR, "bingo: search error: search context was deleted");
+
+    PG_BINGO_BEGIN
+    {
+        result = search_engine->searchBitmap(scan, tbm);
+    }
+    PG_BINGO_HANDLE(delete search_engine; scan->opaque = NULL);
+
+    return result;
+}
+#endif
+
 /*
  * Get a tuples by a chain
  */
@@ -237,7 +254,18 @@ Datum bingo_gettuple(PG_FUNCTION_ARGS)
         #else
             result = search_engine->next(scan, &scan->xs_ctup.t_self);
         #endif
-        
+#if PG_VERSION_NUM / 100 >= 906
+        /*
+         * Ordered scans return all the structures with exact distances, so only the conditions are rechecked
+         */
+        if (result && scan->numberOfOrderBys > 0)
+        {
+            scan->xs_recheck = (scan->numberOfKeys > 0);
+            scan->xs_recheckorderby = false;
+            scan->xs_orderbyvals[0] = Float4GetDatum(search_engine->getDistance());
+            scan->xs_orderbynulls[0] = false;
+        }
+#endif
     }
     PG_BINGO_HANDLE(delete search_engine; scan->opaque = NULL);
     /*
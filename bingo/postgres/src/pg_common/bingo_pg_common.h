@@ -34,6 +34,7 @@ public:
         MOL_MASS_LESS = 5,
         MOL_MASS_GREAT = 6,
         MOL_SIM = 7,
+        MOL_SIM_DIST = 8,
         REACT_SUB = 1,
         REACT_EXACT = 2,
         REACT_SMARTS = 3,
@@ -454,6 +454,53 @@ void BingoPgExternalBitset::bsAndBs(const BingoPgExternalBitset& set1, const Bin
     _recalculateWordsInUse();
 }
 
+void BingoPgExternalBitset::initCounters(indigo::Array<qword>& counters, int max_value) const
+{
+    int planes = 1;
+    while ((max_value >> planes) > 0)
+        ++planes;
+    counters.clear_resize(planes * _length);
+    counters.zerofill();
+}
+
+void BingoPgExternalBitset::addToCounters(indigo::Array<qword>& counters) const
+{
+    int planes = counters.size() / _length;
+    qword* plane_words = counters.ptr();
+    for (int i = 0; i < (*_lastWordPtr); ++i)
+    {
+        // Add the word to the counters: a half adder for every plane while there is a carry
+        qword carry = _words[i];
+        for (int plane = 0; carry != 0 && plane < planes; ++plane)
+        {
+            qword& word = plane_words[plane * _length + i];
+            qword next_carry = word & carry;
+            word ^= carry;
+            carry = next_carry;
+        }
+    }
+}
+
+void BingoPgExternalBitset::getCounters(const indigo::Array<qword>& counters, indigo::Array<int>& values) const
+{
+    int planes = counters.size() / _length;
+    const qword* plane_words = counters.ptr();
+    values.clear_resize(_bitsNumber);
+    values.zerofill();
+    for (int plane = 0; plane < planes; ++plane)
+    {
+        for (int i = 0; i < _length; ++i)
+        {
+            qword word = plane_words[plane * _length + i];
+            while (word != 0)
+            {
+                values[(i << ADDRESS_BITS_PER_WORD) + _leastSignificantBitPosition(word)] += (1 << plane);
+                word &= word - 1;
+            }
+        }
+    }
+}
+
 int BingoPgExternalBitset::bitsNumber() const
 {
     int bits_num = 0;
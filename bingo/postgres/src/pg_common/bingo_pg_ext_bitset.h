@@ -107,6 +107,14 @@ public:
     int bitsNumber() const;
     bool hasBits() const;
 
+    // bit-sliced counters for every bit of this BitSet: plane j of the counters
+    // keeps the j-th bits of all the counters. Prepares zero counters for the values up to max_value
+    void initCounters(indigo::Array<qword>& counters, int max_value) const;
+    // increments the counters of all the bits set in this BitSet
+    void addToCounters(indigo::Array<qword>& counters) const;
+    // reads the values of all the counters
+    void getCounters(const indigo::Array<qword>& counters, indigo::Array<int>& values) const;
+
     qword shiftOne(int shiftNumber);
 
 private:
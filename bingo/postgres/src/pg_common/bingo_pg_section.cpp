@@ -42,6 +42,14 @@ BingoPgSection::BingoPgSection(BingoPgIndex& bingo_idx, int idx_strategy, int of
         _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
         _sectionInfo.n_blocks_for_map = bingo_idx.getMapSize();
         _sectionInfo.n_blocks_for_fp = bingo_idx.getFpSize();
+        /*
+         * Fingerprint bits usage is kept in the meta info block if there is enough space
+         */
+        if (sizeof(_sectionInfo) + _sectionInfo.n_blocks_for_fp * sizeof(unsigned short) <= BingoPgBufferCacheBin::MAX_SIZE)
+        {
+            _bitsUsage.resize(_sectionInfo.n_blocks_for_fp);
+            _bitsUsage.zerofill();
+        }
         /*
          * Initialize existing structures fingerprint
          */
@@ -67,6 +75,12 @@ BingoPgSection::BingoPgSection(BingoPgIndex& bingo_idx, int idx_strategy, int of
         int data_len;
         BingoSectionInfoData* data = (BingoSectionInfoData*)_sectionInfoBuffer.getIndexData(data_len);
         _sectionInfo = *data;
+        /*
+         * Read fingerprint bits usage. The sections of the old indexes have no usage counters
+         */
+        int usage_size = _sectionInfo.n_blocks_for_fp * sizeof(unsigned short);
+        if (data_len >= (int)sizeof(_sectionInfo) + usage_size)
+            _bitsUsage.copy((unsigned short*)(data + 1), _sectionInfo.n_blocks_for_fp);
         _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
 
         _existStructures = std::make_unique<BingoPgBufferCacheFp>(offset + 1, _index, false);
@@ -131,8 +145,12 @@ BingoPgSection::~BingoPgSection()
     _sectionInfo.section_size = getPagesCount();
     if (_idxStrategy == BingoPgIndex::BUILDING_STRATEGY)
     {
+        indigo::Array<char> info_buf;
+        info_buf.copy((char*)&_sectionInfo, sizeof(_sectionInfo));
+        info_buf.concat((char*)_bitsUsage.ptr(), _bitsUsage.sizeInBytes());
+
         _sectionInfoBuffer.changeAccess(BINGO_PG_WRITE);
-        _sectionInfoBuffer.formIndexTuple(&_sectionInfo, sizeof(_sectionInfo));
+        _sectionInfoBuffer.formIndexTuple(info_buf.ptr(), info_buf.sizeInBytes());
         _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
     }
     else if (_idxStrategy == BingoPgIndex::UPDATING_STRATEGY)
@@ -141,6 +159,8 @@ BingoPgSection::~BingoPgSection()
         int data_len;
         BingoSectionInfoData* data = (BingoSectionInfoData*)_sectionInfoBuffer.getIndexData(data_len);
         *data = _sectionInfo;
+        if (_bitsUsage.size() > 0)
+            memcpy(data + 1, _bitsUsage.ptr(), _bitsUsage.sizeInBytes());
         _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
     }
 }
@@ -163,6 +183,7 @@ void BingoPgSection::clear()
     _offsetBin.clear();
     _offsetFp.clear();
     _offsetMap.clear();
+    _bitsUsage.clear();
 }
 
 bool BingoPgSection::isExtended()
@@ -182,6 +203,8 @@ void BingoPgSection::addStructure(BingoPgFpData& item_data)
         int bit_idx = item_data.getBit(idx);
         BingoPgBufferCacheFp& buffer_fp = getFpBufferCache(bit_idx);
         buffer_fp.setBit(current_str, true);
+        if (_bitsUsage.size() > 0 && _bitsUsage[bit_idx] < 65535)
+            ++_bitsUsage[bit_idx];
     }
 
     int map_buf_idx = current_str / BINGO_MOLS_PER_MAPBLOCK;
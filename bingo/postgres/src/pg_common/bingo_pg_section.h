@@ -17,7 +17,7 @@ class BingoPgExternalBitset;
 /*
  * Class for handling bingo postgres section
  * Section consists of:
- *    section meta info (1 block) |
+ *    section meta info and fingerprint bits usage (1 block) |
  *    section removed bitset (1 block) |
  *    bits count buffers (16 blocks) |
  *    map buffers (64k / 500) |
@@ -65,6 +65,14 @@ public:
     BingoPgBufferCacheBin& getBinBufferCache(int bin_idx);
 
     void readSectionBitsCount(indigo::Array<int>& bits_count);
+    /*
+     * Number of structures with each fingerprint bit set. Counters are not decreased on removal.
+     * Empty for the sections built without counters
+     */
+    const indigo::Array<unsigned short>& getBitsUsage() const
+    {
+        return _bitsUsage;
+    }
 
     const BingoSectionInfoData& getSectionInfo() const
     {
@@ -100,6 +108,7 @@ private:
     indigo::Array<int> _offsetBin;
 
     indigo::ObjArray<BingoPgBuffer> _bitsCountBuffers;
+    indigo::Array<unsigned short> _bitsUsage;
 };
 
 #endif /* BINGO_PG_SECTION1_H */
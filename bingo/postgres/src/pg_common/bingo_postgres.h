@@ -16,6 +16,7 @@
 #define BINGO_MOLS_PER_FINGERBLOCK 64000 /* 64000 bits < 8KB */
 #define BINGO_MOLS_PER_SECTION 64000
 #define BINGO_TUPLE_OFFSET 1 /*INDEX tuple offset is always 1*/
+#define BINGO_SUB_SCREENING_PASS_MARK 128 /* structures count to stop screening and match */
 
 #define BINGO_PG_NOLOCK 0
 #define BINGO_PG_READ 1
@@ -511,6 +511,12 @@ void BingoPgIndex::getSectionBitsCount(int section_idx, indigo::Array<int>& bits
     current_section.readSectionBitsCount(bits_count);
 }
 
+const indigo::Array<unsigned short>& BingoPgIndex::getSectionBitsUsage(int section_idx)
+{
+    BingoPgSection& current_section = _jumpToSection(section_idx);
+    return current_section.getBitsUsage();
+}
+
 void BingoPgIndex::removeStructure(int section_idx, int mol_idx)
 {
     BingoPgSection& current_section = _jumpToSection(section_idx);
@@ -128,6 +128,7 @@ public:
 
     void getSectionBitset(int section_idx, BingoPgExternalBitset& section_bitset);
     void getSectionBitsCount(int section_idx, indigo::Array<int>& bits_count);
+    const indigo::Array<unsigned short>& getSectionBitsUsage(int section_idx);
 
     void removeStructure(int section_idx, int mol_idx);
     bool isStructureRemoved(int section_idx, int mol_idx);
@@ -68,6 +68,18 @@ bool BingoPgSearch::next(PG_OBJECT scan_desc_ptr, PG_OBJECT result_ptr)
     return _fpEngine->searchNext(result_ptr);
 }
 
+long long BingoPgSearch::searchBitmap(PG_OBJECT scan_desc_ptr, PG_OBJECT tbm_ptr)
+{
+    _indexScanDesc = scan_desc_ptr;
+
+    if (_initSearch)
+    {
+        _initScanSearch();
+    }
+
+    return _fpEngine->searchBitmap(tbm_ptr);
+}
+
 void BingoPgSearch::prepareRescan(PG_OBJECT scan_desc_ptr)
 {
     _indexScanDesc = scan_desc_ptr;
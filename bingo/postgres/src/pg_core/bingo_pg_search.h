@@ -29,6 +29,17 @@ public:
      * Sets up item pointer
      */
     bool next(PG_OBJECT scan_desc_ptr, PG_OBJECT result_item);
+    /*
+     * Adds all the matches to the TID bitmap. Returns the number of added items
+     */
+    long long searchBitmap(PG_OBJECT scan_desc_ptr, PG_OBJECT tbm_ptr);
+    /*
+     * Distance of the last match for the ordered scans
+     */
+    float getDistance() const
+    {
+        return _fpEngine.get() != nullptr ? _fpEngine->getDistance() : 0;
+    }
 
     void setItemPointer(PG_OBJECT result_ptr);
     void readCmfItem(indigo::Array<char>& cmf_buf);
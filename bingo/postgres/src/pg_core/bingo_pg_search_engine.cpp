@@ -4,7 +4,10 @@ extern "C"
 {
 #include "postgres.h"
 #include "access/itup.h"
+#include "access/relscan.h"
 #include "fmgr.h"
+#include "nodes/tidbitmap.h"
+#include "port/atomics.h"
 #include "storage/bufmgr.h"
 }
 
@@ -24,8 +27,18 @@ extern "C"
 #include "bingo_pg_index.h"
 #include "bingo_pg_text.h"
 
+#include <algorithm>
+
 using namespace indigo;
 
+/*
+ * Shared state of a parallel scan
+ */
+typedef struct BingoPgParallelScanData
+{
+    pg_atomic_uint32 next_section;
+} BingoPgParallelScanData;
+
 void BingoPgFpData::setTidItem(PG_OBJECT item_ptr)
 {
 
@@ -57,7 +70,7 @@ void BingoPgFpData::setXyz(const char* xyz_buf, int xyz_len)
 }
 
 BingoPgSearchEngine::BingoPgSearchEngine()
-    : _fetchFound(false), _currentSection(-1), _currentIdx(-1), _blockBegin(0), _blockEnd(0), _bufferIndexPtr(0), _sectionBitset(BINGO_MOLS_PER_SECTION)
+    : _fetchFound(false), _currentSection(-1), _currentIdx(-1), _blockBegin(0), _blockEnd(0), _bufferIndexPtr(0), _parallelScan(0), _sectionBitset(BINGO_MOLS_PER_SECTION)
 {
     _bingoSession = bingoAllocateSessionID();
 }
@@ -94,9 +107,31 @@ bool BingoPgSearchEngine::matchTarget(ItemPointerData& item_data)
     return matchTarget(ItemPointerGetBlockNumber(&item_data), ItemPointerGetOffsetNumber(&item_data));
 }
 
-void BingoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT)
+int BingoPgSearchEngine::getParallelScanSize()
+{
+    return sizeof(BingoPgParallelScanData);
+}
+
+void BingoPgSearchEngine::initParallelScan(PG_OBJECT target)
+{
+    BingoPgParallelScanData* parallel_scan = (BingoPgParallelScanData*)target;
+    pg_atomic_init_u32(&parallel_scan->next_section, 0);
+}
+
+PG_OBJECT BingoPgSearchEngine::getParallelScan(PG_OBJECT scan_desc)
+{
+#if PG_VERSION_NUM / 100 >= 1000
+    IndexScanDesc scan = (IndexScanDesc)scan_desc;
+    if (scan->parallel_scan != NULL)
+        return OffsetToPointer((void*)scan->parallel_scan, scan->parallel_scan->ps_offset);
+#endif
+    return 0;
+}
+
+void BingoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT scan_desc)
 {
     _bufferIndexPtr = &bingo_idx;
+    _parallelScan = getParallelScan(scan_desc);
     _currentSection = -1;
     _currentIdx = -1;
     _fetchFound = false;
@@ -108,6 +143,18 @@ bool BingoPgSearchEngine::_searchNextCursor(PG_OBJECT result_ptr)
 {
     profTimerStart(t0, "bingo_pg.search_cursor");
     ItemPointerData cmf_item;
+    /*
+     * The cursor is not split between the workers: the first worker to claim
+     * a section returns all the results
+     */
+    if (_currentSection < 0)
+    {
+        _currentSection = _nextSection(_currentSection);
+        if (_currentSection != _blockBegin)
+            _searchCursor.reset(nullptr);
+    }
+    if (_searchCursor.get() == nullptr)
+        return false;
     /*
      * Iterate through the cursor
      */
@@ -140,8 +187,6 @@ bool BingoPgSearchEngine::_searchNextSub(PG_OBJECT result_ptr)
 {
 
     profTimerStart(t0, "bingo_pg.search_sub");
-    BingoPgFpData& query_data = *_queryFpData;
-    BingoPgIndex& bingo_index = *_bufferIndexPtr;
     /*
      * If there are matches found on the previous steps
      */
@@ -155,40 +200,20 @@ bool BingoPgSearchEngine::_searchNextSub(PG_OBJECT result_ptr)
         else
         {
             _fetchFound = false;
-            ++_currentSection;
+            _currentSection = _nextSection(_currentSection);
         }
     }
     profTimerStart(t1, "bingo_pg.search_fp");
 
     if (_currentSection < 0)
-        _currentSection = _blockBegin;
+        _currentSection = _nextSection(_currentSection);
     /*
      * Iterate through the sections bingo_index.readEnd()
      */
-    for (; _currentSection < _blockEnd; ++_currentSection)
+    for (; _currentSection < _blockEnd; _currentSection = _nextSection(_currentSection))
     {
-        /*
-         * Get section existing structures
-         */
-        bingo_index.getSectionBitset(_currentSection, _sectionBitset);
         _currentIdx = -1;
-        /*
-         * If there is no fingerprints then check every molecule
-         */
-        if (query_data.bitEnd() != 0)
-        {
-            /*
-             * Iterate through the query bits
-             */
-            for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd() && _sectionBitset.hasBits(); fp_idx = query_data.bitNext(fp_idx))
-            {
-                int fp_block = query_data.getBit(fp_idx);
-                /*
-                 * Get fingerprint buffer in the current section
-                 */
-                bingo_index.andWithBitset(_currentSection, fp_block, _sectionBitset);
-            }
-        }
+        _screenSection();
         /*
          * If bitset is not null then matches are found
          */
@@ -216,6 +241,108 @@ bool BingoPgSearchEngine::_searchNextSub(PG_OBJECT result_ptr)
     return false;
 }
 
+/*
+ * Screens the current section by the query fingerprint. Passed structures are left in the section bitset
+ */
+void BingoPgSearchEngine::_screenSection()
+{
+    BingoPgFpData& query_data = *_queryFpData;
+    BingoPgIndex& bingo_index = *_bufferIndexPtr;
+    QS_DEF(Array<int>, query_bits);
+    /*
+     * Get section existing structures
+     */
+    bingo_index.getSectionBitset(_currentSection, _sectionBitset);
+    /*
+     * If there is no fingerprints then check every molecule
+     */
+    if (query_data.bitEnd() == 0)
+        return;
+
+    query_bits.clear();
+    for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd(); fp_idx = query_data.bitNext(fp_idx))
+        query_bits.push(query_data.getBit(fp_idx));
+    /*
+     * Screen the rarest bits of the section first. The usage counters only order the bits and
+     * never drop structures by themselves: a section can be updated by a version without counters,
+     * so a zero counter does not prove that the bit is unused. A really unused bit clears the
+     * bitset with a single fingerprint block read anyway
+     */
+    const Array<unsigned short>& bits_usage = bingo_index.getSectionBitsUsage(_currentSection);
+    if (bits_usage.size() > 0)
+    {
+        auto usage = [&bits_usage](int bit) { return (bit < bits_usage.size()) ? bits_usage[bit] : 65535; };
+        std::sort(query_bits.ptr(), query_bits.ptr() + query_bits.size(), [&usage](int a, int b) {
+            return usage(a) < usage(b) || (usage(a) == usage(b) && a < b);
+        });
+    }
+    /*
+     * Iterate through the query bits until it is cheaper to match the passed structures
+     */
+    for (int i = 0; i < query_bits.size(); ++i)
+    {
+        if (_sectionBitset.bitsNumber() <= BINGO_SUB_SCREENING_PASS_MARK)
+            break;
+        /*
+         * Get fingerprint buffer in the current section
+         */
+        bingo_index.andWithBitset(_currentSection, query_bits[i], _sectionBitset);
+    }
+}
+
+long long BingoPgSearchEngine::searchBitmap(PG_OBJECT tbm_ptr)
+{
+    /*
+     * Fetch the verified structures one by one
+     */
+    QS_DEF(Array<ItemPointerData>, found_items);
+    found_items.clear();
+
+    while (searchNext(&found_items.push()))
+        ;
+    found_items.pop();
+
+    _addToBitmap(tbm_ptr, found_items, false);
+    return found_items.size();
+}
+
+/*
+ * Adds all the structures passed the screening to the bitmap. The structures are not verified,
+ * so they should be rechecked if the screening is not exact
+ */
+long long BingoPgSearchEngine::_searchBitmapSections(PG_OBJECT tbm_ptr, bool recheck)
+{
+    profTimerStart(t0, "bingo_pg.search_bitmap");
+    QS_DEF(Array<ItemPointerData>, section_items);
+    long long result = 0;
+
+    for (_currentSection = _nextSection(-1); _currentSection < _blockEnd; _currentSection = _nextSection(_currentSection))
+    {
+        _screenSection();
+
+        section_items.clear();
+        for (int str_idx = _sectionBitset.begin(); str_idx != _sectionBitset.end(); str_idx = _sectionBitset.next(str_idx))
+        {
+            _bufferIndexPtr->readTidItem(_currentSection, str_idx, &section_items.push());
+        }
+        _addToBitmap(tbm_ptr, section_items, recheck);
+        result += section_items.size();
+    }
+    return result;
+}
+
+void BingoPgSearchEngine::_addToBitmap(PG_OBJECT tbm_ptr, Array<ItemPointerData>& items, bool recheck)
+{
+    if (items.size() == 0)
+        return;
+
+    BINGO_PG_TRY
+    {
+        tbm_add_tuples((TIDBitmap*)tbm_ptr, items.ptr(), items.size(), recheck);
+    }
+    BINGO_PG_HANDLE(throw BingoPgError("internal error: can not add bitmap solution: %s", message));
+}
+
 using namespace indigo;
 
 void BingoPgSearchEngine::_setBingoContext()
@@ -246,6 +373,18 @@ bool BingoPgSearchEngine::_fetchForNext()
     return false;
 }
 
+/*
+ * Returns the section to search after the given one, or the first section for -1
+ */
+int BingoPgSearchEngine::_nextSection(int section_idx)
+{
+    if (_parallelScan == 0)
+        return (section_idx < 0) ? _blockBegin : section_idx + 1;
+
+    BingoPgParallelScanData* parallel_scan = (BingoPgParallelScanData*)_parallelScan;
+    return _blockBegin + (int)pg_atomic_fetch_add_u32(&parallel_scan->next_section, 1);
+}
+
 void BingoPgSearchEngine::_getBlockParameters(Array<char>& params)
 {
     QS_DEF(Array<char>, block_params);
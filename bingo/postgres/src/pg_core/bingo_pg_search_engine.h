@@ -138,20 +138,44 @@ public:
     {
         return false;
     }
+    /*
+     * Adds all the found structures to the TID bitmap. Returns the number of structures added
+     */
+    virtual long long searchBitmap(PG_OBJECT tbm_ptr);
+    /*
+     * Distance of the last found structure for the ordered scans
+     */
+    virtual float getDistance() const
+    {
+        return 0;
+    }
 
     void setItemPointer(PG_OBJECT result_ptr);
 
     void loadDictionary(BingoPgIndex&);
     //   const char* getDictionary(int& size);
 
+    /*
+     * Parallel scans share a cursor of the next section to search. Each
+     * section is claimed by one worker only
+     */
+    static int getParallelScanSize();
+    static void initParallelScan(PG_OBJECT target);
+    static PG_OBJECT getParallelScan(PG_OBJECT scan_desc);
+
 private:
     BingoPgSearchEngine(const BingoPgSearchEngine&); // no implicit copy
 protected:
     bool _searchNextCursor(PG_OBJECT result_ptr);
     bool _searchNextSub(PG_OBJECT result_ptr);
+    long long _searchBitmapSections(PG_OBJECT tbm_ptr, bool recheck);
+    void _addToBitmap(PG_OBJECT tbm_ptr, indigo::Array<ItemPointerData>& items, bool recheck);
+
+    virtual void _screenSection();
 
     void _setBingoContext();
     bool _fetchForNext();
+    int _nextSection(int section_idx);
 
     void _getBlockParameters(indigo::Array<char>& params);
 
@@ -165,6 +189,7 @@ protected:
     int _blockEnd;
 
     BingoPgIndex* _bufferIndexPtr;
+    PG_OBJECT _parallelScan;
 
     BingoPgExternalBitset _sectionBitset;
     std::unique_ptr<BingoPgFpData> _queryFpData;
@@ -26,6 +26,8 @@ extern "C"
 #include "bingo_pg_index.h"
 #include "bingo_pg_text.h"
 
+#include <algorithm>
+
 using namespace indigo;
 
 void MangoPgFpData::insertHash(dword hash, int c_cnt)
@@ -51,7 +53,7 @@ void MangoPgFpData::setGrossStr(const char* gross_str, const char* counter_str)
 
 IMPL_ERROR(MangoPgSearchEngine, "molecule search engine");
 
-MangoPgSearchEngine::MangoPgSearchEngine(BingoPgConfig& bingo_config, const char* rel_name) : BingoPgSearchEngine(), _searchType(-1)
+MangoPgSearchEngine::MangoPgSearchEngine(BingoPgConfig& bingo_config, const char* rel_name) : BingoPgSearchEngine(), _searchType(-1), _simDistance(0)
 {
     _setBingoContext();
     /*
@@ -137,6 +139,17 @@ void MangoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT
 
     IndexScanDesc scan_desc = (IndexScanDesc)scan_desc_ptr;
 
+#if PG_VERSION_NUM / 100 >= 906
+    /*
+     * Ordered scans return all the structures, and the conditions are checked by the executor.
+     * The cost estimate charges the recheck for every structure
+     */
+    if (scan_desc->numberOfOrderBys > 0)
+    {
+        _searchType = BingoPgCommon::MOL_SIM_DIST;
+    }
+    else
+#endif
     if (scan_desc->numberOfKeys >= 1 && scan_desc->numberOfKeys <= 2)
     {
         _searchType = scan_desc->keyData[0].sk_strategy;
@@ -177,6 +190,9 @@ void MangoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT
     case BingoPgCommon::MOL_SIM:
         _prepareSimSearch(scan_desc);
         break;
+    case BingoPgCommon::MOL_SIM_DIST:
+        _prepareDistanceSearch(scan_desc);
+        break;
     default:
         throw Error("unsupported search type %d", _searchType);
         break;
@@ -192,18 +208,33 @@ bool MangoPgSearchEngine::searchNext(PG_OBJECT result_ptr)
     {
         result = _searchNextCursor(result_ptr);
     }
-    else if (_searchType == BingoPgCommon::MOL_SUB || _searchType == BingoPgCommon::MOL_SMARTS)
+    else if (_searchType == BingoPgCommon::MOL_SUB || _searchType == BingoPgCommon::MOL_SMARTS || _searchType == BingoPgCommon::MOL_SIM)
     {
         result = _searchNextSub(result_ptr);
     }
-    else if (_searchType == BingoPgCommon::MOL_SIM)
+    else if (_searchType == BingoPgCommon::MOL_SIM_DIST)
     {
-        result = _searchNextSim(result_ptr);
+        result = _searchNextDistance(result_ptr);
     }
 
     return result;
 }
 
+long long MangoPgSearchEngine::searchBitmap(PG_OBJECT tbm_ptr)
+{
+    _setBingoContext();
+    /*
+     * Substructure candidates are verified by the recheck of the heap tuples,
+     * and the similarity screening is exact
+     */
+    if (_searchType == BingoPgCommon::MOL_SUB || _searchType == BingoPgCommon::MOL_SMARTS)
+        return _searchBitmapSections(tbm_ptr, true);
+    else if (_searchType == BingoPgCommon::MOL_SIM)
+        return _searchBitmapSections(tbm_ptr, false);
+
+    return BingoPgSearchEngine::searchBitmap(tbm_ptr);
+}
+
 void MangoPgSearchEngine::_errorHandler(const char* message, void*)
 {
     throw Error("Error while searching a molecule: %s", message);
@@ -540,6 +571,43 @@ void MangoPgSearchEngine::_prepareSimSearch(PG_OBJECT scan_desc_ptr)
     data.setFingerPrints(fingerprint_buf, size_bits);
 }
 
+void MangoPgSearchEngine::_prepareDistanceSearch(PG_OBJECT scan_desc_ptr)
+{
+    IndexScanDesc scan_desc = (IndexScanDesc)scan_desc_ptr;
+    QS_DEF(Array<char>, search_type);
+    int bingo_res;
+    BingoPgFpData& data = *_queryFpData;
+
+    BingoPgCommon::getSearchTypeString(BingoPgCommon::MOL_SIM, search_type, true);
+
+    if (scan_desc->numberOfOrderBys != 1)
+        throw BingoPgError("molecule search engine: unsupported order by number '%d'", scan_desc->numberOfOrderBys);
+
+    ScanKey order_key = &scan_desc->orderByData[0];
+    if (order_key->sk_flags & SK_ISNULL)
+        throw BingoPgError("molecule search engine: query can not be null");
+
+    BingoPgText query_text;
+    query_text.init(order_key->sk_argument);
+    /*
+     * Distance is measured by the Tanimoto similarity of the fingerprints
+     */
+    bingo_res = mangoSetupMatch(search_type.ptr(), query_text.getString(), "tanimoto");
+    CORE_HANDLE_ERROR(bingo_res, 1, "molecule search engine: can not set sim search context", bingoGetError());
+
+    const char* fingerprint_buf;
+    int fp_len;
+
+    bingo_res = mangoGetQueryFingerprint(&fingerprint_buf, &fp_len);
+    CORE_HANDLE_ERROR(bingo_res, 1, "molecule search engine: can not get query fingerprint", bingoGetError());
+
+    data.setFingerPrints(fingerprint_buf, fp_len * 8);
+
+    _simSections = std::priority_queue<_SimItem>();
+    _simStructures = std::priority_queue<_SimItem>();
+    _simDistance = 0;
+}
+
 void MangoPgSearchEngine::_getScanQueries(uintptr_t arg_datum, Array<char>& str1_out, Array<char>& str2_out)
 {
     /*
@@ -643,168 +711,218 @@ void MangoPgSearchEngine::_getScanQueries(uintptr_t arg_datum, float& min_bound,
     BINGO_PG_HANDLE(throw Error("internal error: can not get scan query: %s", message));
 }
 
-bool MangoPgSearchEngine::_searchNextSim(PG_OBJECT result_ptr)
+void MangoPgSearchEngine::_screenSection()
 {
+    if (_searchType == BingoPgCommon::MOL_SIM)
+        _screenSimSection();
+    else
+        BingoPgSearchEngine::_screenSection();
+}
 
+/*
+ * Screens the current section by the similarity bounds. The screening is exact for the similarity search
+ */
+void MangoPgSearchEngine::_screenSimSection()
+{
     profTimerStart(t0, "mango_pg.search_sim");
-    /*
-     * If there are mathces found on the previous steps
-     */
-    if (_fetchFound)
-    {
-        if (_fetchForNext())
-        {
-            setItemPointer(result_ptr);
-            return true;
-        }
-        else
-        {
-            _fetchFound = false;
-            ++_currentSection;
-        }
-    }
 
     BingoPgFpData& query_data = *_queryFpData;
     BingoPgIndex& bingo_index = *_bufferIndexPtr;
     QS_DEF(Array<int>, bits_count);
-    QS_DEF(Array<int>, common_ones);
+    QS_DEF(Array<qword>, common_ones);
     BingoPgExternalBitset screening_bitset(BINGO_MOLS_PER_SECTION);
 
     int *min_bounds, *max_bounds, bingo_res;
+
     /*
-     * Read first section
+     * Get section existing structures
      */
-    if (_currentSection < 0)
-        _currentSection = _blockBegin;
+    bingo_index.getSectionBitset(_currentSection, _sectionBitset);
+    int possible_str_count = _sectionBitset.bitsNumber();
     /*
-     * Iterate through the sections
+     * If there is no bits then screen whole the structures
      */
-    for (; _currentSection < _blockEnd; ++_currentSection)
+    if (query_data.bitEnd() != 0 && possible_str_count > 0)
     {
-        _currentIdx = -1;
         /*
-         * Get section existing structures
+         * Read structures bits count
          */
-        bingo_index.getSectionBitset(_currentSection, _sectionBitset);
-        int possible_str_count = _sectionBitset.bitsNumber();
+        //         profTimerStart(t5, "mango_pg.get_section_bits");
+        bingo_index.getSectionBitsCount(_currentSection, bits_count);
+        //         profTimerStop(t5);
         /*
-         * If there is no bits then screen whole the structures
+         * Prepare min max bounds
          */
-        if (query_data.bitEnd() != 0 && possible_str_count > 0)
-        {
-            /*
-             * Read structures bits count
-             */
-            //         profTimerStart(t5, "mango_pg.get_section_bits");
-            bingo_index.getSectionBitsCount(_currentSection, bits_count);
-            //         profTimerStop(t5);
-            /*
-             * Prepare min max bounds
-             */
-            //         profTimerStart(t3, "mango_pg.get_min_max");
-            bingo_res = mangoSimilarityGetBitMinMaxBoundsArray(bits_count.size(), bits_count.ptr(), &min_bounds, &max_bounds);
-            //         profTimerStop(t3);
+        //         profTimerStart(t3, "mango_pg.get_min_max");
+        bingo_res = mangoSimilarityGetBitMinMaxBoundsArray(bits_count.size(), bits_count.ptr(), &min_bounds, &max_bounds);
+        //         profTimerStop(t3);
 
-            CORE_HANDLE_ERROR(bingo_res, 1, "molecule search engine: error while getting similarity bounds array", bingoGetError());
+        CORE_HANDLE_ERROR(bingo_res, 1, "molecule search engine: error while getting similarity bounds array", bingoGetError());
 
+        /*
+         * Common ones are kept in bit-sliced counters, so each query bit is added to all the
+         * structures of the section with a few word operations
+         */
+        int fp_count = query_data.bitEnd();
+        screening_bitset.initCounters(common_ones, fp_count);
+        /*
+         * Iterate through the query bits
+         */
+        int iteration_idx = 0;
+        for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd() && possible_str_count > 0; fp_idx = query_data.bitNext(fp_idx))
+        {
+            int fp_block = query_data.getBit(fp_idx);
             /*
-             * Prepare common bits array
+             * Copy passed structures on each iteration step
              */
-            common_ones.resize(bits_count.size());
-            common_ones.zerofill();
+            screening_bitset.copy(_sectionBitset);
             /*
-             * Iterate through the query bits
+             * Get commons in fingerprint buffer
              */
-            int iteration_idx = 0;
-            int fp_count = query_data.bitEnd();
-            for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd() && possible_str_count > 0; fp_idx = query_data.bitNext(fp_idx))
-            {
-                int fp_block = query_data.getBit(fp_idx);
-                /*
-                 * Copy passed structures on each iteration step
-                 */
-                //            profTimerStart(t7, "mango_pg.copy");
-                screening_bitset.copy(_sectionBitset);
-                //            profTimerStop(t7);
-
-                /*
-                 * Get commons in fingerprint buffer
-                 */
-
-                //            profTimerStart(t2, "mango_pg.andwith");
-                bingo_index.andWithBitset(_currentSection, fp_block, screening_bitset);
-                //            profTimerStop(t2);
-
-                //            profTimerStart(t4, "mango_pg.new_common_ones");
-                int screen_idx = screening_bitset.begin();
-                for (; screen_idx != screening_bitset.end() && possible_str_count > 0; screen_idx = screening_bitset.next(screen_idx))
-                {
-                    /*
-                     * Calculate new common ones
-                     */
-                    int& one_counter = common_ones[screen_idx];
-                    ++one_counter;
-                    /*
-                     * If common ones is out of bounds then it is not passed the screening
-                     */
-                    if ((one_counter > max_bounds[screen_idx]) || ((one_counter + fp_count - iteration_idx) < min_bounds[screen_idx]))
-                    {
-                        _sectionBitset.set(screen_idx, false);
-                        --possible_str_count;
-                    }
-                }
-                //            profTimerStop(t4);
-                ++iteration_idx;
-            }
-
+            bingo_index.andWithBitset(_currentSection, fp_block, screening_bitset);
+            screening_bitset.addToCounters(common_ones);
+            ++iteration_idx;
             /*
-             * Screen the last time for all the possible structures
+             * Drop the structures out of bounds from time to time
              */
-            //         profTimerStart(t6, "mango_pg.lst_screen");
-            int screen_idx = _sectionBitset.begin();
-            for (; screen_idx != _sectionBitset.end() && possible_str_count > 0; screen_idx = _sectionBitset.next(screen_idx))
-            {
-                int& one_counter = common_ones[screen_idx];
-                if ((one_counter > max_bounds[screen_idx]) || (one_counter < min_bounds[screen_idx]))
-                {
-                    /*
-                     * Not passed screening
-                     */
-                    _sectionBitset.set(screen_idx, false);
-                    --possible_str_count;
-                }
-            }
-            //         profTimerStop(t6);
+            if (iteration_idx % SIM_SCREENING_CHECK_STEP == 0 && iteration_idx < fp_count)
+                possible_str_count = _screenSimBounds(common_ones, min_bounds, max_bounds, fp_count - iteration_idx);
         }
-        /*
-         * Return false on empty fingerprint
-         */
-        if (query_data.bitEnd() == 0)
-            return false;
 
         /*
-         * If bitset is not null then matches are found
+         * Screen the last time for all the possible structures
          */
-        if (_sectionBitset.hasBits())
-        {
-            /*
-             * Set first match as an answer
-             */
-            if (_fetchForNext())
-            {
-                profTimerStop(t0);
-                setItemPointer(result_ptr);
-                /*
-                 * Set fetch found to return on the next steps
-                 */
-                _fetchFound = true;
-                return true;
-            }
-        }
+        if (possible_str_count > 0)
+            _screenSimBounds(common_ones, min_bounds, max_bounds, 0);
+    }
+}
+
+/*
+ * Removes the structures with common ones out of the bounds from the section bitset.
+ * rest_bits is the number of query bits not counted yet. Returns the number of the passed structures
+ */
+int MangoPgSearchEngine::_screenSimBounds(const Array<qword>& common_ones, const int* min_bounds, const int* max_bounds, int rest_bits)
+{
+    QS_DEF(Array<int>, ones_count);
+    ones_count.clear();
+    _sectionBitset.getCounters(common_ones, ones_count);
+
+    int passed_count = 0;
+    for (int screen_idx = _sectionBitset.begin(); screen_idx != _sectionBitset.end(); screen_idx = _sectionBitset.next(screen_idx))
+    {
+        int one_counter = ones_count[screen_idx];
+        if ((one_counter > max_bounds[screen_idx]) || ((one_counter + rest_bits) < min_bounds[screen_idx]))
+            _sectionBitset.set(screen_idx, false);
+        else
+            ++passed_count;
     }
+    return passed_count;
+}
 
+/*
+ * Tanimoto similarity by the number of ones
+ */
+float MangoPgSearchEngine::_getTanimoto(int query_ones, int target_ones, int common_ones)
+{
+    int denominator = query_ones + target_ones - common_ones;
+    if (denominator == 0)
+        return 0;
+    return (float)common_ones / denominator;
+}
+
+/*
+ * Best-first search: sections are read in the order of their similarity upper bounds, and a structure
+ * is returned as soon as no unread section can contain a more similar one. Sections with lower bounds
+ * are not read at all if the scan stops early, e.g. by LIMIT
+ */
+bool MangoPgSearchEngine::_searchNextDistance(PG_OBJECT result_ptr)
+{
+    profTimerStart(t0, "mango_pg.search_distance");
     /*
-     * No matches or section ends
+     * Collect the sections with their bounds. A parallel worker takes only the sections it claims
      */
-    return false;
-}
\ No newline at end of file
+    if (_currentSection < 0)
+    {
+        for (int section_idx = _nextSection(-1); section_idx < _blockEnd; section_idx = _nextSection(section_idx))
+        {
+            float sim_bound = _getSimSectionBound(section_idx);
+            if (sim_bound >= 0)
+                _simSections.push({sim_bound, section_idx, -1});
+        }
+        _currentSection = _blockEnd;
+    }
+
+    while (true)
+    {
+        if (!_simStructures.empty() && (_simSections.empty() || _simStructures.top().sim >= _simSections.top().sim))
+        {
+            const _SimItem& item = _simStructures.top();
+            _simDistance = 1 - item.sim;
+            _bufferIndexPtr->readTidItem(item.section_idx, item.structure_idx, result_ptr);
+            _simStructures.pop();
+            return true;
+        }
+        if (_simSections.empty())
+            return false;
+
+        int section_idx = _simSections.top().section_idx;
+        _simSections.pop();
+        _readSimSection(section_idx);
+    }
+}
+
+/*
+ * Returns the upper bound of the similarity for the structures of the section, or -1 if the section is empty
+ */
+float MangoPgSearchEngine::_getSimSectionBound(int section_idx)
+{
+    BingoPgIndex& bingo_index = *_bufferIndexPtr;
+    QS_DEF(Array<int>, bits_count);
+    bits_count.clear();
+
+    bingo_index.getSectionBitset(section_idx, _sectionBitset);
+    bingo_index.getSectionBitsCount(section_idx, bits_count);
+
+    int query_ones = _queryFpData->bitEnd();
+    float result = -1;
+    for (int str_idx = _sectionBitset.begin(); str_idx != _sectionBitset.end(); str_idx = _sectionBitset.next(str_idx))
+    {
+        int target_ones = bits_count[str_idx];
+        result = std::max(result, _getTanimoto(query_ones, target_ones, std::min(query_ones, target_ones)));
+    }
+    return result;
+}
+
+/*
+ * Calculates the similarity for all the structures of the section
+ */
+void MangoPgSearchEngine::_readSimSection(int section_idx)
+{
+    profTimerStart(t0, "mango_pg.read_sim_section");
+
+    BingoPgFpData& query_data = *_queryFpData;
+    BingoPgIndex& bingo_index = *_bufferIndexPtr;
+    QS_DEF(Array<int>, bits_count);
+    QS_DEF(Array<qword>, common_ones);
+    QS_DEF(Array<int>, ones_count);
+    BingoPgExternalBitset screening_bitset(BINGO_MOLS_PER_SECTION);
+    bits_count.clear();
+    ones_count.clear();
+
+    _currentSection = section_idx;
+    bingo_index.getSectionBitset(section_idx, _sectionBitset);
+    bingo_index.getSectionBitsCount(section_idx, bits_count);
+
+    int query_ones = query_data.bitEnd();
+    screening_bitset.initCounters(common_ones, query_ones);
+    for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd(); fp_idx = query_data.bitNext(fp_idx))
+    {
+        screening_bitset.copy(_sectionBitset);
+        bingo_index.andWithBitset(section_idx, query_data.getBit(fp_idx), screening_bitset);
+        screening_bitset.addToCounters(common_ones);
+    }
+    _sectionBitset.getCounters(common_ones, ones_count);
+
+    for (int str_idx = _sectionBitset.begin(); str_idx != _sectionBitset.end(); str_idx = _sectionBitset.next(str_idx))
+        _simStructures.push({_getTanimoto(query_ones, bits_count[str_idx], ones_count[str_idx]), section_idx, str_idx});
+}
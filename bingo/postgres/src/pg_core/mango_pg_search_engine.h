@@ -16,6 +16,7 @@
 #include "pg_bingo_context.h"
 
 #include <cfloat>
+#include <queue>
 
 class BingoPgText;
 class BingoPgIndex;
@@ -81,7 +82,8 @@ class MangoPgSearchEngine : public BingoPgSearchEngine
 public:
     enum
     {
-        MAX_HASH_ELEMENTS = 5
+        MAX_HASH_ELEMENTS = 5,
+        SIM_SCREENING_CHECK_STEP = 16
     };
     MangoPgSearchEngine(BingoPgConfig& bingo_config, const char* rel_name);
     ~MangoPgSearchEngine() override;
@@ -99,13 +101,27 @@ public:
 
     void prepareQuerySearch(BingoPgIndex&, PG_OBJECT scan_desc) override;
     bool searchNext(PG_OBJECT result_ptr) override;
+    long long searchBitmap(PG_OBJECT tbm_ptr) override;
+    float getDistance() const override
+    {
+        return _simDistance;
+    }
 
     DECL_ERROR;
 
+protected:
+    void _screenSection() override;
+
 private:
     MangoPgSearchEngine(const MangoPgSearchEngine&); // no implicit copy
 
-    bool _searchNextSim(PG_OBJECT result_ptr);
+    void _screenSimSection();
+    int _screenSimBounds(const indigo::Array<qword>& common_ones, const int* min_bounds, const int* max_bounds, int rest_bits);
+
+    bool _searchNextDistance(PG_OBJECT result_ptr);
+    void _readSimSection(int section_idx);
+    float _getSimSectionBound(int section_idx);
+    static float _getTanimoto(int query_ones, int target_ones, int common_ones);
 
     void _prepareExactQueryStrings(indigo::Array<char>& what_clause, indigo::Array<char>& from_clause, indigo::Array<char>& where_clause);
     void _prepareExactTauStrings(indigo::Array<char>& what_clause, indigo::Array<char>& from_clause, indigo::Array<char>& where_clause);
@@ -116,6 +132,7 @@ private:
     void _prepareSmartsSearch(PG_OBJECT scan_desc);
     void _prepareMassSearch(PG_OBJECT scan_desc);
     void _prepareSimSearch(PG_OBJECT scan_desc);
+    void _prepareDistanceSearch(PG_OBJECT scan_desc);
     void _getScanQueries(uintptr_t arg_datum, indigo::Array<char>& str1, indigo::Array<char>& str2);
     void _getScanQueries(uintptr_t arg_datum, float& min_bound, float& max_bound, indigo::Array<char>& str1, indigo::Array<char>& str2);
 
@@ -126,5 +143,23 @@ private:
     indigo::Array<char> _shadowHashRelName;
 
     int _searchType;
+
+    /*
+     * Similarity of a structure or an upper bound of the similarity in a section
+     */
+    struct _SimItem
+    {
+        float sim;
+        int section_idx;
+        int structure_idx;
+
+        bool operator<(const _SimItem& other) const
+        {
+            return sim < other.sim;
+        }
+    };
+    std::priority_queue<_SimItem> _simSections;
+    std::priority_queue<_SimItem> _simStructures;
+    float _simDistance;
 };
 #endif /* MANGO_PG_SEARCH_ENGINE_H */
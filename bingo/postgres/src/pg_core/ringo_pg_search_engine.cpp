@@ -117,6 +117,18 @@ bool RingoPgSearchEngine::searchNext(PG_OBJECT result_ptr)
     return result;
 }
 
+long long RingoPgSearchEngine::searchBitmap(PG_OBJECT tbm_ptr)
+{
+    _setBingoContext();
+    /*
+     * Substructure candidates are verified by the recheck of the heap tuples
+     */
+    if (_searchType == BingoPgCommon::REACT_SUB || _searchType == BingoPgCommon::REACT_SMARTS)
+        return _searchBitmapSections(tbm_ptr, true);
+
+    return BingoPgSearchEngine::searchBitmap(tbm_ptr);
+}
+
 void RingoPgSearchEngine::_errorHandler(const char* message, void*)
 {
     throw Error("Error while searching a reaction: %s", message);
@@ -63,6 +63,7 @@ public:
 
     void prepareQuerySearch(BingoPgIndex&, PG_OBJECT scan_desc) override;
     bool searchNext(PG_OBJECT result_ptr) override;
+    long long searchBitmap(PG_OBJECT tbm_ptr) override;
 
     DECL_ERROR;
 
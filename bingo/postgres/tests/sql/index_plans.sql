@@ -0,0 +1,39 @@
+--
+-- Substructure and similarity searches use the bingo index in the serial
+-- and the parallel plans
+--
+CREATE TABLE plan_mols (id int, m text);
+INSERT INTO plan_mols
+    SELECT i, (ARRAY['c1ccccc1', 'Cc1ccccc1', 'Oc1ccccc1', 'CCO', 'CCN', 'CC(=O)O', 'c1ccncc1', 'C1CCCCC1', 'ClC(Cl)Cl', 'CC(C)CC(=O)N'])[1 + i % 10]
+    FROM generate_series(1, 5000) i;
+CREATE INDEX plan_mols_idx ON plan_mols USING bingo_idx (m bingo.molecule);
+ANALYZE plan_mols;
+
+CREATE FUNCTION plan_has_seq_scan(query text) RETURNS boolean AS $$
+DECLARE
+    plan_line text;
+BEGIN
+    FOR plan_line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+        IF plan_line LIKE '%Seq Scan%' THEN
+            RETURN true;
+        END IF;
+    END LOOP;
+    RETURN false;
+END;
+$$ LANGUAGE plpgsql;
+
+SET max_parallel_workers_per_gather = 0;
+SELECT plan_has_seq_scan($$SELECT id FROM plan_mols WHERE m @ ('c1ccccc1', '')::bingo.sub$$);
+SELECT plan_has_seq_scan($$SELECT id FROM plan_mols WHERE m @ (0.5, 1, 'Cc1ccccc1', 'tanimoto')::bingo.sim$$);
+
+SET max_parallel_workers_per_gather = 2;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET min_parallel_index_scan_size = 0;
+SELECT plan_has_seq_scan($$SELECT id FROM plan_mols WHERE m @ ('c1ccccc1', '')::bingo.sub$$);
+SELECT plan_has_seq_scan($$SELECT id FROM plan_mols WHERE m @ (0.5, 1, 'Cc1ccccc1', 'tanimoto')::bingo.sim$$);
+
+RESET ALL;
+DROP FUNCTION plan_has_seq_scan(text);
+DROP TABLE plan_mols;
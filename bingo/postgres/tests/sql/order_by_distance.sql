@@ -0,0 +1,24 @@
+--
+-- Ordered similarity search returns the same distances as sorting by
+-- bingo.simDistance(), with and without a search condition
+--
+CREATE TABLE dist_mols (id int, m text);
+INSERT INTO dist_mols
+    SELECT i, (ARRAY['c1ccccc1', 'Cc1ccccc1', 'Oc1ccccc1', 'CCO', 'CCN', 'CC(=O)O', 'c1ccncc1', 'C1CCCCC1', 'ClC(Cl)Cl', 'CC(C)CC(=O)N', 'Nc1ccc(O)cc1', 'OC(=O)c1ccccc1O'])[1 + i % 12]
+    FROM generate_series(1, 3000) i;
+CREATE INDEX dist_mols_idx ON dist_mols USING bingo_idx (m bingo.molecule);
+ANALYZE dist_mols;
+
+SET enable_seqscan = off;
+SET enable_sort = off;
+
+SELECT (SELECT array_agg(round(d::numeric, 4)) FROM (SELECT m <%> 'Cc1ccccc1' AS d FROM dist_mols ORDER BY m <%> 'Cc1ccccc1' LIMIT 20) ordered) =
+       (SELECT array_agg(round(d::numeric, 4)) FROM (SELECT bingo.simDistance(m, 'Cc1ccccc1') AS d FROM dist_mols ORDER BY 1 LIMIT 20) sorted) AS same_distances;
+
+SELECT (SELECT array_agg(round(d::numeric, 4)) FROM (SELECT m <%> 'Oc1ccccc1' AS d FROM dist_mols WHERE m @ ('c1ccccc1', '')::bingo.sub ORDER BY m <%> 'Oc1ccccc1' LIMIT 20) ordered) =
+       (SELECT array_agg(round(d::numeric, 4)) FROM (SELECT bingo.simDistance(m, 'Oc1ccccc1') AS d FROM dist_mols WHERE m @ ('c1ccccc1', '')::bingo.sub ORDER BY 1 LIMIT 20) sorted) AS same_distances;
+
+SELECT count(*) FROM (SELECT id FROM dist_mols WHERE m @ ('c1ccccc1', '')::bingo.sub ORDER BY m <%> 'Oc1ccccc1' LIMIT 2000) ordered;
+
+RESET ALL;
+DROP TABLE dist_mols;
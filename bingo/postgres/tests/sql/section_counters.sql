@@ -0,0 +1,54 @@
+--
+-- Substructure search finds the same rows with the index as without it for
+-- sections with and without the fingerprint bits usage counters, after
+-- inserts into an existing section and into a new section
+--
+CREATE TABLE counter_mols (id int, m text);
+INSERT INTO counter_mols
+    SELECT i, (ARRAY['c1ccccc1', 'Cc1ccccc1', 'CCO', 'CCN', 'C1CCCCC1'])[1 + i % 5]
+    FROM generate_series(1, 500) i;
+
+CREATE FUNCTION sub_counts(query text) RETURNS text AS $$
+DECLARE
+    with_index bigint;
+    without_index bigint;
+BEGIN
+    SET LOCAL enable_seqscan = off;
+    EXECUTE 'SELECT count(*) FROM counter_mols WHERE m @ ($1, '''')::bingo.sub' INTO with_index USING query;
+    SET LOCAL enable_seqscan = on;
+    SET LOCAL enable_indexscan = off;
+    SET LOCAL enable_bitmapscan = off;
+    EXECUTE 'SELECT count(*) FROM counter_mols WHERE m @ ($1, '''')::bingo.sub' INTO without_index USING query;
+    RETURN with_index || ' ' || without_index;
+END;
+$$ LANGUAGE plpgsql;
+
+-- The default fingerprint fits the counters into the section meta block
+CREATE INDEX counter_mols_idx ON counter_mols USING bingo_idx (m bingo.molecule);
+-- Insert structures with bits that are unused in the existing section
+INSERT INTO counter_mols
+    SELECT i, (ARRAY['Clc1ccc(Br)cc1', 'OC(=O)c1ccccc1O'])[1 + i % 2]
+    FROM generate_series(501, 600) i;
+SELECT sub_counts('Clc1ccc(Br)cc1');
+SELECT sub_counts('OC(=O)c1ccccc1');
+SELECT sub_counts('c1ccccc1');
+-- Fill the section and start a new one
+INSERT INTO counter_mols
+    SELECT i, (ARRAY['CCO', 'Clc1ccc(I)cc1'])[1 + i % 2]
+    FROM generate_series(601, 64600) i;
+SELECT sub_counts('Clc1ccc(I)cc1');
+SELECT sub_counts('c1ccccc1');
+DROP INDEX counter_mols_idx;
+
+-- A large fingerprint leaves no space for the counters, the sections have
+-- the layout of the indexes built before the counters were added
+DELETE FROM counter_mols WHERE id > 500;
+CREATE INDEX counter_mols_idx ON counter_mols USING bingo_idx (m bingo.molecule) WITH (fp_ord_size = 40);
+INSERT INTO counter_mols
+    SELECT i, (ARRAY['Clc1ccc(Br)cc1', 'OC(=O)c1ccccc1O'])[1 + i % 2]
+    FROM generate_series(501, 600) i;
+SELECT sub_counts('Clc1ccc(Br)cc1');
+SELECT sub_counts('c1ccccc1');
+
+DROP FUNCTION sub_counts(text);
+DROP TABLE counter_mols;
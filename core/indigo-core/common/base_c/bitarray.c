@@ -21,6 +21,41 @@
 
 #include "base_c/bitarray.h"
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Hardware popcount is used where the compiler provides it: GCC and Clang
+// emit a single POPCNT instruction when it is enabled for the target
+// (e.g. -mpopcnt or -march=native) and a branch-free sequence otherwise.
+static int _bitPopcount64(qword value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(value);
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Byte buffers carry no alignment guarantee, so words are loaded and stored
+// through memcpy, which compilers turn into single unaligned moves
+static qword _bitLoadQword(const void* ptr)
+{
+    qword value;
+    memcpy(&value, ptr, sizeof(qword));
+    return value;
+}
+
+static void _bitStoreQword(void* ptr, qword value)
+{
+    memcpy(ptr, &value, sizeof(qword));
+}
+
 int bitGetBit(const void* bitarray, int bitno)
 {
     return ((((char*)bitarray)[bitno / 8] & (char)(1 << (bitno % 8))) == 0) ? 0 : 1;
@@ -41,16 +76,15 @@ void bitFlipBit(void* bitarray, int bitno)
 
 int bitTestEquality(const void* bits1, const void* bits2, int nbits)
 {
-    char* chars1 = (char*)bits1;
-    char* chars2 = (char*)bits2;
+    const char* chars1 = (const char*)bits1;
+    const char* chars2 = (const char*)bits2;
     char mask = ~(0xFF << (nbits & 7));
-    int i;
+    int nbytes = nbits / 8;
 
-    for (i = 0; i < nbits / 8; i++)
-        if (chars1[i] != chars2[i])
-            return 0;
+    if (memcmp(chars1, chars2, nbytes) != 0)
+        return 0;
 
-    if ((chars1[nbits / 8] & mask) != (chars2[nbits / 8] & mask))
+    if ((nbits & 7) != 0 && (chars1[nbytes] & mask) != (chars2[nbytes] & mask))
         return 0;
 
     return 1;
@@ -73,13 +107,21 @@ int bitTestEqualityByMask(const void* bits1, const void* bits2, const void* bitM
     const char* chars2 = (const char*)bits2;
     const char* bitMask = (const char*)bitMaskVoid;
     char mask = ~(0xFF << (nbits & 7));
+    int qwords_count = nbits / 64;
     int i;
 
-    for (i = 0; i < nbits / 8; i++)
+    for (i = 0; i < qwords_count; i++)
+    {
+        int offset = i * sizeof(qword);
+        if (((_bitLoadQword(chars1 + offset) ^ _bitLoadQword(chars2 + offset)) & _bitLoadQword(bitMask + offset)) != 0)
+            return 0;
+    }
+
+    for (i = qwords_count * 8; i < nbits / 8; i++)
         if ((chars1[i] & bitMask[i]) != (chars2[i] & bitMask[i]))
             return 0;
 
-    if (((chars1[nbits / 8] & bitMask[nbits / 8]) & mask) != ((chars2[nbits / 8] & bitMask[nbits / 8]) & mask))
+    if ((nbits & 7) != 0 && ((chars1[nbits / 8] & bitMask[nbits / 8]) & mask) != ((chars2[nbits / 8] & bitMask[nbits / 8]) & mask))
         return 0;
 
     return 1;
@@ -92,9 +134,16 @@ int bitGetAandBxorNotC(const void* a, const void* b, const void* c, void* res, i
     const char* bc = (const char*)b;
     const char* cc = (const char*)c;
     char* rc = (char*)res;
+    int qwords_count = nbits / 64;
     int i;
 
-    for (i = 0; i < nbits / 8; i++)
+    for (i = 0; i < qwords_count; i++)
+    {
+        int offset = i * sizeof(qword);
+        _bitStoreQword(rc + offset, _bitLoadQword(ac + offset) & (_bitLoadQword(bc + offset) ^ ~_bitLoadQword(cc + offset)));
+    }
+
+    for (i = qwords_count * 8; i < nbits / 8; i++)
         rc[i] = ac[i] & (bc[i] ^ ~cc[i]);
 
     if ((nbits & 7) != 0)
@@ -125,13 +174,34 @@ int bitGetOnesCountDword(dword v)
 
 int bitGetOnesCountQword(qword value)
 {
-    return bitGetOnesCountDword((dword)value) + bitGetOnesCountDword((dword)(value >> 32));
+    return _bitPopcount64(value);
 }
 
 int bitGetOnesCount(const byte* data, int size)
 {
+    int qwords_count = size / sizeof(qword);
+    int bytes_left = size - qwords_count * sizeof(qword);
     int count = 0;
-    while (size-- > 0)
+
+    // Four independent accumulators let the CPU overlap popcount latencies
+    int c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    while (qwords_count >= 4)
+    {
+        c0 += _bitPopcount64(_bitLoadQword(data));
+        c1 += _bitPopcount64(_bitLoadQword(data + sizeof(qword)));
+        c2 += _bitPopcount64(_bitLoadQword(data + 2 * sizeof(qword)));
+        c3 += _bitPopcount64(_bitLoadQword(data + 3 * sizeof(qword)));
+        data += 4 * sizeof(qword);
+        qwords_count -= 4;
+    }
+    while (qwords_count-- > 0)
+    {
+        c0 += _bitPopcount64(_bitLoadQword(data));
+        data += sizeof(qword);
+    }
+    count = c0 + c1 + c2 + c3;
+
+    while (bytes_left-- > 0)
         count += bitGetOnesCountByte(*data++);
     return count;
 }
@@ -160,6 +230,25 @@ int bitGetOneLOIndex(byte value)
     return oneLOIndex[value];
 }
 
+int bitGetOneLOIndexQword(qword value)
+{
+    if (value == 0)
+        return 64;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    {
+        int shift = 0;
+        while ((value & 0xFF) == 0)
+        {
+            value >>= 8;
+            shift += 8;
+        }
+        return shift + bitGetOneLOIndex((byte)(value & 0xFF));
+    }
+#endif
+}
+
 int bitGetSize(int nbits)
 {
     return (nbits + 7) / 8;
@@ -279,7 +368,7 @@ int bitDifferentOnes(const byte* bit1, const byte* bit2, int n_bytes)
     while (qwords_count-- > 0)
     {
         qword id = *bit1_ptr ^ *bit2_ptr;
-        count += bitGetOnesCount((byte*)&id, sizeof(qword));
+        count += bitGetOnesCountQword(id);
 
         bit1_ptr++;
         bit2_ptr++;
@@ -323,6 +412,18 @@ int bitUnionOnes(const byte* bit1, const byte* bit2, int n_bytes)
 // a &= b
 void bitAnd(byte* a, const byte* b, int nbytes)
 {
+    int qwords_count = nbytes / sizeof(qword);
+    int i;
+
+    for (i = 0; i < qwords_count; i++)
+    {
+        int offset = i * sizeof(qword);
+        _bitStoreQword(a + offset, _bitLoadQword(a + offset) & _bitLoadQword(b + offset));
+    }
+
+    a += qwords_count * sizeof(qword);
+    b += qwords_count * sizeof(qword);
+    nbytes -= qwords_count * sizeof(qword);
     while (nbytes-- > 0)
     {
         *a = *a & *b;
@@ -334,6 +435,18 @@ void bitAnd(byte* a, const byte* b, int nbytes)
 // a |= b
 void bitOr(byte* a, const byte* b, int nbytes)
 {
+    int qwords_count = nbytes / sizeof(qword);
+    int i;
+
+    for (i = 0; i < qwords_count; i++)
+    {
+        int offset = i * sizeof(qword);
+        _bitStoreQword(a + offset, _bitLoadQword(a + offset) | _bitLoadQword(b + offset));
+    }
+
+    a += qwords_count * sizeof(qword);
+    b += qwords_count * sizeof(qword);
+    nbytes -= qwords_count * sizeof(qword);
     while (nbytes-- > 0)
     {
         *a = *a | *b;
@@ -345,7 +458,17 @@ void bitOr(byte* a, const byte* b, int nbytes)
 int bitIsAllZero(const void* bits, int nbytes)
 {
     const byte* a = (const byte*)bits;
+    int qwords_count = nbytes / sizeof(qword);
+    qword acc = 0;
+    int i;
+
+    for (i = 0; i < qwords_count; i++)
+        acc |= _bitLoadQword(a + i * sizeof(qword));
+    if (acc != 0)
+        return 0;
 
+    a += qwords_count * sizeof(qword);
+    nbytes -= qwords_count * sizeof(qword);
     while (nbytes-- > 0)
     {
         if (*a != 0)
@@ -44,6 +44,8 @@ extern "C"
     DLLEXPORT int bitGetOneHOIndex(byte value);
     // Get low-order 1-bit in byte
     DLLEXPORT int bitGetOneLOIndex(byte value);
+    // Get low-order 1-bit in qword (64 if value is zero)
+    DLLEXPORT int bitGetOneLOIndexQword(qword value);
 
     DLLEXPORT int bitGetSize(int nbits);
 
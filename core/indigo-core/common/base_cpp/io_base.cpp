@@ -17,6 +17,8 @@
  ***************************************************************************/
 
 #include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 #include "base_cpp/io_base.h"
 
@@ -52,6 +54,59 @@ FILE* indigo::openFile(Encoding filename_encoding, const char* filename, const c
     return file;
 }
 
+bool indigo::renameFile(Encoding filename_encoding, const char* from, const char* to)
+{
+#if defined(_WIN32) && !defined(__MINGW32__)
+    if (filename_encoding == ENCODING_UTF8)
+    {
+        wchar_t w_from[1024];
+        wchar_t w_to[1024];
+
+        MultiByteToWideChar(CP_UTF8, 0, from, -1, w_from, 1024);
+        MultiByteToWideChar(CP_UTF8, 0, to, -1, w_to, 1024);
+
+        return MoveFileExW(w_from, w_to, MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+bool indigo::removeFile(Encoding filename_encoding, const char* filename)
+{
+#if defined(_WIN32) && !defined(__MINGW32__)
+    if (filename_encoding == ENCODING_UTF8)
+    {
+        wchar_t w_filename[1024];
+
+        MultiByteToWideChar(CP_UTF8, 0, filename, -1, w_filename, 1024);
+
+        return _wremove(w_filename) == 0;
+    }
+#endif
+    return remove(filename) == 0;
+}
+
+long long indigo::fileModificationTime(Encoding filename_encoding, const char* filename)
+{
+#if defined(_WIN32) && !defined(__MINGW32__)
+    struct _stat64 st;
+    if (filename_encoding == ENCODING_UTF8)
+    {
+        wchar_t w_filename[1024];
+
+        MultiByteToWideChar(CP_UTF8, 0, filename, -1, w_filename, 1024);
+
+        return _wstat64(w_filename, &st) == 0 ? (long long)st.st_mtime : -1;
+    }
+    return _stat64(filename, &st) == 0 ? (long long)st.st_mtime : -1;
+#else
+    struct stat st;
+    return stat(filename, &st) == 0 ? (long long)st.st_mtime : -1;
+#endif
+}
+
 #if defined(_WIN32) && !defined(__MINGW32__)
 CLocale CLocale::instance;
 
@@ -34,6 +34,11 @@ namespace indigo
     };
 
     FILE* openFile(Encoding filename_encoding, const char* filename, const char* mode);
+    // Replaces the existing file with the same name. Returns false on failure
+    bool renameFile(Encoding filename_encoding, const char* from, const char* to);
+    bool removeFile(Encoding filename_encoding, const char* filename);
+    // Seconds since the epoch, or -1 if the file can not be accessed
+    long long fileModificationTime(Encoding filename_encoding, const char* filename);
 
 #if defined(_WIN32) && !defined(__MINGW32__)
     _locale_t getCLocale();
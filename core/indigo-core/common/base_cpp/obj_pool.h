@@ -97,6 +97,11 @@ namespace indigo
             return _pool.end();
         }
 
+        void reserve(int to_reserve)
+        {
+            _pool.reserve(to_reserve);
+        }
+
         void clear()
         {
             for (int i = _pool.begin(); i != _pool.end(); i = _pool.next(i))
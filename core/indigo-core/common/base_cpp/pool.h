@@ -114,6 +114,12 @@ namespace indigo
             return _array.size();
         }
 
+        void reserve(int to_reserve)
+        {
+            _array.reserve(to_reserve);
+            _next.reserve(to_reserve);
+        }
+
         void clear()
         {
             _array.clear();
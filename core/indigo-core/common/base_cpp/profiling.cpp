@@ -76,12 +76,154 @@ ObjArray<Array<char>>& ProfilingSystem::getNames()
     return _names;
 }
 
+//
+// ProfilingSystem::Shard
+//
+
+class ProfilingSystem::Shard
+{
+public:
+    Shard()
+    {
+        for (int i = 0; i < _max_segments; i++)
+            _segments[i].store(nullptr, std::memory_order_relaxed);
+        _records_count.store(0, std::memory_order_relaxed);
+        ProfilingSystem::getInstance()._addShard(this);
+    }
+
+    ~Shard()
+    {
+        ProfilingSystem::getInstance()._retireShard(this);
+        for (int i = 0; i < _max_segments; i++)
+            delete[] _segments[i].load(std::memory_order_relaxed);
+    }
+
+    int recordsCount() const
+    {
+        return _records_count.load(std::memory_order_acquire);
+    }
+
+    // Returns null for a record that was never written
+    ShardRecord* find(int name_index) const
+    {
+        if (name_index >= recordsCount())
+            return nullptr;
+        ShardRecord* segment = _segments[name_index / _segment_size].load(std::memory_order_acquire);
+        if (segment == nullptr)
+            return nullptr;
+        return segment + name_index % _segment_size;
+    }
+
+    // Called only by the owner thread. Returns null for labels beyond the
+    // shard capacity, their samples are dropped.
+    ShardRecord* get(int name_index)
+    {
+        if (name_index < 0 || name_index >= _segment_size * _max_segments)
+            return nullptr;
+
+        std::atomic<ShardRecord*>& segment = _segments[name_index / _segment_size];
+        ShardRecord* records = segment.load(std::memory_order_relaxed);
+        if (records == nullptr)
+        {
+            records = new ShardRecord[_segment_size];
+            segment.store(records, std::memory_order_release);
+        }
+        if (name_index >= _records_count.load(std::memory_order_relaxed))
+            _records_count.store(name_index + 1, std::memory_order_release);
+
+        return records + name_index % _segment_size;
+    }
+
+private:
+    enum
+    {
+        _segment_size = 128,
+        _max_segments = 128
+    };
+
+    std::atomic<ShardRecord*> _segments[_max_segments];
+    std::atomic<int> _records_count;
+};
+
+//
+// ProfilingSystem
+//
+
+ProfilingSystem::ProfilingSystem()
+{
+}
+
 ProfilingSystem& ProfilingSystem::getInstance()
 {
-    thread_local ProfilingSystem _profiling_system;
+    static ProfilingSystem _profiling_system;
     return _profiling_system;
 }
 
+ProfilingSystem::Shard& ProfilingSystem::_getThreadShard()
+{
+    thread_local Shard _shard;
+    return _shard;
+}
+
+void ProfilingSystem::_addShard(Shard* shard)
+{
+    OsLocker locker(_shards_lock);
+    _shards.push(shard);
+}
+
+void ProfilingSystem::_retireShard(Shard* shard)
+{
+    OsLocker locker(_shards_lock);
+
+    for (int i = 0; i < shard->recordsCount(); i++)
+    {
+        ShardRecord* rec = shard->find(i);
+        if (rec == nullptr || rec->type.load(std::memory_order_relaxed) == TYPE_NONE)
+            continue;
+
+        while (_retired.size() <= i)
+            _retired.push();
+        _retired[i].type = rec->type.load(std::memory_order_relaxed);
+        rec->current.mergeTo(_retired[i].current);
+        rec->total.mergeTo(_retired[i].total);
+    }
+
+    int idx = _shards.find(shard);
+    if (idx != -1)
+        _shards.remove(idx);
+}
+
+void ProfilingSystem::_mergeRecords(ObjArray<Record>& records)
+{
+    OsLocker locker(_shards_lock);
+
+    records.clear();
+    for (int i = 0; i < _retired.size(); i++)
+    {
+        Record& rec = records.push();
+        rec.type = _retired[i].type;
+        rec.current.merge(_retired[i].current);
+        rec.total.merge(_retired[i].total);
+    }
+
+    for (int s = 0; s < _shards.size(); s++)
+    {
+        Shard& shard = *_shards[s];
+        for (int i = 0; i < shard.recordsCount(); i++)
+        {
+            ShardRecord* shard_rec = shard.find(i);
+            if (shard_rec == nullptr || shard_rec->type.load(std::memory_order_relaxed) == TYPE_NONE)
+                continue;
+
+            while (records.size() <= i)
+                records.push();
+            records[i].type = shard_rec->type.load(std::memory_order_relaxed);
+            shard_rec->current.mergeTo(records[i].current);
+            shard_rec->total.mergeTo(records[i].total);
+        }
+    }
+}
+
 int ProfilingSystem::getNameIndex(const char* name, bool add_if_not_exists)
 {
     OsLocker locker(_profiling_global_names_lock);
@@ -100,31 +242,48 @@ int ProfilingSystem::getNameIndex(const char* name, bool add_if_not_exists)
 
 void ProfilingSystem::addTimer(int name_index, qword dt)
 {
-    OsLocker locker(_lock);
-
-    _ensureRecordExistanceLocked(name_index);
-    Record& rec = _records[name_index];
-    rec.type = Record::TYPE_TIMER;
-    rec.current.add(dt);
-    rec.total.add(dt);
+    ShardRecord* rec = _getThreadShard().get(name_index);
+    if (rec == nullptr)
+        return;
+    rec->type.store(TYPE_TIMER, std::memory_order_relaxed);
+    rec->current.add(dt);
+    rec->total.add(dt);
 }
 
 void ProfilingSystem::addCounter(int name_index, int value)
 {
-    OsLocker locker(_lock);
-
-    _ensureRecordExistanceLocked(name_index);
-    Record& rec = _records[name_index];
-    rec.type = Record::TYPE_COUNTER;
-    rec.current.add(value);
-    rec.total.add(value);
+    ShardRecord* rec = _getThreadShard().get(name_index);
+    if (rec == nullptr)
+        return;
+    rec->type.store(TYPE_COUNTER, std::memory_order_relaxed);
+    rec->current.add(value);
+    rec->total.add(value);
 }
 
 void ProfilingSystem::reset(bool all)
 {
-    OsLocker locker(_lock);
-    for (int i = 0; i < _records.size(); i++)
-        _records[i].reset(all);
+    OsLocker locker(_shards_lock);
+
+    for (int i = 0; i < _retired.size(); i++)
+    {
+        _retired[i].current.reset();
+        if (all)
+            _retired[i].total.reset();
+    }
+
+    for (int s = 0; s < _shards.size(); s++)
+    {
+        Shard& shard = *_shards[s];
+        for (int i = 0; i < shard.recordsCount(); i++)
+        {
+            ShardRecord* rec = shard.find(i);
+            if (rec == nullptr)
+                continue;
+            rec->current.reset();
+            if (all)
+                rec->total.reset();
+        }
+    }
 }
 
 int ProfilingSystem::_recordsCmp(int idx1, int idx2, void* context)
@@ -135,26 +294,19 @@ int ProfilingSystem::_recordsCmp(int idx1, int idx2, void* context)
 
 void ProfilingSystem::getStatistics(Output& output, bool get_all)
 {
-    OsLocker locker(_lock);
+    ObjArray<Record> records;
+    _mergeRecords(records);
+
+    OsLocker locker(_shards_lock);
     OsLocker names_locker(_profiling_global_names_lock);
     auto& _names = getNames();
 
     // Print formatted statistics
-    while (_sorted_records.size() < _records.size())
+    _sorted_records.clear();
+    while (_sorted_records.size() < records.size())
         _sorted_records.push(_sorted_records.size());
     _sorted_records.qsort(_recordsCmp, this);
 
-    // Find maximum name length
-    int max_len = 0;
-    for (int i = 0; i < _records.size(); i++)
-    {
-        if (!_hasLabelIndex(i))
-            continue;
-
-        if (_names[i].size() > max_len)
-            max_len = _names[i].size();
-    }
-
     SmartTableOutput table_output(output, true);
 
     table_output.setLineFormat("|c|5c|5c|");
@@ -169,22 +321,22 @@ void ProfilingSystem::getStatistics(Output& output, bool get_all)
     for (int i = 0; i < _sorted_records.size(); i++)
     {
         int idx = _sorted_records[i];
-        if (!_hasLabelIndex(idx))
+        if (!_hasLabelIndex(records, idx))
             continue;
-        Record& rec = _records[idx];
+        Record& rec = records[idx];
         if (!get_all && rec.current.count == 0)
             continue;
 
         table_output.printf("%s\t", _names[idx].ptr());
 
-        if (rec.type == Record::TYPE_TIMER)
+        if (rec.type == TYPE_TIMER)
         {
             _printTimerData(rec.current, table_output);
             table_output.printf("\t");
             _printTimerData(rec.total, table_output);
             table_output.printf("\n");
         }
-        else /* rec.type == Record::TYPE_COUNTER */
+        else /* rec.type == TYPE_COUNTER */
         {
             _printCounterData(rec.current, table_output);
             table_output.printf("\t");
@@ -197,7 +349,7 @@ void ProfilingSystem::getStatistics(Output& output, bool get_all)
     table_output.flush();
 }
 
-void ProfilingSystem::_printTimerData(const Record::Data& data, Output& output)
+void ProfilingSystem::_printTimerData(const Data& data, Output& output)
 {
     if (data.count == 0)
     {
@@ -215,7 +367,7 @@ void ProfilingSystem::_printTimerData(const Record::Data& data, Output& output)
     output.printf("%0.2fs\t%0.0lf\t%0.1fms\t%0.1lfms\t%0.1fms", total_sec, (double)data.count, avg_ms, sigma_ms, max_ms);
 }
 
-void ProfilingSystem::_printCounterData(const Record::Data& data, Output& output)
+void ProfilingSystem::_printCounterData(const Data& data, Output& output)
 {
     if (data.count == 0)
     {
@@ -229,11 +381,11 @@ void ProfilingSystem::_printCounterData(const Record::Data& data, Output& output
     output.printf("%0.0lf\t%0.0lf\t%0.1f\t%0.1lf\t%0.0lf", (double)data.value, (double)data.count, avg_value, sqrt(sigma_sq), (double)data.max_value);
 }
 
-bool ProfilingSystem::_hasLabelIndex(int name_index)
+bool ProfilingSystem::_hasLabelIndex(ObjArray<Record>& records, int name_index)
 {
-    if (name_index >= _records.size())
+    if (name_index >= records.size())
         return false;
-    return _records[name_index].total.count > 0;
+    return records[name_index].total.count > 0;
 }
 
 bool ProfilingSystem::hasLabel(const char* name)
@@ -241,80 +393,110 @@ bool ProfilingSystem::hasLabel(const char* name)
     int name_index = getNameIndex(name, false);
     if (name_index == -1)
         return false;
-    return _hasLabelIndex(name_index);
+
+    ObjArray<Record> records;
+    _mergeRecords(records);
+    return _hasLabelIndex(records, name_index);
 }
 
-void ProfilingSystem::_ensureRecordExistanceLocked(int name_index)
+ProfilingSystem::Record ProfilingSystem::_getLabelRecord(const char* name)
 {
-    while (_records.size() <= name_index)
-        _records.push();
+    int idx = getNameIndex(name);
+
+    ObjArray<Record> records;
+    _mergeRecords(records);
+
+    Record rec;
+    if (idx < records.size())
+        rec = records[idx];
+    return rec;
 }
 
 float ProfilingSystem::getLabelExecTime(const char* name, bool total)
 {
-    int idx = getNameIndex(name);
-    OsLocker locker(_lock);
-    _ensureRecordExistanceLocked(idx);
-
-    if (total)
-        return nanoHowManySeconds(_records[idx].total.value);
-    else
-        return nanoHowManySeconds(_records[idx].current.value);
+    Record rec = _getLabelRecord(name);
+    return nanoHowManySeconds(total ? rec.total.value : rec.current.value);
 }
 
 qword ProfilingSystem::getLabelValue(const char* name, bool total)
 {
-    int idx = getNameIndex(name);
-    OsLocker locker(_lock);
-    _ensureRecordExistanceLocked(idx);
-    if (total)
-        return _records[idx].total.value;
-    else
-        return _records[idx].current.value;
+    Record rec = _getLabelRecord(name);
+    return total ? rec.total.value : rec.current.value;
 }
 
 qword ProfilingSystem::getLabelCallCount(const char* name, bool total)
 {
-    int idx = getNameIndex(name);
-    OsLocker locker(_lock);
-    _ensureRecordExistanceLocked(idx);
-    if (total)
-        return _records[idx].total.count;
-    else
-        return _records[idx].current.count;
+    Record rec = _getLabelRecord(name);
+    return total ? rec.total.count : rec.current.count;
 }
 
 //
 // ProfilingSystem::Record
 //
-void ProfilingSystem::Record::reset(bool all)
+
+ProfilingSystem::Record::Record() : type(TYPE_NONE)
+{
+}
+
+ProfilingSystem::ShardRecord::ShardRecord() : type(TYPE_NONE)
 {
-    current.reset();
-    if (all)
-        total.reset();
 }
 
 //
-// ProfilingSystem::Record::Data
+// ProfilingSystem::Data
 //
 
-ProfilingSystem::Record::Data::Data()
+ProfilingSystem::Data::Data()
 {
     reset();
 }
 
-void ProfilingSystem::Record::Data::reset()
+void ProfilingSystem::Data::reset()
 {
     count = value = max_value = 0;
     square_sum = 0;
 }
 
-void ProfilingSystem::Record::Data::add(qword adding_value)
+void ProfilingSystem::Data::merge(const Data& other)
+{
+    count += other.count;
+    value += other.value;
+    max_value = std::max(max_value, other.max_value);
+    square_sum += other.square_sum;
+}
+
+//
+// ProfilingSystem::ShardData
+//
+
+ProfilingSystem::ShardData::ShardData()
 {
-    count++;
-    value += adding_value;
-    max_value = std::max(max_value, adding_value);
+    reset();
+}
+
+void ProfilingSystem::ShardData::reset()
+{
+    count.store(0, std::memory_order_relaxed);
+    value.store(0, std::memory_order_relaxed);
+    max_value.store(0, std::memory_order_relaxed);
+    square_sum.store(0, std::memory_order_relaxed);
+}
+
+void ProfilingSystem::ShardData::add(qword adding_value)
+{
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    value.store(value.load(std::memory_order_relaxed) + adding_value, std::memory_order_relaxed);
+    if (adding_value > max_value.load(std::memory_order_relaxed))
+        max_value.store(adding_value, std::memory_order_relaxed);
 
     double adding_value_dbl = (double)adding_value;
-    square_sum += adding_value_dbl * adding_value_dbl;
+    square_sum.store(square_sum.load(std::memory_order_relaxed) + adding_value_dbl * adding_value_dbl, std::memory_order_relaxed);
+}
+
+void ProfilingSystem::ShardData::mergeTo(Data& data) const
+{
+    data.count += count.load(std::memory_order_relaxed);
+    data.value += value.load(std::memory_order_relaxed);
+    data.max_value = std::max(data.max_value, max_value.load(std::memory_order_relaxed));
+    data.square_sum += square_sum.load(std::memory_order_relaxed);
 }
@@ -19,6 +19,8 @@
 #ifndef __profiling_h__
 #define __profiling_h__
 
+#include <atomic>
+
 #include "base_c/nano.h"
 #include "base_cpp/array.h"
 #include "base_cpp/obj_array.h"
@@ -30,20 +32,17 @@
 #endif
 
 #define _PROF_GET_NAME_INDEX(var_name, name)                                                                                                                   \
-    static int var_name##_name_index;                                                                                                                          \
-    if (var_name##_name_index == 0)                                                                                                                            \
+    static std::atomic<int> var_name##_name_index(-1);                                                                                                         \
+    if (var_name##_name_index.load(std::memory_order_acquire) == -1)                                                                                           \
     {                                                                                                                                                          \
         indigo::OsLocker locker(indigo::_profiling_global_lock);                                                                                               \
-        if (var_name##_name_index == 0)                                                                                                                        \
-        {                                                                                                                                                      \
-            indigo::ProfilingSystem& inst = indigo::ProfilingSystem::getInstance();                                                                            \
-            var_name##_name_index = inst.getNameIndex(name);                                                                                                   \
-        }                                                                                                                                                      \
+        if (var_name##_name_index.load(std::memory_order_relaxed) == -1)                                                                                       \
+            var_name##_name_index.store(indigo::ProfilingSystem::getNameIndex(name), std::memory_order_release);                                               \
     }
 
 #define profTimerStart(var_name, name)                                                                                                                         \
     _PROF_GET_NAME_INDEX(var_name, name)                                                                                                                       \
-    indigo::_ProfilingTimer var_name##_timer(var_name##_name_index)
+    indigo::_ProfilingTimer var_name##_timer(var_name##_name_index.load(std::memory_order_relaxed))
 
 #define profTimerStop(var_name) var_name##_timer.stop()
 
@@ -56,7 +55,7 @@
     {                                                                                                                                                          \
         _PROF_GET_NAME_INDEX(var_name, name)                                                                                                                   \
         indigo::ProfilingSystem& inst = indigo::ProfilingSystem::getInstance();                                                                                \
-        inst.addTimer(var_name##_name_index, dt);                                                                                                              \
+        inst.addTimer(var_name##_name_index.load(std::memory_order_relaxed), dt);                                                                              \
     } while (false)
 
 #define profIncCounter(name, count)                                                                                                                            \
@@ -64,7 +63,7 @@
     {                                                                                                                                                          \
         _PROF_GET_NAME_INDEX(var_name, name)                                                                                                                   \
         indigo::ProfilingSystem& inst = indigo::ProfilingSystem::getInstance();                                                                                \
-        inst.addCounter(var_name##_name_index, count);                                                                                                         \
+        inst.addCounter(var_name##_name_index.load(std::memory_order_relaxed), count);                                                                         \
     } while (false)
 
 #define profTimersReset() indigo::ProfilingSystem::getInstance().reset(false)
@@ -76,6 +75,12 @@ namespace indigo
 {
     class Output;
 
+    // Records are collected by per-thread shards without locks: each shard is
+    // written only by its own thread, while statistics queries and resets merge
+    // or clear all the shards. Data of finished threads is kept in a retired shard.
+    // There is one instance per process, so the statistics and resets are not
+    // limited to the calling thread or Indigo session. Samples of labels beyond
+    // the shard capacity are dropped.
     class DLLEXPORT ProfilingSystem
     {
     public:
@@ -96,44 +101,80 @@ namespace indigo
         DECL_ERROR;
 
     private:
-        struct Record
+        enum
         {
-            enum
-            {
-                TYPE_TIMER,
-                TYPE_COUNTER
-            };
+            TYPE_NONE,
+            TYPE_TIMER,
+            TYPE_COUNTER
+        };
 
-            struct Data
-            {
-                qword count, value, max_value;
-                double square_sum;
+        // Plain record data used for merged statistics
+        struct Data
+        {
+            qword count, value, max_value;
+            double square_sum;
 
-                Data();
+            Data();
 
-                void reset();
+            void reset();
 
-                void add(qword value);
-            };
+            void merge(const Data& other);
+        };
 
+        struct Record
+        {
             Data current, total;
-
             int type;
 
-            void reset(bool all);
+            Record();
+        };
+
+        // Record data of one shard. Only the owner thread adds values, so relaxed
+        // load/store pairs are enough; other threads only read or clear them.
+        struct ShardData
+        {
+            std::atomic<qword> count, value, max_value;
+            std::atomic<double> square_sum;
+
+            ShardData();
+
+            void reset();
+
+            void add(qword value);
+
+            void mergeTo(Data& data) const;
         };
 
+        struct ShardRecord
+        {
+            ShardData current, total;
+            std::atomic<int> type;
+
+            ShardRecord();
+        };
+
+        class Shard;
+        friend class Shard;
+
+        ProfilingSystem();
+
+        Shard& _getThreadShard();
+        void _addShard(Shard* shard);
+        void _retireShard(Shard* shard);
+        void _mergeRecords(ObjArray<Record>& records);
+
         static int _recordsCmp(int idx1, int idx2, void* context);
 
-        void _printTimerData(const Record::Data& data, Output& output);
-        void _printCounterData(const Record::Data& data, Output& output);
+        void _printTimerData(const Data& data, Output& output);
+        void _printCounterData(const Data& data, Output& output);
 
-        bool _hasLabelIndex(int name_index);
-        void _ensureRecordExistanceLocked(int name_index);
+        static bool _hasLabelIndex(ObjArray<Record>& records, int name_index);
+        Record _getLabelRecord(const char* name);
 
-        ObjArray<Record> _records;
+        ObjArray<Record> _retired;
+        Array<Shard*> _shards;
         Array<int> _sorted_records;
-        OsLock _lock;
+        OsLock _shards_lock;
 
         static ObjArray<Array<char>>& getNames();
     };
@@ -0,0 +1,200 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#include "base_cpp/record_offset_index.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "base_cpp/crc32.h"
+#include "base_cpp/output.h"
+#include "base_cpp/scanner.h"
+
+using namespace indigo;
+
+IMPL_ERROR(RecordOffsetIndex, "record offset index");
+
+namespace
+{
+    const char MAGIC[8] = {'I', 'N', 'D', 'G', 'O', 'I', 'X', '2'};
+    const qword BYTE_ORDER_MARK = 0x0102030405060708ULL;
+    const int CHECKSUM_BLOCK = 4096;
+
+    // The offsets follow the header at a multiple of 8 bytes
+    struct Header
+    {
+        char magic[8];
+        qword byte_order;
+        qword source_length;
+        long long source_mtime;
+        dword source_checksum;
+        dword reserved;
+        qword count;
+    };
+
+    void writeBlock(Output& output, const void* data, qword size)
+    {
+        const qword chunk = 1 << 30;
+        for (qword pos = 0; pos < size; pos += chunk)
+            output.write((const char*)data + pos, (int)std::min(chunk, size - pos));
+    }
+}
+
+RecordOffsetIndex::RecordOffsetIndex()
+{
+    clear();
+}
+
+RecordOffsetIndex::~RecordOffsetIndex()
+{
+}
+
+void RecordOffsetIndex::clear()
+{
+    _file.reset();
+    _buffer.clear();
+    _count = 0;
+    _offsets = 0;
+}
+
+dword RecordOffsetIndex::_checksum(Scanner& source, long long& length)
+{
+    long long pos = source.tell();
+    Array<char> buf;
+
+    length = source.length();
+
+    int head = (int)std::min(length, (long long)CHECKSUM_BLOCK);
+    int tail = (int)std::min(length - head, (long long)CHECKSUM_BLOCK);
+
+    buf.resize(head + tail);
+    source.seek(0, SEEK_SET);
+    source.read(head, buf.ptr());
+    if (tail > 0)
+    {
+        source.seek(length - tail, SEEK_SET);
+        source.read(tail, buf.ptr() + head);
+    }
+    source.seek(pos, SEEK_SET);
+
+    return CRC32::get(buf.ptr(), buf.size());
+}
+
+bool RecordOffsetIndex::load(Encoding filename_encoding, const char* filename, Scanner& source, long long source_mtime)
+{
+    clear();
+
+    try
+    {
+        _file = std::make_unique<MappedFileScanner>(filename_encoding, filename);
+    }
+    catch (Exception&)
+    {
+        return false;
+    }
+
+    const char* data = _file->data();
+    qword size = (qword)_file->length();
+
+    if (!_file->isMapped())
+    {
+        _file->readAll(_buffer);
+        _file.reset();
+        data = _buffer.ptr();
+    }
+
+    Header header;
+    long long source_length;
+
+    if (size < sizeof(Header))
+    {
+        clear();
+        return false;
+    }
+    memcpy(&header, data, sizeof(Header));
+
+    dword source_checksum = _checksum(source, source_length);
+
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.byte_order != BYTE_ORDER_MARK || header.source_length != (qword)source_length ||
+        header.source_mtime != source_mtime || header.source_checksum != source_checksum || header.count > 0x7FFFFFFF)
+    {
+        clear();
+        return false;
+    }
+
+    qword count = header.count;
+    if (size != sizeof(Header) + (count + 1) * sizeof(long long))
+    {
+        clear();
+        return false;
+    }
+
+    _count = (int)count;
+    _offsets = (const long long*)(data + sizeof(Header));
+
+    if (!_isValid(source_length))
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool RecordOffsetIndex::_isValid(long long source_length) const
+{
+    // Offsets are ascending and stay within the source
+    if (_offsets[0] < 0 || _offsets[_count] > source_length)
+        return false;
+    for (int i = 0; i < _count; i++)
+        if (_offsets[i] > _offsets[i + 1])
+            return false;
+    return true;
+}
+
+int RecordOffsetIndex::count() const
+{
+    return _count;
+}
+
+long long RecordOffsetIndex::offset(int index) const
+{
+    if (index < 0 || index > _count)
+        throw Error("record index %d is out of range", index);
+    return _offsets[index];
+}
+
+void RecordOffsetIndex::save(Output& output, Scanner& source, long long source_mtime, const Array<long long>& offsets)
+{
+    if (offsets.size() < 1)
+        throw Error("no end offset");
+
+    Header header;
+    long long source_length;
+
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byte_order = BYTE_ORDER_MARK;
+    header.source_checksum = _checksum(source, source_length);
+    header.source_length = source_length;
+    header.source_mtime = source_mtime;
+    header.count = offsets.size() - 1;
+
+    output.write(&header, sizeof(Header));
+    writeBlock(output, offsets.ptr(), offsets.size() * sizeof(long long));
+    output.flush();
+}
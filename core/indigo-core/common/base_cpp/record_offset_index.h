@@ -0,0 +1,83 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#ifndef __record_offset_index__
+#define __record_offset_index__
+
+#include <memory>
+
+#include "base_cpp/array.h"
+#include "base_cpp/exception.h"
+#include "base_cpp/io_base.h"
+#include "base_cpp/non_copyable.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+namespace indigo
+{
+
+    class MappedFileScanner;
+    class Output;
+    class Scanner;
+
+    // Offsets of the records of a multi-record file (SDF, RDF) stored in a
+    // sidecar file. The index file is memory-mapped when possible. The length,
+    // the modification time and the checksum of the head and the tail of the
+    // source are stored in the index, and an index that does not match its
+    // source or has out-of-range offsets is not loaded.
+    class DLLEXPORT RecordOffsetIndex : public NonCopyable
+    {
+    public:
+        RecordOffsetIndex();
+        ~RecordOffsetIndex();
+
+        // Returns false if the index file is missing, malformed or built for another source.
+        // source_mtime is the modification time of the source, see fileModificationTime()
+        bool load(Encoding filename_encoding, const char* filename, Scanner& source, long long source_mtime);
+        void clear();
+
+        int count() const;
+        // Position of the record; offset(count()) is the end of the last record
+        long long offset(int index) const;
+
+        // offsets has one more element than the number of records
+        static void save(Output& output, Scanner& source, long long source_mtime, const Array<long long>& offsets);
+
+        DECL_ERROR;
+
+    private:
+        static dword _checksum(Scanner& source, long long& length);
+        bool _isValid(long long source_length) const;
+
+        std::unique_ptr<MappedFileScanner> _file;
+        Array<char> _buffer;
+
+        int _count;
+        const long long* _offsets;
+    };
+
+} // namespace indigo
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
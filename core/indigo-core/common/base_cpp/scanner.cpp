@@ -30,6 +30,16 @@
 
 #include <limits>
 
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#undef min
+#undef max
+#elif !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 using namespace indigo;
 
 enum
@@ -527,7 +537,12 @@ bool Scanner::isSingleLine(Scanner& scanner)
 
 FileScanner::FileScanner(Encoding filename_encoding, const char* filename)
 {
-    _init(filename_encoding, filename);
+    _init(filename_encoding, filename, 1024);
+}
+
+FileScanner::FileScanner(Encoding filename_encoding, const char* filename, int cache_size)
+{
+    _init(filename_encoding, filename, cache_size);
 }
 
 FileScanner::FileScanner(const char* format, ...)
@@ -540,22 +555,35 @@ FileScanner::FileScanner(const char* format, ...)
     vsnprintf(filename, sizeof(filename), format, args);
     va_end(args);
 
-    _init(ENCODING_ASCII, filename);
+    _init(ENCODING_ASCII, filename, 1024);
+}
+
+FileScanner::FileScanner(FILE* file, int cache_size)
+{
+    _initFile(file, cache_size);
 }
 
-void FileScanner::_init(Encoding filename_encoding, const char* filename)
+void FileScanner::_init(Encoding filename_encoding, const char* filename, int cache_size)
 {
     _file = 0;
-    _file_len = 0LL;
 
     if (filename == 0)
         throw Error("null filename");
 
-    _file = openFile(filename_encoding, filename, "rb");
+    FILE* file = openFile(filename_encoding, filename, "rb");
 
-    if (_file == NULL)
+    if (file == NULL)
         throw Error("can't open file %s. Error: %s", filename, strerror(errno));
 
+    _initFile(file, cache_size);
+}
+
+void FileScanner::_initFile(FILE* file, int cache_size)
+{
+    _file = file;
+    _file_len = 0LL;
+    _cache.clear_resize(std::max(cache_size, 16));
+
 #ifdef _WIN32
     _fseeki64(_file, 0LL, SEEK_END);
     _file_len = _ftelli64(_file);
@@ -574,7 +602,7 @@ int FileScanner::lookNext()
     if (_cache_pos == _max_cache)
         return -1;
 
-    return _cache[_cache_pos];
+    return _cache.ptr()[_cache_pos];
 }
 
 void FileScanner::_invalidateCache()
@@ -588,7 +616,7 @@ void FileScanner::_validateCache()
     if (_cache_pos < _max_cache)
         return;
 
-    size_t nread = fread(_cache, 1, NELEM(_cache), _file);
+    size_t nread = fread(_cache.ptr(), 1, _cache.size(), _file);
     _max_cache = static_cast<int>(nread);
     _cache_pos = 0;
 }
@@ -606,7 +634,7 @@ long long FileScanner::tell()
 void FileScanner::read(int length, void* res)
 {
     int to_read_from_cache = std::min(length, _max_cache - _cache_pos);
-    memcpy(res, _cache + _cache_pos, to_read_from_cache);
+    memcpy(res, _cache.ptr() + _cache_pos, to_read_from_cache);
     _cache_pos += to_read_from_cache;
 
     if (to_read_from_cache != length)
@@ -675,7 +703,7 @@ char FileScanner::readChar()
     _validateCache();
     if (_cache_pos == _max_cache)
         throw Error("readChar() passes after end of file");
-    return _cache[_cache_pos++];
+    return _cache.ptr()[_cache_pos++];
 }
 
 FileScanner::~FileScanner()
@@ -684,6 +712,226 @@ FileScanner::~FileScanner()
         fclose(_file);
 }
 
+//
+// MappedFileScanner
+//
+
+MappedFileScanner::MappedFileScanner(Encoding filename_encoding, const char* filename, int fallback_cache_size) : _data(0), _size(0), _offset(0)
+{
+#ifdef _WIN32
+    _h_map_file = 0;
+#endif
+
+    if (filename == 0)
+        throw Error("null filename");
+
+    FILE* file = openFile(filename_encoding, filename, "rb");
+
+    if (file == NULL)
+        throw Error("can't open file %s. Error: %s", filename, strerror(errno));
+
+    // The file is opened only once: pipes and devices can not be reopened
+    if (_map(file))
+    {
+        fclose(file);
+        return;
+    }
+
+    try
+    {
+        _fallback = std::make_unique<FileScanner>(file, fallback_cache_size);
+    }
+    catch (...)
+    {
+        fclose(file);
+        throw;
+    }
+}
+
+bool MappedFileScanner::_map(FILE* file)
+{
+#if defined(_WIN32)
+    HANDLE h_file = (HANDLE)_get_osfhandle(_fileno(file));
+    LARGE_INTEGER file_size;
+
+    if (h_file == INVALID_HANDLE_VALUE || GetFileType(h_file) != FILE_TYPE_DISK || !GetFileSizeEx(h_file, &file_size))
+        return false;
+
+    _size = file_size.QuadPart;
+    if (_size == 0)
+        return true;
+    if ((unsigned long long)_size > (size_t)-1)
+        return false;
+
+    _h_map_file = CreateFileMapping(h_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (_h_map_file == NULL)
+        return false;
+
+    _data = (const char*)MapViewOfFile(_h_map_file, FILE_MAP_READ, 0, 0, 0);
+    if (_data == NULL)
+    {
+        CloseHandle(_h_map_file);
+        _h_map_file = 0;
+        return false;
+    }
+    return true;
+#elif !defined(__EMSCRIPTEN__)
+    struct stat file_stat;
+    int fd = fileno(file);
+
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode))
+        return false;
+
+    _size = file_stat.st_size;
+    if (_size == 0)
+        return true;
+    if ((unsigned long long)_size > (size_t)-1)
+        return false;
+
+    void* data = mmap(NULL, (size_t)_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+
+#ifdef MADV_SEQUENTIAL
+    madvise(data, (size_t)_size, MADV_SEQUENTIAL);
+#endif
+    _data = (const char*)data;
+    return true;
+#else
+    return false;
+#endif
+}
+
+MappedFileScanner::~MappedFileScanner()
+{
+    if (_data == 0)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(_data);
+    CloseHandle(_h_map_file);
+#elif !defined(__EMSCRIPTEN__)
+    munmap((void*)_data, (size_t)_size);
+#endif
+}
+
+bool MappedFileScanner::isMapped() const
+{
+    return !_fallback;
+}
+
+const char* MappedFileScanner::data() const
+{
+    return _data;
+}
+
+void MappedFileScanner::read(int length, void* res)
+{
+    if (_fallback)
+        return _fallback->read(length, res);
+
+    if (length < 0 || _offset + length > _size)
+        throw Error("MappedFileScanner::read() error");
+
+    memcpy(res, _data + _offset, length);
+    _offset += length;
+}
+
+bool MappedFileScanner::isEOF()
+{
+    if (_fallback)
+        return _fallback->isEOF();
+
+    return _offset >= _size;
+}
+
+void MappedFileScanner::skip(int n)
+{
+    if (_fallback)
+        return _fallback->skip(n);
+
+    _offset += n;
+
+    if (_offset > _size)
+        throw Error("skip() passes after end of file");
+}
+
+int MappedFileScanner::lookNext()
+{
+    if (_fallback)
+        return _fallback->lookNext();
+
+    if (_offset >= _size)
+        return -1;
+
+    return (unsigned char)_data[_offset];
+}
+
+void MappedFileScanner::seek(long long pos, int from)
+{
+    if (_fallback)
+        return _fallback->seek(pos, from);
+
+    if (from == SEEK_SET)
+        _offset = pos;
+    else if (from == SEEK_CUR)
+        _offset += pos;
+    else // SEEK_END
+        _offset = _size - pos;
+
+    if (_offset > _size || _offset < 0)
+        throw Error("size = %lld, offset = %lld after seek()", _size, _offset);
+}
+
+long long MappedFileScanner::length()
+{
+    if (_fallback)
+        return _fallback->length();
+
+    return _size;
+}
+
+long long MappedFileScanner::tell()
+{
+    if (_fallback)
+        return _fallback->tell();
+
+    return _offset;
+}
+
+byte MappedFileScanner::readByte()
+{
+    if (_fallback)
+        return _fallback->readByte();
+
+    if (_offset >= _size)
+        throw Error("readByte(): end of file");
+
+    return _data[_offset++];
+}
+
+char MappedFileScanner::readChar()
+{
+    if (_fallback)
+        return _fallback->readChar();
+
+    if (_offset >= _size)
+        throw Error("readChar() passes after end of file");
+
+    return _data[_offset++];
+}
+
+void MappedFileScanner::readAll(Array<char>& arr)
+{
+    if (_fallback)
+        return _fallback->readAll(arr);
+
+    if (_size - _offset > std::numeric_limits<int>::max())
+        throw Error("file is too big to read into a buffer");
+
+    arr.copy(_data + _offset, (int)(_size - _offset));
+    _offset = _size;
+}
+
 //
 // BufferScanner
 //
@@ -23,6 +23,7 @@
 #include "base_cpp/io_base.h"
 #include "base_cpp/obj_array.h"
 #include "base_cpp/reusable_obj_array.h"
+#include <memory>
 #include <stdio.h>
 
 namespace indigo
@@ -93,7 +94,10 @@ namespace indigo
     {
     public:
         FileScanner(Encoding filename_encoding, const char* filename);
+        FileScanner(Encoding filename_encoding, const char* filename, int cache_size);
         explicit FileScanner(const char* format, ...);
+        // Takes the ownership of an open file
+        FileScanner(FILE* file, int cache_size);
         ~FileScanner() override;
 
         void read(int length, void* res) override;
@@ -110,17 +114,61 @@ namespace indigo
         FILE* _file;
         long long _file_len;
 
-        unsigned char _cache[1024];
+        Array<unsigned char> _cache;
         int _cache_pos, _max_cache;
 
         void _validateCache();
         void _invalidateCache();
-        void _init(Encoding filename_encoding, const char* filename);
+        void _init(Encoding filename_encoding, const char* filename, int cache_size);
+        void _initFile(FILE* file, int cache_size);
 
         // no implicit copy
         FileScanner(const FileScanner&);
     };
 
+    // Scanner over a memory-mapped regular file: all the reads are plain memory
+    // accesses and seeks are free. Files that can not be mapped (pipes, devices,
+    // platforms without mmap) are read through a FileScanner with the given
+    // read-ahead buffer size.
+    class DLLEXPORT MappedFileScanner : public Scanner
+    {
+    public:
+        MappedFileScanner(Encoding filename_encoding, const char* filename, int fallback_cache_size = 65536);
+        ~MappedFileScanner() override;
+
+        void read(int length, void* res) override;
+        bool isEOF() override;
+        void skip(int n) override;
+        int lookNext() override;
+        void seek(long long pos, int from) override;
+        long long length() override;
+        long long tell() override;
+
+        byte readByte() override;
+        char readChar() override;
+        void readAll(Array<char>& arr) override;
+
+        bool isMapped() const;
+        // Contents of the mapped file, or null if the file is not mapped
+        const char* data() const;
+
+    private:
+        const char* _data;
+        long long _size;
+        long long _offset;
+
+#ifdef _WIN32
+        void* _h_map_file;
+#endif
+
+        std::unique_ptr<FileScanner> _fallback;
+
+        bool _map(FILE* file);
+
+        // no implicit copy
+        MappedFileScanner(const MappedFileScanner&);
+    };
+
     class DLLEXPORT BufferScanner : public Scanner
     {
     public:
@@ -19,6 +19,7 @@
 #ifndef __tlscont_h__
 #define __tlscont_h__
 
+#include <atomic>
 #include <memory>
 #include <typeinfo>
 #include <unordered_map>
@@ -80,9 +81,18 @@ namespace indigo
 #define TL_RELEASE_SESSION_ID(id) _SIDManager::getInst().releaseSessionId(id)
 
     // Container that keeps one instance of specified type per session
+    //
+    // Each thread caches the copies it has looked up, so the shared map and
+    // its lock are used only when a thread switches to another session. Every
+    // container state has a unique version; removing a copy changes the version
+    // and thereby invalidates the cached entries of all threads.
     template <typename T> class _SessionLocalContainer
     {
     public:
+        _SessionLocalContainer() : _version(_nextVersion())
+        {
+        }
+
         T& getLocalCopy()
         {
             return getLocalCopy(TL_GET_SESSION_ID());
@@ -90,12 +100,22 @@ namespace indigo
 
         T& getLocalCopy(const qword id)
         {
+            qword version = _version.load(std::memory_order_acquire);
+            _CacheEntry& entry = _cache()[(version ^ id) % _cache_size];
+            if (entry.version == version && entry.id == id)
+                return *entry.copy;
+
             OsLocker locker(_lock.ref());
-            if (!_map.count(id))
-            {
-                _map[id] = std::unique_ptr<T>(new T());
-            }
-            return *_map.at(id);
+            std::unique_ptr<T>& copy = _map[id];
+            if (!copy)
+                copy.reset(new T());
+
+            version = _version.load(std::memory_order_relaxed);
+            _CacheEntry& new_entry = _cache()[(version ^ id) % _cache_size];
+            new_entry.version = version;
+            new_entry.id = id;
+            new_entry.copy = copy.get();
+            return *copy;
         }
 
         void removeLocalCopy()
@@ -108,6 +128,7 @@ namespace indigo
             OsLocker locker(_lock.ref());
             if (_map.count(id))
             {
+                _version.store(_nextVersion(), std::memory_order_release);
                 _map.erase(id);
             }
         }
@@ -115,8 +136,31 @@ namespace indigo
     private:
         using _Map = std::unordered_map<qword, std::unique_ptr<T>>;
 
+        struct _CacheEntry
+        {
+            qword version;
+            qword id;
+            T* copy;
+        };
+
+        static const int _cache_size = 8;
+
+        // Shared by all the containers of type T, entries are distinguished by version
+        static _CacheEntry* _cache()
+        {
+            static thread_local _CacheEntry cache[_cache_size];
+            return cache;
+        }
+
+        static qword _nextVersion()
+        {
+            static std::atomic<qword> next_version(1);
+            return next_version++;
+        }
+
         _Map _map;
         ThreadSafeStaticObj<OsLock> _lock;
+        std::atomic<qword> _version;
     };
 
     // Helpful templates to deal with commas in template type names
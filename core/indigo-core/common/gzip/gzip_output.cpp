@@ -18,13 +18,58 @@
 
 #include "gzip/gzip_output.h"
 
+#include <algorithm>
+#include <string.h>
+
 using namespace indigo;
 
 IMPL_ERROR(GZipOutput, "GZip output");
 
 CP_DEF(GZipOutput);
 
-GZipOutput::GZipOutput(Output& dest, int level) : _dest(dest), CP_INIT, TL_CP_GET(_outbuf), TL_CP_GET(_inbuf)
+namespace
+{
+    const int BGZF_HEADER_SIZE = 18;
+    const int BGZF_FOOTER_SIZE = 8;
+    const int BGZF_MAX_MEMBER_SIZE = 65536;
+
+    // Empty member that marks the end of a BGZF file
+    const Bytef BGZF_EOF[28] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 0x1b, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    void writeLE(Bytef* p, uLong value)
+    {
+        for (int i = 0; i < 4; i++)
+            p[i] = (Bytef)(value >> (8 * i));
+    }
+}
+
+GZipOutput::GZipOutput(Output& dest, int level) : GZipOutput(dest, level, 0)
+{
+}
+
+GZipOutput::GZipOutput(Output& dest, int level, int threads) : _dest(dest), CP_INIT, TL_CP_GET(_outbuf), TL_CP_GET(_inbuf)
+{
+    _level = level;
+    _threads = threads;
+    _total_written = 0;
+    _stop = false;
+
+#ifdef __EMSCRIPTEN__
+    _threads = 1;
+#endif
+
+    if (_threads > 1)
+    {
+        _block_input.reserve(BGZF_BLOCK_SIZE);
+        for (int i = 0; i < _threads; i++)
+            _workers.emplace_back(&GZipOutput::_workThread, this);
+        return;
+    }
+
+    _init(level);
+}
+
+void GZipOutput::_init(int level)
 {
     _zstream.zalloc = Z_NULL;
     _zstream.zfree = Z_NULL;
@@ -45,11 +90,30 @@ GZipOutput::GZipOutput(Output& dest, int level) : _dest(dest), CP_INIT, TL_CP_GE
 
     _outbuf.clear_resize(CHUNK_SIZE);
     _inbuf.clear_resize(CHUNK_SIZE);
-    _total_written = 0;
 }
 
 GZipOutput::~GZipOutput()
 {
+    if (_threads > 1)
+    {
+        try
+        {
+            _finishBlocks();
+        }
+        catch (...)
+        {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _work_cond.notify_all();
+        for (auto& worker : _workers)
+            worker.join();
+        return;
+    }
+
     _zstream.avail_in = 0;
     _zstream.next_in = Z_NULL;
 
@@ -66,6 +130,23 @@ void GZipOutput::write(const void* data, int size)
     if (size < 1)
         return;
 
+    if (_threads > 1)
+    {
+        const Bytef* p = (const Bytef*)data;
+
+        while (size > 0)
+        {
+            int n = std::min(size, (int)(BGZF_BLOCK_SIZE - _block_input.size()));
+
+            _block_input.insert(_block_input.end(), p, p + n);
+            p += n;
+            size -= n;
+            if (_block_input.size() == BGZF_BLOCK_SIZE)
+                _submitBlock();
+        }
+        return;
+    }
+
     _zstream.avail_in = size;
     _zstream.next_in = (Bytef*)data;
 
@@ -80,6 +161,14 @@ void GZipOutput::write(const void* data, int size)
 
 void GZipOutput::flush()
 {
+    if (_threads > 1)
+    {
+        _submitBlock();
+        _writeBlocks(true);
+        _dest.flush();
+        return;
+    }
+
     _zstream.avail_in = 0;
     _zstream.next_in = Z_NULL;
     _deflate(Z_FULL_FLUSH);
@@ -122,3 +211,161 @@ void GZipOutput::seek(long long offset, int from)
 {
     throw Error("not imlemented");
 }
+
+void GZipOutput::_submitBlock()
+{
+    if (_block_input.empty())
+        return;
+
+    auto block = std::make_unique<_Block>();
+    block->input.swap(_block_input);
+    _block_input.reserve(BGZF_BLOCK_SIZE);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _work.push_back(block.get());
+        _blocks.push_back(std::move(block));
+    }
+    _work_cond.notify_one();
+
+    _writeBlocks(false);
+}
+
+void GZipOutput::_writeBlocks(bool all)
+{
+    // Blocks are written in order on the calling thread; without "all" only
+    // the ready ones, unless too many blocks are waiting
+    while (true)
+    {
+        std::unique_ptr<_Block> block;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_blocks.empty())
+                return;
+            if (!_blocks.front()->done)
+            {
+                if (!all && _blocks.size() <= (size_t)_threads * 4)
+                    return;
+                _done_cond.wait(lock, [this]() { return _blocks.front()->done; });
+            }
+            block = std::move(_blocks.front());
+            _blocks.pop_front();
+        }
+
+        if (block->error)
+            std::rethrow_exception(block->error);
+        _dest.write(block->output.data(), (int)block->output.size());
+        _total_written += block->output.size();
+    }
+}
+
+void GZipOutput::_finishBlocks()
+{
+    _submitBlock();
+    _writeBlocks(true);
+    _dest.write(BGZF_EOF, sizeof(BGZF_EOF));
+    _total_written += sizeof(BGZF_EOF);
+    _dest.flush();
+}
+
+void GZipOutput::_workThread()
+{
+    z_stream zstream;
+    bool zstream_init = false;
+
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+
+    while (true)
+    {
+        _Block* block;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_cond.wait(lock, [this]() { return _stop || !_work.empty(); });
+            if (_stop)
+                break;
+            block = _work.front();
+            _work.pop_front();
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            if (!zstream_init)
+            {
+                int rc = deflateInit2(&zstream, _level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+                if (rc != Z_OK)
+                    throw Error("unknown zlib error code: %d", rc);
+                zstream_init = true;
+            }
+            _compressBlock(zstream, *block);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            block->error = error;
+            block->done = true;
+        }
+        _done_cond.notify_all();
+    }
+
+    if (zstream_init)
+        deflateEnd(&zstream);
+}
+
+void GZipOutput::_compressBlock(z_stream& zstream, _Block& block)
+{
+    static const Bytef header[16] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0};
+    std::vector<Bytef>& input = block.input;
+    std::vector<Bytef>& output = block.output;
+    size_t bound = std::max((size_t)deflateBound(&zstream, (uLong)input.size()), input.size() + 5);
+
+    output.resize(BGZF_HEADER_SIZE + bound + BGZF_FOOTER_SIZE);
+
+    deflateReset(&zstream);
+    zstream.next_in = input.data();
+    zstream.avail_in = (uInt)input.size();
+    zstream.next_out = output.data() + BGZF_HEADER_SIZE;
+    zstream.avail_out = (uInt)bound;
+
+    int rc = deflate(&zstream, Z_FINISH);
+    if (rc != Z_STREAM_END)
+        throw Error("unexpected zlib error (%d)", rc);
+
+    size_t compressed = zstream.total_out;
+
+    if (BGZF_HEADER_SIZE + compressed + BGZF_FOOTER_SIZE > BGZF_MAX_MEMBER_SIZE)
+    {
+        // Incompressible data is saved as a single stored deflate block
+        Bytef* p = output.data() + BGZF_HEADER_SIZE;
+        size_t len = input.size();
+
+        p[0] = 1;
+        p[1] = (Bytef)len;
+        p[2] = (Bytef)(len >> 8);
+        p[3] = (Bytef)~len;
+        p[4] = (Bytef)(~len >> 8);
+        memcpy(p + 5, input.data(), len);
+        compressed = len + 5;
+    }
+
+    size_t total = BGZF_HEADER_SIZE + compressed + BGZF_FOOTER_SIZE;
+
+    memcpy(output.data(), header, sizeof(header));
+    output[16] = (Bytef)(total - 1);
+    output[17] = (Bytef)((total - 1) >> 8);
+
+    Bytef* footer = output.data() + BGZF_HEADER_SIZE + compressed;
+    writeLE(footer, crc32(crc32(0L, Z_NULL, 0), input.data(), (uInt)input.size()));
+    writeLE(footer + 4, (uLong)input.size());
+
+    output.resize(total);
+    std::vector<Bytef>().swap(input);
+}
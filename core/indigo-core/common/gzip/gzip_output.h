@@ -22,6 +22,14 @@
 #include "base_cpp/output.h"
 #include "base_cpp/tlscont.h"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <zlib.h>
 
 namespace indigo
@@ -32,10 +40,16 @@ namespace indigo
     public:
         enum
         {
-            CHUNK_SIZE = 32768
+            CHUNK_SIZE = 32768,
+            BGZF_BLOCK_SIZE = 65280
         };
 
         explicit GZipOutput(Output& dest, int level);
+        // With more than one thread the data is split into blocks of up to
+        // BGZF_BLOCK_SIZE bytes that are compressed in parallel. The result is
+        // a BGZF file: every gzip reader accepts it, and GZipScanner inflates
+        // it in parallel too.
+        GZipOutput(Output& dest, int level, int threads);
         ~GZipOutput() override;
 
         void write(const void* data, int size) override;
@@ -48,13 +62,40 @@ namespace indigo
     protected:
         Output& _dest;
         z_stream _zstream;
-        int _total_written;
+        long long _total_written;
 
         int _deflate(int flush);
 
         CP_DECL;
         TL_CP_DECL(Array<Bytef>, _outbuf);
         TL_CP_DECL(Array<Bytef>, _inbuf);
+
+        // Block mode
+        struct _Block
+        {
+            std::vector<Bytef> input;
+            std::vector<Bytef> output;
+            bool done = false;
+            std::exception_ptr error;
+        };
+
+        int _level;
+        int _threads;
+        std::vector<Bytef> _block_input;
+
+        std::mutex _mutex;
+        std::condition_variable _work_cond, _done_cond;
+        std::deque<std::unique_ptr<_Block>> _blocks;
+        std::deque<_Block*> _work;
+        bool _stop;
+        std::vector<std::thread> _workers;
+
+        void _init(int level);
+        void _submitBlock();
+        void _writeBlocks(bool all);
+        void _finishBlocks();
+        void _workThread();
+        static void _compressBlock(z_stream& zstream, _Block& block);
     };
 
 } // namespace indigo
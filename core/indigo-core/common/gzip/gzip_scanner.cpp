@@ -16,172 +16,553 @@
  * limitations under the License.
  ***************************************************************************/
 
+
 #include "gzip/gzip_scanner.h"
+
 #include <algorithm>
+#include <string.h>
 
 using namespace indigo;
 
 IMPL_ERROR(GZipScanner, "GZip scanner");
 
-CP_DEF(GZipScanner);
+namespace
+{
+    // Inflated size of a block of the sequential stream
+    const size_t BLOCK_SIZE = 1 << 20;
+    // BGZF members are up to 64 KB, so this gives blocks of about the same size
+    const int MEMBERS_PER_BLOCK = 16;
+    // Largest inflated size of a BGZF member
+    const size_t BGZF_MAX_ISIZE = 1 << 16;
+    // Blocks inflated by the reader itself before the background threads
+    // start, so that short inputs never start a thread
+    const int SYNC_BLOCKS = 2;
+    const int MAX_THREADS = 8;
+
+    void initZStream(z_stream& zstream)
+    {
+        zstream.zalloc = Z_NULL;
+        zstream.zfree = Z_NULL;
+        zstream.opaque = Z_NULL;
+        zstream.avail_in = 0;
+        zstream.next_in = Z_NULL;
+
+        int rc = inflateInit2(&zstream, 16 + MAX_WBITS);
+
+        if (rc == Z_VERSION_ERROR)
+            throw GZipScanner::Error("zlib version incompatible");
+        if (rc == Z_MEM_ERROR)
+            throw GZipScanner::Error("not enough memory for zlib");
+        if (rc != Z_OK)
+            throw GZipScanner::Error("unknown zlib error code: %d", rc);
+    }
+
+    // Compressed size of a BGZF member from the "BC" extra subfield, or -1
+    int bgzfMemberSize(const Bytef* header, size_t available)
+    {
+        if (available < 12 || header[0] != 0x1f || header[1] != 0x8b || header[2] != 8 || (header[3] & 4) == 0)
+            return -1;
+
+        size_t xlen = header[10] | (header[11] << 8);
+        if (available < 12 + xlen)
+            return -1;
+
+        for (size_t i = 12; i + 4 <= 12 + xlen;)
+        {
+            size_t slen = header[i + 2] | (header[i + 3] << 8);
+            if (header[i] == 'B' && header[i + 1] == 'C' && slen == 2 && i + 6 <= 12 + xlen)
+                return (header[i + 4] | (header[i + 5] << 8)) + 1;
+            i += 4 + slen;
+        }
+        return -1;
+    }
+}
+
+GZipScanner::GZipScanner(Scanner& source, int threads) : _source(source)
+{
+    // Unknown source length means reading it byte by byte
+    try
+    {
+        _source_left = _source.length() - _source.tell();
+    }
+    catch (Exception&)
+    {
+        _source_left = -1;
+    }
+
+    initZStream(_zstream);
+    _member_zstream_init = false;
+    _sequential = false;
+    _input_end = false;
+    _members_seen = false;
+
+    _pos = 0;
+    _consumed = 0;
+    _eof = false;
+    _blocks_read = 0;
+
+#ifdef __EMSCRIPTEN__
+    _threads = 1;
+#else
+    _threads = threads < 0 ? std::min((int)std::thread::hardware_concurrency(), MAX_THREADS) : threads;
+#endif
+    _capacity = 0;
+    _finished = false;
+    _stop = false;
+}
 
-GZipScanner::GZipScanner(Scanner& source) : _source(source), CP_INIT, TL_CP_GET(_inbuf), TL_CP_GET(_outbuf)
+GZipScanner::~GZipScanner()
 {
-    _zstream.zalloc = Z_NULL;
-    _zstream.zfree = Z_NULL;
-    _zstream.opaque = Z_NULL;
-    _zstream.avail_in = 0;
-    _zstream.next_in = Z_NULL;
+    _stopThreads();
 
-    int rc = inflateInit2(&_zstream, 16 + MAX_WBITS);
+    inflateEnd(&_zstream);
+    if (_member_zstream_init)
+        inflateEnd(&_member_zstream);
+}
 
-    if (rc == Z_VERSION_ERROR)
-        throw Error("zlib version incompatible");
+void GZipScanner::_checkRc(int rc)
+{
+    if (rc == Z_STREAM_ERROR)
+        throw Error("inconsistent stream structure");
+    if (rc == Z_NEED_DICT)
+        throw Error("need a dictionary");
     if (rc == Z_MEM_ERROR)
-        throw Error("not enough memory for zlib");
-    if (rc != Z_OK)
+        throw Error("not enough memory");
+    if (rc == Z_DATA_ERROR)
+        throw Error("corrupted input data");
+    if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR)
         throw Error("unknown zlib error code: %d", rc);
+}
 
-    _outbuf.clear_resize(CHUNK_SIZE);
-    _inbuf.clear_resize(CHUNK_SIZE);
-    _outbuf_start = 0;
-    _inbuf_end = 0;
-    _uncompressed_total = 0;
-    _eof = false;
+size_t GZipScanner::_readSource(Bytef* buf, size_t count)
+{
+    size_t n = std::min(count, _pending.size());
 
-    _zstream.avail_out = _outbuf.size();
-    _zstream.next_out = _outbuf.ptr();
+    if (n > 0)
+    {
+        memcpy(buf, _pending.data(), n);
+        _pending.erase(_pending.begin(), _pending.begin() + n);
+    }
+    return n + _readRaw(buf + n, count - n);
 }
 
-GZipScanner::~GZipScanner()
+size_t GZipScanner::_readRaw(Bytef* buf, size_t count)
 {
-    inflateEnd(&_zstream);
+    size_t n = 0;
+
+    if (_source_left >= 0)
+    {
+        n = (size_t)std::min((long long)count, _source_left);
+        if (n > 0)
+        {
+            _source.read((int)n, buf);
+            _source_left -= n;
+        }
+    }
+    else
+    {
+        while (n < count && !_source.isEOF())
+            buf[n++] = _source.readByte();
+    }
+    return n;
 }
 
-void GZipScanner::read(int length, void* res)
+bool GZipScanner::_peekSource(size_t count)
 {
-    if (res == 0)
-        throw Error("zero pointer given");
+    if (_pending.size() < count)
+    {
+        size_t have = _pending.size();
+        _pending.resize(count);
+        _pending.resize(have + _readRaw(_pending.data() + have, count - have));
+    }
+    return _pending.size() >= count;
+}
+
+std::unique_ptr<GZipScanner::_Block> GZipScanner::_split()
+{
+    if (_sequential)
+        return _inflateSequential();
+    if (_input_end)
+        return nullptr;
+
+    auto block = std::make_unique<_Block>();
 
-    if (_outbuf_start < _outbuf.size() - (int)_zstream.avail_out)
+    while ((int)block->members.size() < MEMBERS_PER_BLOCK)
     {
-        int n = std::min(length, CHUNK_SIZE - (int)_zstream.avail_out - _outbuf_start);
+        int size = -1;
+        bool magic = _peekSource(2) && _pending[0] == 0x1f && _pending[1] == 0x8b;
+
+        if (magic && _peekSource(12) && (_pending[3] & 4) != 0)
+        {
+            _peekSource(12 + (_pending[10] | (_pending[11] << 8)));
+            size = bgzfMemberSize(_pending.data(), _pending.size());
+        }
 
-        memcpy(res, _outbuf.ptr() + _outbuf_start, n);
-        _outbuf_start += n;
-        _uncompressed_total += n;
-        length -= n;
-        res = (char*)res + n;
+        if (size < 0)
+        {
+            // Data after the last member is ignored, as gzip does
+            if (_pending.empty() || (_members_seen && !magic))
+                _input_end = true;
+            else
+                _sequential = true;
+            break;
+        }
+
+        size_t offset = block->input.size();
+        block->input.resize(offset + size);
+        if (_readSource(block->input.data() + offset, size) != (size_t)size)
+            throw Error("end of file in source stream");
+        block->members.push_back(size);
+        _members_seen = true;
     }
 
-    if (!_read(length, res))
-        throw Error("end of compressed data");
+    if (block->members.empty())
+        return _sequential ? _inflateSequential() : nullptr;
+    return block;
 }
 
-bool GZipScanner::_read(int length, void* res)
+std::unique_ptr<GZipScanner::_Block> GZipScanner::_inflateSequential()
 {
-    while (length > 0)
+    if (_input_end)
+        return nullptr;
+
+    auto block = std::make_unique<_Block>();
+    size_t produced = 0;
+
+    block->output.resize(BLOCK_SIZE);
+    block->inflated = true;
+    _inbuf.resize(CHUNK_SIZE * 2);
+
+    while (produced < BLOCK_SIZE && !_input_end)
+    {
+        if (_zstream.avail_in == 0)
+        {
+            size_t n = _readSource(_inbuf.data(), _inbuf.size());
+            if (n == 0)
+                throw Error("end of file in source stream");
+            _zstream.next_in = _inbuf.data();
+            _zstream.avail_in = (uInt)n;
+        }
+
+        _zstream.next_out = block->output.data() + produced;
+        _zstream.avail_out = (uInt)(BLOCK_SIZE - produced);
+
+        int rc = inflate(&_zstream, Z_NO_FLUSH);
+        _checkRc(rc);
+        produced = BLOCK_SIZE - _zstream.avail_out;
+
+        if (rc == Z_STREAM_END)
+        {
+            // Put back the rest of the input and look for the next member
+            _members_seen = true;
+            _pending.insert(_pending.begin(), _zstream.next_in, _zstream.next_in + _zstream.avail_in);
+            _zstream.avail_in = 0;
+
+            if (_peekSource(2) && _pending[0] == 0x1f && _pending[1] == 0x8b)
+                inflateReset(&_zstream);
+            else
+                _input_end = true;
+        }
+    }
+
+    block->output.resize(produced);
+    return block;
+}
+
+void GZipScanner::_inflateMembers(z_stream& zstream, _Block& block)
+{
+    // Every member inflates to at most 64 KB, so the block never takes more
+    // than that per member whatever the trailers say
+    size_t offset = 0, total = 0;
+
+    block.output.resize(block.members.size() * BGZF_MAX_ISIZE);
+
+    for (int size : block.members)
+    {
+        if (size < 18)
+            throw Error("corrupted input data");
+
+        // ISIZE, the inflated size modulo 2^32, is the last field of a member
+        const Bytef* p = block.input.data() + offset + size - 4;
+        size_t isize = p[0] | (p[1] << 8) | (p[2] << 16) | ((size_t)p[3] << 24);
+        if (isize > BGZF_MAX_ISIZE)
+            throw Error("corrupted input data: BGZF member inflates to %u bytes", (unsigned)isize);
+
+        inflateReset(&zstream);
+        zstream.next_in = block.input.data() + offset;
+        zstream.avail_in = size;
+        zstream.next_out = block.output.data() + total;
+        zstream.avail_out = (uInt)BGZF_MAX_ISIZE;
+
+        int rc = inflate(&zstream, Z_FINISH);
+        _checkRc(rc);
+        if (rc != Z_STREAM_END || zstream.total_out != isize)
+            throw Error("corrupted input data");
+
+        offset += size;
+        total += isize;
+    }
+
+    block.output.resize(total);
+    std::vector<Bytef>().swap(block.input);
+}
+
+bool GZipScanner::_nextBlock()
+{
+    while (true)
     {
-        if (_eof)
+        std::unique_ptr<_Block> block;
+
+        if (_splitter.joinable())
+            block = _takeBlock();
+        else if (_blocks_read >= SYNC_BLOCKS && _threads > 1)
+        {
+            _startThreads();
+            continue;
+        }
+        else
+        {
+            block = _split();
+            if (block != nullptr && !block->inflated)
+            {
+                if (!_member_zstream_init)
+                {
+                    initZStream(_member_zstream);
+                    _member_zstream_init = true;
+                }
+                _inflateMembers(_member_zstream, *block);
+                block->inflated = true;
+            }
+        }
+
+        if (_current != nullptr)
+            _consumed += _current->output.size();
+        _current = std::move(block);
+        _pos = 0;
+
+        if (_current == nullptr)
+        {
+            _eof = true;
             return false;
+        }
+        _blocks_read++;
+        if (!_current->output.empty())
+            return true;
+    }
+}
 
-        if (_zstream.avail_in == 0)
+bool GZipScanner::_available()
+{
+    if (_current != nullptr && _pos < _current->output.size())
+        return true;
+    return !_eof && _nextBlock();
+}
+
+void GZipScanner::_startThreads()
+{
+    int workers = _sequential ? 0 : _threads - 1;
+
+    _capacity = _threads * 2;
+    _splitter = std::thread(&GZipScanner::_splitThread, this);
+    for (int i = 0; i < workers; i++)
+        _workers.emplace_back(&GZipScanner::_workThread, this);
+}
+
+void GZipScanner::_stopThreads()
+{
+    if (!_splitter.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _split_cond.notify_all();
+    _work_cond.notify_all();
+
+    _splitter.join();
+    for (auto& worker : _workers)
+        worker.join();
+    _workers.clear();
+}
+
+void GZipScanner::_splitThread()
+{
+    try
+    {
+        while (true)
         {
-            _inbuf_end = 0;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _split_cond.wait(lock, [this]() { return _stop || _queue.size() < _capacity; });
+                if (_stop)
+                    return;
+            }
 
-            if (_source.isEOF())
-                throw Error("end of file in source stream");
+            std::unique_ptr<_Block> block = _split();
 
-            do
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (block == nullptr)
+            {
+                _finished = true;
+                break;
+            }
+
+            _Block* raw = block.get();
+            _queue.push_back(std::move(block));
+            if (raw->inflated)
+                _read_cond.notify_one();
+            else
             {
-                _inbuf[_inbuf_end++] = _source.readChar();
-            } while (!_source.isEOF() && _inbuf_end < _inbuf.size());
-            _zstream.avail_in = _inbuf_end;
-            _zstream.next_in = _inbuf.ptr();
+                _work.push_back(raw);
+                _work_cond.notify_one();
+            }
         }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _split_error = std::current_exception();
+        _finished = true;
+    }
 
-        _zstream.avail_out = _outbuf.size();
-        _zstream.next_out = _outbuf.ptr();
-        _outbuf_start = 0;
+    _read_cond.notify_one();
+    _work_cond.notify_all();
+}
 
-        int rc = inflate(&_zstream, Z_NO_FLUSH);
+void GZipScanner::_workThread()
+{
+    z_stream zstream;
+    bool zstream_init = false;
 
-        if (rc == Z_STREAM_ERROR)
-            throw Error("inconsistent stream structure");
+    while (true)
+    {
+        _Block* block;
 
-        if (rc == Z_NEED_DICT)
         {
-            inflateEnd(&_zstream);
-            throw Error("need a dictionary");
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_cond.wait(lock, [this]() { return _stop || _finished || !_work.empty(); });
+            if (_stop || _work.empty())
+                break;
+            block = _work.front();
+            _work.pop_front();
         }
 
-        if (rc == Z_MEM_ERROR)
+        std::exception_ptr error;
+        try
         {
-            inflateEnd(&_zstream);
-            throw Error("not enough memory");
+            if (!zstream_init)
+            {
+                initZStream(zstream);
+                zstream_init = true;
+            }
+            _inflateMembers(zstream, *block);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
         }
 
-        if (rc == Z_DATA_ERROR)
         {
-            inflateEnd(&_zstream);
-            throw Error("corrupted input data");
+            std::lock_guard<std::mutex> lock(_mutex);
+            block->error = error;
+            block->inflated = true;
         }
+        _read_cond.notify_one();
+    }
 
-        if (rc == Z_BUF_ERROR)
-            throw Error("Z_BUF_ERROR (workaround not implemented)");
+    if (zstream_init)
+        inflateEnd(&zstream);
+}
 
-        if (rc != Z_OK && rc != Z_STREAM_END)
-            throw Error("unknown zlib error code: %d", rc);
+std::unique_ptr<GZipScanner::_Block> GZipScanner::_takeBlock()
+{
+    std::unique_ptr<_Block> block;
 
-        int n = std::min(length, CHUNK_SIZE - (int)_zstream.avail_out - _outbuf_start);
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _read_cond.wait(lock, [this]() { return (!_queue.empty() && _queue.front()->inflated) || (_queue.empty() && _finished); });
 
-        if (n > 0 && res != 0)
+        if (_queue.empty())
         {
-            memcpy(res, _outbuf.ptr(), n);
-            _outbuf_start += n;
-            _uncompressed_total += n;
-            res = (char*)res + n;
+            if (_split_error)
+                std::rethrow_exception(_split_error);
+            return nullptr;
         }
+        block = std::move(_queue.front());
+        _queue.pop_front();
+    }
+    _split_cond.notify_one();
 
-        length -= n;
+    if (block->error)
+        std::rethrow_exception(block->error);
+    return block;
+}
 
-        if (rc == Z_STREAM_END)
-            _eof = true;
+void GZipScanner::read(int length, void* res)
+{
+    if (res == 0)
+        throw Error("zero pointer given");
+
+    char* out = (char*)res;
+
+    while (length > 0)
+    {
+        if (!_available())
+            throw Error("end of compressed data");
+
+        size_t n = std::min((size_t)length, _current->output.size() - _pos);
+        memcpy(out, _current->output.data() + _pos, n);
+        out += n;
+        _pos += n;
+        length -= (int)n;
     }
+}
 
-    return true;
+void GZipScanner::skip(int length)
+{
+    while (length > 0)
+    {
+        if (!_available())
+            throw Error("end of compressed data");
+
+        size_t n = std::min((size_t)length, _current->output.size() - _pos);
+        _pos += n;
+        length -= (int)n;
+    }
 }
 
-void GZipScanner::readAll(Array<char>& arr)
+byte GZipScanner::readByte()
 {
-    arr.clear();
+    if (!_available())
+        throw Error("end of compressed data");
+    return _current->output[_pos++];
+}
 
-    while (!isEOF())
-        arr.push(readByte());
+char GZipScanner::readChar()
+{
+    return (char)readByte();
 }
 
-void GZipScanner::skip(int length)
+void GZipScanner::readAll(Array<char>& arr)
 {
-    QS_DEF(Array<char>, dummy);
+    arr.clear();
 
-    dummy.clear_resize(length);
-    read(length, dummy.ptr());
+    while (_available())
+    {
+        arr.concat((const char*)_current->output.data() + _pos, (int)(_current->output.size() - _pos));
+        _pos = _current->output.size();
+    }
 }
 
 long long GZipScanner::tell()
 {
-    return _uncompressed_total;
+    return _consumed + _pos;
 }
 
 bool GZipScanner::isEOF()
 {
-    if ((unsigned)_outbuf_start + _zstream.avail_out == (unsigned)_outbuf.size())
-    {
-        if (_eof)
-            return true;
-        _read(1, 0);
-    }
-    return _eof && (unsigned)_outbuf_start + _zstream.avail_out == (unsigned)_outbuf.size();
+    return !_available();
 }
 
 void GZipScanner::seek(long long pos, int from)
@@ -191,21 +572,9 @@ void GZipScanner::seek(long long pos, int from)
 
 int GZipScanner::lookNext()
 {
-    if (_outbuf_start < _outbuf.size() - (int)_zstream.avail_out)
-        return _outbuf[_outbuf_start];
-
-    if (_eof)
+    if (!_available())
         return -1;
-
-    _read(1, 0);
-
-    if (_eof)
-        return -1;
-
-    if (_outbuf_start < _outbuf.size() - (int)_zstream.avail_out)
-        return _outbuf[_outbuf_start];
-
-    throw Error("internal");
+    return _current->output[_pos];
 }
 
 long long GZipScanner::length()
@@ -16,17 +16,31 @@
  * limitations under the License.
  ***************************************************************************/
 
+
 #ifndef __gzip_scanner__
 #define __gzip_scanner__
 
 #include "base_cpp/scanner.h"
-#include "base_cpp/tlscont.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <zlib.h>
 
 namespace indigo
 {
 
+    // Reads gzip data, including files of several concatenated members.
+    // Data is inflated in large blocks. When the caller allows more than one
+    // thread, after the first few blocks the input is inflated on a background
+    // thread ahead of the reader, and BGZF files (members that record their
+    // compressed size, as written by GZipOutput in the block mode, bgzip or
+    // samtools) are inflated by several threads.
     class GZipScanner : public Scanner
     {
     public:
@@ -35,7 +49,9 @@ namespace indigo
             CHUNK_SIZE = 32768
         };
 
-        explicit GZipScanner(Scanner& source);
+        // 0 or 1 means inflating on the reading thread only (the default),
+        // threads < 0 means the number of hardware threads (up to 8)
+        explicit GZipScanner(Scanner& source, int threads = 1);
         ~GZipScanner() override;
 
         void read(int length, void* res) override;
@@ -46,22 +62,71 @@ namespace indigo
         void skip(int length) override;
         long long length() override;
         void readAll(Array<char>& arr) override;
+        byte readByte() override;
+        char readChar() override;
 
         DECL_ERROR;
 
     protected:
+        // Inflated data of one or more members. BGZF members are collected
+        // by the reading thread and inflated later, possibly by a worker.
+        struct _Block
+        {
+            std::vector<Bytef> input;
+            std::vector<int> members;
+            std::vector<Bytef> output;
+            bool inflated = false;
+            std::exception_ptr error;
+        };
+
         Scanner& _source;
+        long long _source_left;
+
+        // Input splitting, done either by the reader or by the splitter thread
+        std::vector<Bytef> _pending;
+        std::vector<Bytef> _inbuf;
         z_stream _zstream;
+        z_stream _member_zstream;
+        bool _member_zstream_init;
+        bool _sequential;
+        bool _input_end;
+        bool _members_seen;
 
-        bool _read(int length, void* res);
+        std::unique_ptr<_Block> _split();
+        std::unique_ptr<_Block> _inflateSequential();
+        bool _peekSource(size_t count);
+        size_t _readSource(Bytef* buf, size_t count);
+        size_t _readRaw(Bytef* buf, size_t count);
+        static void _inflateMembers(z_stream& zstream, _Block& block);
+        static void _checkRc(int rc);
 
-        CP_DECL;
-        TL_CP_DECL(Array<Bytef>, _inbuf);
-        TL_CP_DECL(Array<Bytef>, _outbuf);
-        int _outbuf_start;
-        int _inbuf_end;
-        int _uncompressed_total;
+        // Reader
+        std::unique_ptr<_Block> _current;
+        size_t _pos;
+        long long _consumed;
         bool _eof;
+        int _blocks_read;
+
+        bool _nextBlock();
+        bool _available();
+
+        // Background decompression
+        int _threads;
+        std::mutex _mutex;
+        std::condition_variable _split_cond, _work_cond, _read_cond;
+        std::deque<std::unique_ptr<_Block>> _queue;
+        std::deque<_Block*> _work;
+        size_t _capacity;
+        bool _finished, _stop;
+        std::exception_ptr _split_error;
+        std::thread _splitter;
+        std::vector<std::thread> _workers;
+
+        void _startThreads();
+        void _stopThreads();
+        std::unique_ptr<_Block> _takeBlock();
+        void _splitThread();
+        void _workThread();
     };
 
 } // namespace indigo
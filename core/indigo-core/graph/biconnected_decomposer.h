@@ -19,7 +19,7 @@
 #ifndef __biconnected_decomposer_h__
 #define __biconnected_decomposer_h__
 
-#include "base_cpp/ptr_array.h"
+#include "base_cpp/reusable_obj_array.h"
 #include "base_cpp/tlscont.h"
 #include "graph/graph.h"
 
@@ -58,11 +58,12 @@ namespace indigo
 
         const Graph& _graph;
         CP_DECL;
-        TL_CP_DECL(PtrArray<Array<int>>, _components); // masks for components
+        // The arrays are reused by the next decompositions in the same thread
+        TL_CP_DECL(ReusableObjArray<Array<int>>, _components); // masks for components
         TL_CP_DECL(Array<int>, _dfs_order);
         TL_CP_DECL(Array<int>, _lowest_order);
-        TL_CP_DECL(PtrArray<Array<int>>, _component_lists);
-        TL_CP_DECL(Array<Array<int>*>, _component_ids); // list of components for articulation point
+        TL_CP_DECL(ReusableObjArray<Array<int>>, _component_lists);
+        TL_CP_DECL(Array<int>, _component_ids); // list of components for articulation point, -1 for other vertices
         TL_CP_DECL(Array<Edge>, _edges_stack);
         int _cur_order;
     };
@@ -18,12 +18,13 @@
 
 #ifndef _CYCLE_BASIS_H_
 #define _CYCLE_BASIS_H_
-#include "base_cpp/obj_array.h"
 #include "base_cpp/red_black.h"
+#include "base_cpp/reusable_obj_array.h"
 
 namespace indigo
 {
 
+    class Filter;
     class Graph;
 
     class CycleBasis
@@ -53,7 +54,9 @@ namespace indigo
     private:
         CycleBasis(const CycleBasis&); // no implicit copy
 
-        ObjArray<Array<int>> _cycles;
+        bool _addSimpleCycle(const Graph& graph, const Filter& filter, int vertex_count);
+
+        ReusableObjArray<Array<int>> _cycles;
 
         RedBlackSet<int> _cycleVertices;
     };
@@ -28,7 +28,7 @@
 #include "base_cpp/obj_array.h"
 #include "base_cpp/red_black.h"
 #include "base_cpp/tlscont.h"
-#include "graph/graph_fast_access.h"
+#include "graph/graph.h"
 
 namespace indigo
 {
@@ -115,9 +115,6 @@ namespace indigo
 
         TL_CP_DECL(Pool<RedBlackSet<int>::Node>, _s_pool);
 
-        TL_CP_DECL(GraphFastAccess, _g1_fast);
-        TL_CP_DECL(GraphFastAccess, _g2_fast);
-
         void _terminatePreviousMatch();
 
         //
@@ -19,6 +19,9 @@
 #ifndef __graph_h__
 #define __graph_h__
 
+#include <atomic>
+#include <mutex>
+
 #include "base_cpp/array.h"
 #include "base_cpp/list.h"
 #include "base_cpp/non_copyable.h"
@@ -123,6 +126,64 @@ namespace indigo
         }
     };
 
+    class Graph;
+
+    // Immutable compressed-sparse-row snapshot of the graph adjacency.
+    // Neighbors of every vertex are stored contiguously, in the same order
+    // as in Vertex::neighbors_list. Indices of vertices and edges are the
+    // same as in the graph; removed vertices have no neighbors.
+    class DLLEXPORT GraphCSR
+    {
+    public:
+        void build(const Graph& graph);
+
+        // Existing vertices in the graph order
+        const int* vertices() const
+        {
+            return _vertices.ptr();
+        }
+        int vertexCount() const
+        {
+            return _vertices.size();
+        }
+
+        int degree(int v) const
+        {
+            return _nei_offsets.ptr()[v + 1] - _nei_offsets.ptr()[v];
+        }
+        const int* neiVertices(int v) const
+        {
+            return _nei_vertices.ptr() + _nei_offsets.ptr()[v];
+        }
+        const int* neiEdges(int v) const
+        {
+            return _nei_edges.ptr() + _nei_offsets.ptr()[v];
+        }
+
+        const Edge& getEdge(int e) const
+        {
+            return _edges.ptr()[e];
+        }
+
+        int findEdgeIndex(int beg, int end) const
+        {
+            const int* nei_vertices = neiVertices(beg);
+            int count = degree(beg);
+
+            for (int i = 0; i < count; i++)
+                if (nei_vertices[i] == end)
+                    return neiEdges(beg)[i];
+            return -1;
+        }
+
+    private:
+        Array<int> _vertices;
+        Array<int> _nei_offsets;
+        Array<int> _nei_vertices;
+        Array<int> _nei_edges;
+        Array<Edge> _edges;
+    };
+
     class CycleBasis;
 
     class DLLEXPORT Graph : public NonCopyable
@@ -139,6 +200,10 @@ namespace indigo
 
         virtual void clear();
 
+        // Preallocates the storage for the given number of vertices and edges,
+        // so that building a graph of known size does not grow it step by step
+        virtual void reserve(int vertex_count, int edge_count);
+
         const Vertex& getVertex(int idx) const;
 
         const Edge& getEdge(int idx) const;
@@ -224,6 +289,17 @@ namespace indigo
         List<int>& sssrVertices(int idx);
         int sssrCount();
 
+        // Returns the adjacency snapshot, building it on the first call after
+        // the graph was modified. The reference stays valid for the lifetime
+        // of the graph, the contents until the next modification. Concurrent
+        // calls on an unmodified graph are safe: the snapshot is built once.
+        const GraphCSR& getCSR() const
+        {
+            if (!_csr_valid.load(std::memory_order_acquire))
+                _buildCSR();
+            return _csr;
+        }
+
         int vertexComponent(int v_idx);
         int countComponents();
         int countComponentVertices(int comp_idx);
@@ -253,6 +329,12 @@ namespace indigo
         bool _components_valid;
         int _components_count;
 
+        mutable GraphCSR _csr;
+        mutable std::atomic<bool> _csr_valid;
+        mutable std::mutex _csr_lock;
+
+        void _buildCSR() const;
+
         void _calculateTopology();
         void _calculateSSSR();
         void _calculateSSSRInit();
@@ -76,13 +76,16 @@ namespace indigo
     protected:
         struct StackElem
         {
-            const Vertex* vertex;
+            const int* nei_vertices;
+            const int* nei_edges;
+            int degree;
             int vertex_idx;
             int nei_idx;
             int parent_idx;
         };
 
         void _build();
+        void _pushVertex(int vertex_idx, int parent_idx);
 
         const Graph& _graph;
         const Filter* _vertex_filter;
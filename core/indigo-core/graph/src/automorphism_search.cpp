@@ -715,11 +715,13 @@ void AutomorphismSearch::_joinOrbits(const Array<int>& perm)
 
 bool AutomorphismSearch::_isAutomorphism(Array<int>& perm)
 {
+    const GraphCSR& csr = _graph.getCSR();
+
     for (int i = _graph.edgeBegin(); i != _graph.edgeEnd(); i = _graph.edgeNext(i))
     {
-        const Edge& edge = _graph.getEdge(i);
+        const Edge& edge = csr.getEdge(i);
 
-        if (!_graph.haveEdge(perm[edge.beg], perm[edge.end]))
+        if (csr.findEdgeIndex(perm[edge.beg], perm[edge.end]) == -1)
             return false;
     }
 
@@ -946,7 +948,7 @@ void AutomorphismSearch::_refineBySortingNeighbourhood(int level, int& numcells)
 
 bool AutomorphismSearch::_hasEdgeWithRank(int from, int to, int target_edge_rank)
 {
-    int edge_index = _graph.findEdgeIndex(from, to);
+    int edge_index = _graph.getCSR().findEdgeIndex(from, to);
 
     if (edge_index == -1)
         return false;
@@ -956,7 +958,7 @@ bool AutomorphismSearch::_hasEdgeWithRank(int from, int to, int target_edge_rank
 
     int mapped_v1 = _mapping[from];
     int mapped_v2 = _mapping[to];
-    int edge_index_mapped = _given_graph->findEdgeIndex(mapped_v1, mapped_v2);
+    int edge_index_mapped = _given_graph->getCSR().findEdgeIndex(mapped_v1, mapped_v2);
     if (edge_index_mapped == -1)
         throw Error("Internal error: edge must exists");
 
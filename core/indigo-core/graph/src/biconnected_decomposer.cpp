@@ -36,7 +36,7 @@ BiconnectedDecomposer::BiconnectedDecomposer(const Graph& graph)
     _dfs_order.zerofill();
     _lowest_order.clear_resize(graph.vertexEnd());
     _component_ids.clear_resize(graph.vertexEnd());
-    _component_ids.zerofill();
+    _component_ids.fill(-1);
 }
 
 BiconnectedDecomposer::~BiconnectedDecomposer()
@@ -85,12 +85,12 @@ int BiconnectedDecomposer::componentsCount()
 
 void BiconnectedDecomposer::getComponent(int idx, Filter& filter) const
 {
-    filter.init(_components[idx]->ptr(), Filter::EQ, 1);
+    filter.init(_components[idx].ptr(), Filter::EQ, 1);
 }
 
 bool BiconnectedDecomposer::isArticulationPoint(int idx) const
 {
-    return _component_ids[idx] != 0;
+    return _component_ids[idx] != -1;
 }
 
 const Array<int>& BiconnectedDecomposer::getIncomingComponents(int idx) const
@@ -98,7 +98,7 @@ const Array<int>& BiconnectedDecomposer::getIncomingComponents(int idx) const
     if (!isArticulationPoint(idx))
         throw Error("vertex %d is not articulation point");
 
-    return *_component_ids[idx];
+    return _component_lists[_component_ids[idx]];
 }
 
 void BiconnectedDecomposer::getVertexComponents(int idx, Array<int>& components) const
@@ -110,7 +110,7 @@ void BiconnectedDecomposer::getVertexComponents(int idx, Array<int>& components)
         components.clear();
 
         for (i = 0; i < _components.size(); i++)
-            if (_components[i]->at(idx) == 1)
+            if (_components[i].at(idx) == 1)
             {
                 components.push(i);
                 break;
@@ -127,7 +127,7 @@ int BiconnectedDecomposer::getIncomingCount(int idx) const
     if (!isArticulationPoint(idx))
         return 0;
 
-    return _component_ids[idx]->size();
+    return _component_lists[_component_ids[idx]].size();
 }
 
 bool BiconnectedDecomposer::_pushToStack(Array<int>& dfs_stack, int v)
@@ -183,26 +183,29 @@ void BiconnectedDecomposer::_processIfNotPushed(Array<int>& dfs_stack, int w)
     {
         // v -articulation point in G;
         // start new BCcomp;
-        Array<int>& new_comp = _components.add(new Array<int>());
+        Array<int>& new_comp = _components.push();
         new_comp.clear_resize(_graph.vertexEnd());
         new_comp.zerofill();
 
         int cur_comp = _components.size() - 1;
 
-        if (_component_ids[v] == 0)
-            _component_ids[v] = &_component_lists.add(new Array<int>());
+        if (_component_ids[v] == -1)
+        {
+            _component_lists.push();
+            _component_ids[v] = _component_lists.size() - 1;
+        }
 
-        _component_ids[v]->push(cur_comp);
+        _component_lists[_component_ids[v]].push(cur_comp);
 
         while (_dfs_order[_edges_stack.top().beg] >= _dfs_order[w])
         {
-            _components[cur_comp]->at(_edges_stack.top().beg) = 1;
-            _components[cur_comp]->at(_edges_stack.top().end) = 1;
+            new_comp[_edges_stack.top().beg] = 1;
+            new_comp[_edges_stack.top().end] = 1;
             _edges_stack.pop();
         }
 
-        _components[cur_comp]->at(v) = 1;
-        _components[cur_comp]->at(w) = 1;
+        new_comp[v] = 1;
+        new_comp[w] = 1;
         _edges_stack.pop();
     }
 }
@@ -19,6 +19,7 @@
 #include "graph/cycle_basis.h"
 #include "base_cpp/tlscont.h"
 #include "graph/biconnected_decomposer.h"
+#include "graph/filter.h"
 #include "graph/simple_cycle_basis.h"
 
 using namespace indigo;
@@ -42,6 +43,14 @@ void CycleBasis::create(const Graph& graph)
     {
         bic_dec.getComponent(i, filter);
 
+        // a component of two vertices is a bridge and has no cycles
+        int vertex_count = filter.count(graph);
+        if (vertex_count < 3)
+            continue;
+
+        if (_addSimpleCycle(graph, filter, vertex_count))
+            continue;
+
         // create subgraph and store mapping
         subgraph.makeSubgraph(graph, filter, &mapping_out, 0);
 
@@ -72,6 +81,58 @@ void CycleBasis::create(const Graph& graph)
     }
 }
 
+bool CycleBasis::_addSimpleCycle(const Graph& graph, const Filter& filter, int vertex_count)
+{
+    // A biconnected component with as many edges as vertices is a single cycle.
+    // The edges are added in the order SimpleCycleBasis gives for it: from the
+    // beginning of the edge with the smallest index around to its end, then the edge.
+    int edge_count = 0;
+    int first_edge = -1;
+
+    for (int v = graph.vertexBegin(); v < graph.vertexEnd(); v = graph.vertexNext(v))
+    {
+        if (!filter.valid(v))
+            continue;
+
+        const Vertex& vertex = graph.getVertex(v);
+        for (int j = vertex.neiBegin(); j < vertex.neiEnd(); j = vertex.neiNext(j))
+        {
+            if (!filter.valid(vertex.neiVertex(j)))
+                continue;
+            edge_count++;
+            if (first_edge == -1 || vertex.neiEdge(j) < first_edge)
+                first_edge = vertex.neiEdge(j);
+        }
+    }
+
+    if (edge_count != vertex_count * 2)
+        return false;
+
+    const Edge& edge = graph.getEdge(first_edge);
+    Array<int>& new_cycle = _cycles.push();
+    int cur = edge.beg;
+    int prev_edge = first_edge;
+
+    _cycleVertices.find_or_insert(cur);
+    while (cur != edge.end)
+    {
+        const Vertex& vertex = graph.getVertex(cur);
+        for (int j = vertex.neiBegin(); j < vertex.neiEnd(); j = vertex.neiNext(j))
+        {
+            if (vertex.neiEdge(j) != prev_edge && filter.valid(vertex.neiVertex(j)))
+            {
+                prev_edge = vertex.neiEdge(j);
+                cur = vertex.neiVertex(j);
+                break;
+            }
+        }
+        new_cycle.push(prev_edge);
+        _cycleVertices.find_or_insert(cur);
+    }
+    new_cycle.push(first_edge);
+    return true;
+}
+
 bool CycleBasis::containsVertex(int vertex) const
 {
     return _cycleVertices.find(vertex);
@@ -32,7 +32,7 @@ IMPL_TIMEOUT_EXCEPTION(EmbeddingEnumerator, "embedding enumerator");
 CP_DEF(EmbeddingEnumerator);
 
 EmbeddingEnumerator::EmbeddingEnumerator(Graph& supergraph)
-    : CP_INIT, TL_CP_GET(_core_1), TL_CP_GET(_core_2), TL_CP_GET(_term2), TL_CP_GET(_unterm2), TL_CP_GET(_s_pool), TL_CP_GET(_g1_fast), TL_CP_GET(_g2_fast),
+    : CP_INIT, TL_CP_GET(_core_1), TL_CP_GET(_core_2), TL_CP_GET(_term2), TL_CP_GET(_unterm2), TL_CP_GET(_s_pool),
       TL_CP_GET(_query_match_state), TL_CP_GET(_enumerators)
 {
     _g2 = &supergraph;
@@ -66,7 +66,6 @@ void EmbeddingEnumerator::validate()
 {
     // _core_2 must be preserved because there might be fixed vertices
     _core_2.expandFill(_g2->vertexEnd(), -1);
-    _g2_fast.setGraph(*_g2);
 }
 
 void EmbeddingEnumerator::setSubgraph(Graph& subgraph)
@@ -81,8 +80,6 @@ void EmbeddingEnumerator::setSubgraph(Graph& subgraph)
     _t1_len_pre = 0;
 
     _terminatePreviousMatch();
-
-    _g1_fast.setGraph(*_g1);
 }
 
 void EmbeddingEnumerator::ignoreSubgraphVertex(int idx)
@@ -169,12 +166,14 @@ void EmbeddingEnumerator::processStart()
     while ((node1 = _getNextNode1()) != -1)
     {
         // Find node parent
-        const Vertex& v = _g1->getVertex(node1);
+        const GraphCSR& g1_csr = _g1->getCSR();
+        const int* nei_vertices = g1_csr.neiVertices(node1);
+        int nei_count = g1_csr.degree(node1);
 
         int parent = -1;
-        for (int j = v.neiBegin(); j != v.neiEnd(); j = v.neiNext(j))
+        for (int j = 0; j < nei_count; j++)
         {
-            int nei_vertex = v.neiVertex(j);
+            int nei_vertex = nei_vertices[j];
             if (_core_1[nei_vertex] >= 0)
             {
                 parent = nei_vertex;
@@ -202,10 +201,13 @@ void EmbeddingEnumerator::_fixNode1(int node1, int node2)
 
     _core_1[node1] = node2;
 
-    const Vertex& v1 = _g1->getVertex(node1);
-    for (int i = v1.neiBegin(); i != v1.neiEnd(); i = v1.neiNext(i))
+    const GraphCSR& g1_csr = _g1->getCSR();
+    const int* nei_vertices = g1_csr.neiVertices(node1);
+    int nei_count = g1_csr.degree(node1);
+
+    for (int i = 0; i < nei_count; i++)
     {
-        int other1 = v1.neiVertex(i);
+        int other1 = nei_vertices[i];
 
         if (_core_1[other1] == UNMAPPED)
         {
@@ -360,8 +362,9 @@ void EmbeddingEnumerator::_Enumerator::_addPairNode2(int node1, int node2)
 
     if (_t1_len > 0)
     {
-        int node2_nei_count;
-        int* node2_nei_v = _context._g2_fast.getVertexNeiVertices(node2, node2_nei_count);
+        const GraphCSR& g2_csr = _context._g2->getCSR();
+        int node2_nei_count = g2_csr.degree(node2);
+        const int* node2_nei_v = g2_csr.neiVertices(node2);
         for (i = 0; i < node2_nei_count; i++)
         {
             int other2 = node2_nei_v[i];
@@ -436,9 +439,11 @@ bool EmbeddingEnumerator::_Enumerator::_checkPair(int node1, int node2)
     int j;
     bool needRemove = false;
 
-    int node1_nei_count;
-    int* node1_nei_v = _context._g1_fast.getVertexNeiVertices(node1, node1_nei_count);
-    int* node1_nei_e = _context._g1_fast.getVertexNeiEdges(node1, node1_nei_count);
+    const GraphCSR& g1_csr = _context._g1->getCSR();
+    const GraphCSR& g2_csr = _context._g2->getCSR();
+    int node1_nei_count = g1_csr.degree(node1);
+    const int* node1_nei_v = g1_csr.neiVertices(node1);
+    const int* node1_nei_e = g1_csr.neiEdges(node1);
 
     for (j = 0; j < node1_nei_count; j++)
     {
@@ -448,7 +453,7 @@ bool EmbeddingEnumerator::_Enumerator::_checkPair(int node1, int node2)
         if (other2 >= 0)
         {
             int edge1 = node1_nei_e[j];
-            int edge2 = _context._g2_fast.findEdgeIndex(node2, other2);
+            int edge2 = g2_csr.findEdgeIndex(node2, other2);
 
             if (edge2 == -1)
                 break;
@@ -554,8 +559,9 @@ int EmbeddingEnumerator::_Enumerator::nextPair()
 
     if (_t2_len == 0)
     {
-        int v2_count;
-        int* g2_vertices = _context._g2_fast.prepareVertices(v2_count);
+        const GraphCSR& g2_csr = _context._g2->getCSR();
+        int v2_count = g2_csr.vertexCount();
+        const int* g2_vertices = g2_csr.vertices();
 
         // If _current_node2_idx == -1 then _current_node2_idx will be 0
         _current_node2_idx++;
@@ -590,13 +596,14 @@ int EmbeddingEnumerator::_Enumerator::nextPair()
                 throw Error("_current_node2_parent < 0");
         }
 
-        int nei_count;
-        int node2_parent_nei_id = _context._g2_fast.prepareVertexNeiVertices(_current_node2_parent, nei_count);
+        const GraphCSR& g2_csr = _context._g2->getCSR();
+        int nei_count = g2_csr.degree(_current_node2_parent);
+        const int* node2_parent_nei_v = g2_csr.neiVertices(_current_node2_parent);
 
         _current_node2_nei_index++;
         for (; _current_node2_nei_index != nei_count; _current_node2_nei_index++)
         {
-            _current_node2 = _context._g2_fast.getVertexNeiVertiex(node2_parent_nei_id, _current_node2_nei_index);
+            _current_node2 = node2_parent_nei_v[_current_node2_nei_index];
 
             if (!_checkNode2(_current_node2, _current_node1))
                 continue;
@@ -59,6 +59,7 @@ Graph::Graph()
     _neighbors_pool = new Pool<List<VertexEdge>::Elem>();
     _sssr_pool = 0;
     _components_valid = false;
+    _csr_valid = false;
 }
 
 Graph::~Graph()
@@ -75,6 +76,7 @@ Graph::~Graph()
 
 int Graph::addVertex()
 {
+    _csr_valid = false;
     return _vertices->add(*_neighbors_pool);
 }
 
@@ -144,6 +146,7 @@ int Graph::addEdge(int beg, int end)
     _topology_valid = false;
     _sssr_valid = false;
     _components_valid = false;
+    _csr_valid = false;
 
     return edge_idx;
 }
@@ -152,6 +155,7 @@ void Graph::swapEdgeEnds(int edge_idx)
 {
 
     std::swap(_edges[edge_idx].beg, _edges[edge_idx].end);
+    _csr_valid = false;
 }
 
 void Graph::removeEdge(int idx)
@@ -169,6 +173,7 @@ void Graph::removeEdge(int idx)
     _topology_valid = false;
     _sssr_valid = false;
     _components_valid = false;
+    _csr_valid = false;
 }
 
 void Graph::removeAllEdges()
@@ -180,6 +185,7 @@ void Graph::removeAllEdges()
     _topology_valid = false;
     _sssr_valid = false;
     _components_valid = false;
+    _csr_valid = false;
 }
 
 void Graph::removeVertex(int idx)
@@ -203,6 +209,7 @@ void Graph::removeVertex(int idx)
     _topology_valid = false;
     _sssr_valid = false;
     _components_valid = false;
+    _csr_valid = false;
 }
 
 const Vertex& Graph::getVertex(int idx) const
@@ -286,6 +293,50 @@ bool Graph::findPath(int from, int where, Array<int>& path_out) const
     return false;
 }
 
+void GraphCSR::build(const Graph& graph)
+{
+    int v_end = graph.vertexEnd();
+    int next = 0;
+
+    _vertices.clear();
+    _nei_offsets.clear_resize(v_end + 1);
+    _nei_vertices.clear();
+    _nei_edges.clear();
+
+    for (int v = graph.vertexBegin(); v != graph.vertexEnd(); v = graph.vertexNext(v))
+    {
+        // Removed vertices get empty neighbor ranges
+        while (next <= v)
+            _nei_offsets[next++] = _nei_vertices.size();
+
+        _vertices.push(v);
+
+        const Vertex& vertex = graph.getVertex(v);
+        for (int i = vertex.neiBegin(); i != vertex.neiEnd(); i = vertex.neiNext(i))
+        {
+            _nei_vertices.push(vertex.neiVertex(i));
+            _nei_edges.push(vertex.neiEdge(i));
+        }
+    }
+    while (next <= v_end)
+        _nei_offsets[next++] = _nei_vertices.size();
+
+    _edges.clear_resize(graph.edgeEnd());
+    _edges.fffill();
+    for (int e = graph.edgeBegin(); e != graph.edgeEnd(); e = graph.edgeNext(e))
+        _edges[e] = graph.getEdge(e);
+}
+
+void Graph::_buildCSR() const
+{
+    std::lock_guard<std::mutex> locker(_csr_lock);
+    if (_csr_valid.load(std::memory_order_relaxed))
+        return;
+
+    _csr.build(*this);
+    _csr_valid.store(true, std::memory_order_release);
+}
+
 VerticesAuto Graph::vertices()
 {
     return VerticesAuto(*this);
@@ -303,6 +354,18 @@ void Graph::clear()
     _topology_valid = false;
     _sssr_valid = false;
     _components_valid = false;
+    _csr_valid = false;
+}
+
+void Graph::reserve(int vertex_count, int edge_count)
+{
+    if (vertex_count > 0)
+        _vertices->reserve(vertex_count);
+    if (edge_count > 0)
+    {
+        _edges.reserve(edge_count);
+        _neighbors_pool->reserve(edge_count * 2);
+    }
 }
 
 bool Graph::isChain_AssumingConnected(const Graph& graph)
@@ -836,6 +899,7 @@ void Graph::_cloneGraph_KeepIndices(const Graph& other)
     _topology_valid = false;
     _sssr_valid = false;
     _components_valid = false;
+    _csr_valid = false;
 }
 
 void Graph::_calculateSSSRAddEdgesAndVertices(const Array<int>& cycle, List<int>& edges, List<int>& vertices)
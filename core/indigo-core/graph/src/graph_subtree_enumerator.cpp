@@ -18,8 +18,6 @@
 
 #include "graph/graph_subtree_enumerator.h"
 
-#include "graph/graph_fast_access.h"
-
 using namespace indigo;
 
 CP_DEF(GraphSubtreeEnumerator);
@@ -97,16 +95,19 @@ void GraphSubtreeEnumerator::_reverseSearch(int front_idx, int cur_maximal_crite
 
         // Update front
         int v = front_prev_value.v;
-        const Vertex& vertex = _graph.getVertex(v);
-        for (int i = vertex.neiBegin(); i != vertex.neiEnd(); i = vertex.neiNext(i))
+        const GraphCSR& csr = _graph.getCSR();
+        const int* nei_vertices = csr.neiVertices(v);
+        const int* nei_edges = csr.neiEdges(v);
+        int degree = csr.degree(v);
+        for (int i = 0; i < degree; i++)
         {
-            int nei_v = vertex.neiVertex(i);
+            int nei_v = nei_vertices[i];
             if (_v_processed[nei_v] == 1)
                 continue;
 
             VertexEdgeParent& added = _front.push();
             added.v = nei_v;
-            added.e = vertex.neiEdge(i);
+            added.e = nei_edges[i];
             added.parent = v;
         }
         // Check if we can reuse front_idx front index
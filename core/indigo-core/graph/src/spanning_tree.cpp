@@ -72,16 +72,26 @@ SpanningTree::SpanningTree(Graph& graph, const Filter* vertex_filter, const Filt
         if (start == _tree.vertexEnd())
             break;
 
-        StackElem& elem = _stack.push();
-        elem.vertex = &_graph.getVertex(_mapping[start]);
-        elem.nei_idx = elem.vertex->neiBegin();
-        elem.vertex_idx = start;
-        elem.parent_idx = -1;
-        _depth_counters[start] = ++_current_depth;
+        _pushVertex(start, -1);
         _build();
     }
 }
 
+void SpanningTree::_pushVertex(int vertex_idx, int parent_idx)
+{
+    const GraphCSR& csr = _graph.getCSR();
+    int ext_idx = _mapping[vertex_idx];
+
+    StackElem& elem = _stack.push();
+    elem.nei_vertices = csr.neiVertices(ext_idx);
+    elem.nei_edges = csr.neiEdges(ext_idx);
+    elem.degree = csr.degree(ext_idx);
+    elem.nei_idx = 0;
+    elem.vertex_idx = vertex_idx;
+    elem.parent_idx = parent_idx;
+    _depth_counters[vertex_idx] = ++_current_depth;
+}
+
 void SpanningTree::_build()
 {
     while (_stack.size() > 0)
@@ -91,36 +101,28 @@ void SpanningTree::_build()
         int v = elem.vertex_idx;
         int i = elem.nei_idx;
 
-        if (i < elem.vertex->neiEnd())
+        if (i < elem.degree)
         {
-            elem.nei_idx = elem.vertex->neiNext(i);
+            elem.nei_idx = i + 1;
 
-            int nei_v = elem.vertex->neiVertex(i);
+            int nei_v = elem.nei_vertices[i];
+            int nei_edge = elem.nei_edges[i];
             if (_vertex_filter != 0 && !_vertex_filter->valid(nei_v))
                 continue;
 
-            if (_edge_filter != 0)
-            {
-                int nei_edge = elem.vertex->neiEdge(i);
-                if (!_edge_filter->valid(nei_edge))
-                    continue;
-            }
+            if (_edge_filter != 0 && !_edge_filter->valid(nei_edge))
+                continue;
 
-            int w = _inv_mapping[elem.vertex->neiVertex(i)];
+            int w = _inv_mapping[nei_v];
 
             if (_depth_counters[w] == 0)
             {
                 int idx = _tree.addEdge(v, w);
 
-                _edge_mapping[idx] = elem.vertex->neiEdge(i);
-
-                StackElem& newelem = _stack.push();
+                _edge_mapping[idx] = nei_edge;
 
-                _depth_counters[w] = ++_current_depth;
-                newelem.parent_idx = v;
-                newelem.vertex_idx = w;
-                newelem.vertex = &_graph.getVertex(_mapping[w]);
-                newelem.nei_idx = newelem.vertex->neiBegin();
+                // elem is invalidated by the push
+                _pushVertex(w, v);
             }
             else if (w != elem.parent_idx && _depth_counters[w] < _depth_counters[v])
             {
@@ -130,7 +132,7 @@ void SpanningTree::_build()
                 edge.end_idx = w;
                 edge.ext_beg_idx = _mapping[v];
                 edge.ext_end_idx = _mapping[w];
-                edge.ext_edge_idx = elem.vertex->neiEdge(i);
+                edge.ext_edge_idx = nei_edge;
                 _edges_list.push(edge);
             }
         }
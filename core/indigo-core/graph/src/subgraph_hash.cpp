@@ -24,7 +24,7 @@ using namespace indigo;
 CP_DEF(SubgraphHash);
 
 SubgraphHash::SubgraphHash(Graph& g)
-    : _g(g), CP_INIT, TL_CP_GET(_codes), TL_CP_GET(_oldcodes), TL_CP_GET(_gf), TL_CP_GET(_default_vertex_codes), TL_CP_GET(_default_edge_codes)
+    : _g(g), CP_INIT, TL_CP_GET(_codes), TL_CP_GET(_oldcodes), TL_CP_GET(_multi_codes), TL_CP_GET(_multi_oldcodes), TL_CP_GET(_default_vertex_codes), TL_CP_GET(_default_edge_codes)
 {
     max_iterations = _g.vertexEnd();
     _different_codes_count = 0;
@@ -40,9 +40,6 @@ SubgraphHash::SubgraphHash(Graph& g)
 
     vertex_codes = &_default_vertex_codes;
     edge_codes = &_default_edge_codes;
-
-    _gf.setGraph(g);
-    _gf.prepareEdges();
 }
 
 dword SubgraphHash::getHash()
@@ -81,7 +78,7 @@ dword SubgraphHash::getHash(const Array<int>& vertices, const Array<int>& edges)
     for (i = 0; i < vertices.size(); i++)
         codes_ptr[v[i]] = vc[v[i]];
 
-    const Edge* graph_edges = _gf.getEdges();
+    const GraphCSR& csr = _g.getCSR();
 
     for (iter = 0; iter < max_iterations; iter++)
     {
@@ -90,7 +87,7 @@ dword SubgraphHash::getHash(const Array<int>& vertices, const Array<int>& edges)
         for (i = 0; i < edges.size(); i++)
         {
             int edge_index = e[i];
-            const Edge& edge = graph_edges[edge_index];
+            const Edge& edge = csr.getEdge(edge_index);
 
             int edge_rank = ec[edge_index];
             dword v1_code = oldcodes_ptr[edge.beg];
@@ -111,28 +108,136 @@ dword SubgraphHash::getHash(const Array<int>& vertices, const Array<int>& edges)
     }
 
     if (calc_different_codes_count)
+        _different_codes_count = _countDifferentCodes(vertices, codes_ptr, 1, oldcodes_ptr);
+
+    return result;
+}
+
+void SubgraphHash::getHashes(const Array<int>& vertices, const Array<int>& edges, int count, const Array<int>* const* vertex_codes_list,
+                             const Array<int>* const* edge_codes_list, dword* hashes, int* different_codes_count)
+{
+    const int N = MAX_CODE_SETS;
+    int i, k, iter;
+
+    if (count < 1 || count > N)
+        throw Exception("SubgraphHash: invalid number of code sets (%d)", count);
+
+    // Unused sets repeat the first one so that the loops below always
+    // have N iterations and can be unrolled by the compiler
+    const int* vc[N];
+    const int* ec[N];
+    for (k = 0; k < N; k++)
     {
-        // Calculate number of different codes
-        Array<dword>& code_was_used = _oldcodes;
-        dword* code_was_used_ptr = code_was_used.ptr();
+        vc[k] = vertex_codes_list[k < count ? k : 0]->ptr();
+        ec[k] = edge_codes_list[k < count ? k : 0]->ptr();
+    }
+
+    // Codes of all the sets are interleaved: codes of vertex v are at v * N ... v * N + N - 1
+    _multi_codes.resize(_g.vertexEnd() * N);
+    _multi_oldcodes.resize(_g.vertexEnd() * N);
+
+    dword* codes_ptr = _multi_codes.ptr();
+    dword* oldcodes_ptr = _multi_oldcodes.ptr();
+
+    const int* v = vertices.ptr();
+    const int* e = edges.ptr();
+
+    for (i = 0; i < vertices.size(); i++)
+        for (k = 0; k < N; k++)
+            codes_ptr[v[i] * N + k] = vc[k][v[i]];
+
+    const GraphCSR& csr = _g.getCSR();
 
+    for (iter = 0; iter < max_iterations; iter++)
+    {
         for (i = 0; i < vertices.size(); i++)
-            code_was_used_ptr[v[i]] = 0;
+            for (k = 0; k < N; k++)
+                oldcodes_ptr[v[i] * N + k] = codes_ptr[v[i] * N + k];
 
-        _different_codes_count = 0;
-        for (int i = 0; i < vertices.size(); i++)
+        for (i = 0; i < edges.size(); i++)
         {
-            if (code_was_used[v[i]])
-                continue;
-            _different_codes_count++;
-            dword cur_code = codes_ptr[v[i]];
-            for (int j = 0; j < vertices.size(); j++)
-                if (codes_ptr[v[j]] == cur_code)
-                    code_was_used_ptr[v[j]] = 1;
+            int edge_index = e[i];
+            const Edge& edge = csr.getEdge(edge_index);
+
+            const dword* beg_oldcodes = oldcodes_ptr + edge.beg * N;
+            const dword* end_oldcodes = oldcodes_ptr + edge.end * N;
+            dword beg_add[N], end_add[N];
+
+            for (k = 0; k < N; k++)
+            {
+                dword edge_rank = ec[k][edge_index] + 1721;
+                dword v1_code = beg_oldcodes[k];
+                dword v2_code = end_oldcodes[k];
+
+                beg_add[k] = v2_code * v2_code + (v2_code + 23) * edge_rank;
+                end_add[k] = v1_code * v1_code + (v1_code + 23) * edge_rank;
+            }
+
+            dword* beg_codes = codes_ptr + edge.beg * N;
+            dword* end_codes = codes_ptr + edge.end * N;
+            for (k = 0; k < N; k++)
+            {
+                beg_codes[k] += beg_add[k];
+                end_codes[k] += end_add[k];
+            }
         }
     }
 
-    return result;
+    for (k = 0; k < count; k++)
+    {
+        dword result = 0;
+
+        for (i = 0; i < vertices.size(); i++)
+        {
+            dword code = codes_ptr[v[i] * N + k];
+
+            result += code * (code + 6849) + 29;
+        }
+        hashes[k] = result;
+
+        if (different_codes_count != 0)
+            different_codes_count[k] = _countDifferentCodes(vertices, codes_ptr + k, N, oldcodes_ptr);
+    }
+}
+
+int SubgraphHash::_countDifferentCodes(const Array<int>& vertices, const dword* codes, int stride, dword* code_was_used)
+{
+    const int* v = vertices.ptr();
+    int i, j, n = 0;
+
+    // Fragments are small: compare the codes gathered into a local buffer
+    const int SMALL = 16;
+    if (vertices.size() <= SMALL)
+    {
+        dword buf[SMALL];
+
+        for (i = 0; i < vertices.size(); i++)
+        {
+            buf[i] = codes[v[i] * stride];
+            for (j = 0; j < i; j++)
+                if (buf[j] == buf[i])
+                    break;
+            if (j == i)
+                n++;
+        }
+        return n;
+    }
+
+    for (i = 0; i < vertices.size(); i++)
+        code_was_used[v[i]] = 0;
+
+    for (i = 0; i < vertices.size(); i++)
+    {
+        if (code_was_used[v[i]])
+            continue;
+        n++;
+        dword cur_code = codes[v[i] * stride];
+        for (j = 0; j < vertices.size(); j++)
+            if (codes[v[j] * stride] == cur_code)
+                code_was_used[v[j]] = 1;
+    }
+
+    return n;
 }
 
 int SubgraphHash::getDifferentCodesCount()
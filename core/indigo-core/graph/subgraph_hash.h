@@ -21,7 +21,7 @@
 
 #include "base_cpp/array.h"
 #include "base_cpp/tlscont.h"
-#include "graph/graph_fast_access.h"
+#include "graph/graph.h"
 
 #ifdef _WIN32
 #pragma warning(push)
@@ -38,24 +38,38 @@ namespace indigo
     public:
         SubgraphHash(Graph& g);
 
+        enum
+        {
+            MAX_CODE_SETS = 4
+        };
+
         int max_iterations;
         bool calc_different_codes_count;
 
         dword getHash();
         dword getHash(const Array<int>& vertices, const Array<int>& edges);
 
+        // Calculates hashes of the same subgraph for count (up to MAX_CODE_SETS) pairs of vertex
+        // and edge codes in one pass over its edges. hashes[i] is equal to getHash() with the i-th pair
+        // of codes, different_codes_count[i] to the corresponding getDifferentCodesCount().
+        void getHashes(const Array<int>& vertices, const Array<int>& edges, int count, const Array<int>* const* vertex_codes_list,
+                       const Array<int>* const* edge_codes_list, dword* hashes, int* different_codes_count);
+
         int getDifferentCodesCount();
 
         const Array<int>*vertex_codes, *edge_codes;
 
     private:
+        int _countDifferentCodes(const Array<int>& vertices, const dword* codes, int stride, dword* code_was_used);
+
         Graph& _g;
         int _different_codes_count;
 
         CP_DECL;
         TL_CP_DECL(Array<dword>, _codes);
         TL_CP_DECL(Array<dword>, _oldcodes);
-        TL_CP_DECL(GraphFastAccess, _gf);
+        TL_CP_DECL(Array<dword>, _multi_codes);
+        TL_CP_DECL(Array<dword>, _multi_oldcodes);
 
         TL_CP_DECL(Array<int>, _default_vertex_codes);
         TL_CP_DECL(Array<int>, _default_edge_codes);
@@ -112,6 +112,7 @@ namespace indigo
         virtual bool isQueryMolecule();
 
         void clear() override;
+        void reserve(int vertex_count, int edge_count) override;
 
         // 'neu' means 'new' in German
         virtual BaseMolecule* neu() = 0;
@@ -25,6 +25,8 @@
 namespace indigo
 {
 
+    class MoleculeCanonicalizer;
+
     class DLLEXPORT CanonicalSmilesSaver : public SmilesSaver
     {
     public:
@@ -35,6 +37,10 @@ namespace indigo
 
         void saveMolecule(Molecule& mol);
 
+        // Use the given canonicalizer instead of a pooled one; its own
+        // find_invalid_stereo setting is used.
+        void saveMolecule(Molecule& mol, MoleculeCanonicalizer& canonicalizer);
+
         DECL_ERROR;
 
     protected:
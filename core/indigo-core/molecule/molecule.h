@@ -38,6 +38,7 @@ namespace indigo
         Molecule& asMolecule() override;
 
         void clear() override;
+        void reserve(int vertex_count, int edge_count) override;
 
         BaseMolecule* neu() override;
 
@@ -0,0 +1,103 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#ifndef __molecule_canonicalizer__
+#define __molecule_canonicalizer__
+
+#include "base_cpp/array.h"
+#include "base_cpp/exception.h"
+#include "base_cpp/non_copyable.h"
+#include "molecule/molecule.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+namespace indigo
+{
+
+    class Output;
+
+    // Finds canonical numbering of a molecule the same way as CanonicalSmilesSaver does.
+    // The object keeps its buffers between calls, so one instance should be reused
+    // when many molecules are processed. Stereo validation is skipped for molecules
+    // that have neither stereocenters nor cis-trans bonds.
+    class DLLEXPORT MoleculeCanonicalizer : public NonCopyable
+    {
+    public:
+        struct Hash
+        {
+            qword lo;
+            qword hi;
+        };
+
+        MoleculeCanonicalizer();
+
+        void clear();
+
+        bool find_invalid_stereo;
+
+        // Prepare a copy of the molecule with invalid stereo removed and calculate
+        // canonical ranks for it. Hydrogens that can be implicit are ignored.
+        // Aromatic hydrogens configuration is restored in the source molecule.
+        void process(Molecule& mol);
+
+        Molecule& molecule();
+
+        // Canonical rank of every atom of molecule(); -1 for ignored atoms
+        Array<int>& ranks();
+        // Atoms of molecule() in the canonical order
+        const Array<int>& order() const;
+        const Array<int>& ignored() const;
+
+        // Same as CanonicalSmilesSaver::saveMolecule
+        void saveSmiles(Molecule& mol, Output& output);
+
+        // 128-bit hash of the canonical form, calculated without building the SMILES.
+        // Covers atoms, bonds, charges, isotopes, radicals, hydrogens, stereo and
+        // reaction atom mapping; equal canonical SMILES give equal hashes.
+        Hash hash(Molecule& mol);
+
+        DECL_ERROR;
+
+    protected:
+        bool _hasStereo(Molecule& mol);
+        int _stereocenterParity(int atom_idx);
+        int _cisTransParity(int bond_idx);
+        int _rank(int atom_idx);
+
+        Molecule _mol;
+
+        Array<int> _ignored;
+        Array<int> _order;
+        Array<int> _ranks;
+
+        Array<int> _bonds;
+        Array<int> _aam_seen;
+        Array<int> _group_seen;
+        Array<int> _group_parity;
+    };
+
+} // namespace indigo
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
@@ -45,6 +45,7 @@ namespace indigo
         explicit MoleculeCisTrans();
 
         void clear();
+        void reserve(int bond_count);
         void build(BaseMolecule& baseMolecule, int* exclude_bonds);
         void buildFromSmiles(BaseMolecule& baseMolecule, int* dirs);
 
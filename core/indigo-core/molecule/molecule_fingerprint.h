@@ -124,6 +124,10 @@ namespace indigo
         bool skip_any_bonds;       // don't build 'any bonds' part of the fingerprint
         bool skip_any_atoms_bonds; // don't build 'any atoms, any bonds' part of the fingerprint
 
+        // Hash the variants of each fragment (with and without atom and bond types)
+        // in one pass. The fingerprint is the same either way; true by default.
+        bool fused_hashing;
+
         void process();
 
         const byte* get();
@@ -162,6 +166,13 @@ namespace indigo
         void _canonicalizeFragmentAndSetBits(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool use_atoms, bool use_bonds,
                                              int subgraph_type, dword& bits_to_set);
 
+        // Fingerprint parts (bits of bits_set) the fragment variant contributes to
+        int _fragmentParts(const Array<int>& vertices, const Array<int>& edges, bool use_atoms, bool use_bonds, int subgraph_type);
+        void _setFragmentBits(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool use_atoms, bool use_bonds, int parts, dword hash,
+                              int different_vertex_count, dword& bits_set);
+        void _handleSubgraphFused(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool has_query_atoms, bool has_query_bonds,
+                                  int subgraph_type);
+
         void _makeFingerprint(BaseMolecule& mol);
         void _makeFingerprint_calcOrdSim(BaseMolecule& mol);
         void _makeFingerprint_calcChem(BaseMolecule& mol);
@@ -210,6 +221,8 @@ namespace indigo
         TL_CP_DECL(Array<int>, _vertex_connectivity);
         TL_CP_DECL(Array<int>, _fragment_vertex_degree);
         TL_CP_DECL(Array<int>, _bond_orders);
+        TL_CP_DECL(Array<int>, _query_atoms);
+        TL_CP_DECL(Array<int>, _query_bonds);
 
         typedef std::unordered_map<HashBits, int, Hasher> HashesMap;
         TL_CP_DECL(HashesMap, _ord_hashes);
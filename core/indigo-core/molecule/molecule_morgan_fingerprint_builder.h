@@ -41,6 +41,8 @@ namespace indigo
         void packFingerprintFCFP(int fp_depth, Array<byte>& res);
 
     private:
+        friend class MoleculeMorganFeaturesBatch;
+
         enum
         {
             MAGIC_HASH_NUMBER = 37
@@ -108,6 +110,65 @@ namespace indigo
         std::vector<AtomDescriptor> atom_descriptors;
     };
 
+    // Calculates the same features as MoleculeMorganFingerprintBuilder for a
+    // sequence of molecules. All the per-molecule data lives in flat arrays that
+    // are reused between the molecules; bond sets of the atom environments are
+    // sorted edge lists instead of std::set. Results are kept unfolded: sorted feature
+    // ids with the number of times each id occurs in the molecule.
+    class DLLEXPORT MoleculeMorganFeaturesBatch : public NonCopyable
+    {
+    public:
+        MoleculeMorganFeaturesBatch();
+
+        void clear();
+
+        // Calculate features of the molecule and append them to the batch.
+        // Returns index of the molecule in the batch.
+        int addECFP(BaseMolecule& mol, int fp_depth);
+        int addFCFP(BaseMolecule& mol, int fp_depth);
+
+        int count() const;
+
+        // Number of distinct features of the molecule; ids are sorted
+        int getFeatures(int idx, const dword*& ids, const int*& counts) const;
+
+    private:
+        typedef MoleculeMorganFingerprintBuilder::InitialStateCallback InitialStateCallback;
+
+        int _add(BaseMolecule& mol, int fp_depth, InitialStateCallback initialStateCallback);
+        void _prepare(BaseMolecule& mol, InitialStateCallback initialStateCallback);
+        void _iterate(int iteration_number);
+        void _collectFeatures();
+
+        static void _sortKeys(qword* keys, int n);
+
+        // Atoms of the molecule and their neighbours (positions in _atoms) in CSR form
+        Array<int> _atoms;
+        Array<int> _atom_pos;
+        Array<int> _nei_offsets;
+        Array<int> _nei_atoms;
+        Array<int> _nei_bond_types;
+        Array<int> _nei_edges;
+
+        Array<dword> _hashes, _new_hashes;
+
+        // Bond sets of the atom environments: sorted edge indices in CSR form
+        Array<int> _env_offsets, _new_env_offsets;
+        Array<int> _env_edges, _new_env_edges;
+        Array<int> _env, _merged; // bond set of an atom being built
+
+        Array<dword> _feature_hashes;
+        Array<int> _feature_offsets;
+        Array<int> _feature_edges;
+        Array<int> _sorted_features; // ordered by bond sets
+        Array<int> _candidates;      // atoms ordered by bond sets and hashes
+        Array<qword> _keys;          // neighbour descriptors of an atom
+
+        Array<int> _offsets;
+        Array<dword> _ids;
+        Array<int> _counts;
+    };
+
 }; // namespace indigo
 
 #endif // PROJECT_MOLECULE_MORGAN_FINGERPRINT_H
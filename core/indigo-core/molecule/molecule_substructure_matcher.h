@@ -84,6 +84,11 @@ namespace indigo
         int match_3d;        // 0 or AFFINE or CONFORMATION
         float rms_threshold; // for AFFINE and CONFORMATION
 
+        // The implicit hydrogens of the target are already unfolded by the caller;
+        // markers are set for the unfolded atoms as by Molecule::unfoldHydrogens.
+        // The matcher does not unfold or remove hydrogens then.
+        void setUnfoldedTargetHydrogens(const Array<int>& markers);
+
         void ignoreQueryAtom(int idx);
         void ignoreTargetAtom(int idx);
         bool fix(int query_atom_idx, int target_atom_idx);
@@ -150,6 +155,12 @@ namespace indigo
 
         static bool matchQueryBond(QueryMolecule::Bond* query, BaseMolecule& target, int sub_idx, int super_idx, AromaticityMatcher* am, dword flags);
 
+        // Same as above for the compiled constraints (see QueryMolecule::getAtomProgram)
+        static bool matchQueryAtom(const QueryMolecule::Program& program, BaseMolecule& target, int super_idx, FragmentMatchCache* fmcache, dword flags);
+
+        static bool matchQueryBond(const QueryMolecule::Program& program, BaseMolecule& target, int sub_idx, int super_idx, AromaticityMatcher* am,
+                                   dword flags);
+
         static void makeTransposition(BaseMolecule& mol, Array<int>& transposition);
 
         DECL_ERROR;
@@ -170,6 +181,11 @@ namespace indigo
 
         static bool _matchAtoms(Graph& subgraph, Graph& supergraph, const int* core_sub, int sub_idx, int super_idx, void* userdata);
 
+        // Single constraint (not an OP_*** node) of the query atom or bond
+        static bool _matchAtomConstraint(int type, int value_min, int value_max, QueryMolecule::Atom* query, BaseMolecule& target, int super_idx,
+                                         FragmentMatchCache* fmcache, dword flags);
+        static bool _matchBondConstraint(int type, int value, BaseMolecule& target, int sub_idx, int super_idx, AromaticityMatcher* am, dword flags);
+
         static bool _matchBonds(Graph& subgraph, Graph& supergraph, int sub_idx, int super_idx, void* userdata);
 
         static void _removeAtom(Graph& subgraph, int sub_idx, void* userdata);
@@ -214,6 +230,7 @@ namespace indigo
         Obj<MoleculePiSystemsMatcher> _pi_systems_matcher;
 
         bool _h_unfold; // implicit target hydrogens unfolded
+        bool _target_h_unfolded; // by the caller, see setUnfoldedTargetHydrogens()
 
         CP_DECL;
         TL_CP_DECL(Array<int>, _3d_constrained_atoms);
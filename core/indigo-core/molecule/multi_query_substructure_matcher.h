@@ -0,0 +1,101 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#ifndef __multi_query_substructure_matcher__
+#define __multi_query_substructure_matcher__
+
+#include "base_cpp/d_bitset.h"
+#include "base_cpp/obj.h"
+#include "base_cpp/ptr_array.h"
+#include "molecule/molecule.h"
+#include "molecule/molecule_arom.h"
+#include "molecule/molecule_neighbourhood_counters.h"
+#include "molecule/molecule_substructure_matcher.h"
+#include "molecule/query_molecule.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif
+
+namespace indigo
+{
+    // Checks a library of substructure queries against one target at a time.
+    // The target is aromatized, hydrogen-unfolded and its neighbourhood counters
+    // are calculated once per match() call and shared by all the queries, as are
+    // the results of recursive SMARTS fragments. Queries that definitely contain
+    // more atoms of some element than the target are rejected without search.
+    class DLLEXPORT MultiQuerySubstructureMatcher
+    {
+    public:
+        MultiQuerySubstructureMatcher();
+        ~MultiQuerySubstructureMatcher();
+
+        // Copies the query into the library and returns its pattern id
+        int addQuery(QueryMolecule& query);
+        int count() const;
+        QueryMolecule& getQuery(int id);
+        void clear();
+
+        AromaticityOptions arom_options;
+        bool use_pi_systems_matcher;
+
+        // Sets the bits of the matched pattern ids
+        void match(Molecule& target, Dbitset& result);
+        // Matched pattern ids in ascending order
+        void match(Molecule& target, Array<int>& result);
+
+        DECL_ERROR;
+
+    protected:
+        struct Pattern
+        {
+            QueryMolecule query;
+            MoleculeAtomNeighbourhoodCounters nei_counters;
+            bool unfold_h;
+            // (element, count) pairs for the atoms with a definite element
+            Array<int> elements;
+        };
+
+        struct PreparedTarget
+        {
+            Molecule mol;
+            Array<int> unfolded_h; // markers of the unfolded hydrogens
+            MoleculeAtomNeighbourhoodCounters nei_counters;
+            MoleculeSubstructureMatcher::FragmentMatchCache fmcache;
+            Obj<MoleculeSubstructureMatcher> matcher;
+            bool prepared;
+        };
+
+        void _prepareTarget(Molecule& target, PreparedTarget& prepared, bool unfold_h);
+        bool _screen(const Pattern& pattern);
+        bool _matchPattern(Pattern& pattern, Molecule& target);
+
+        PtrArray<Pattern> _patterns;
+
+        Array<int> _target_elements;
+        PreparedTarget _target_arom, _target_arom_h_unfolded;
+    };
+
+} // namespace indigo
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
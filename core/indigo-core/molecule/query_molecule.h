@@ -19,7 +19,9 @@
 #ifndef __query_molecule_h__
 #define __query_molecule_h__
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include "base_cpp/ptr_array.h"
 #include "molecule/base_molecule.h"
 #include "molecule/molecule_3d_constraints.h"
@@ -248,6 +250,61 @@ namespace indigo
             bool _sureValueBelongs(int what_type, const int* arr, int count) override;
         };
 
+        // Atom or bond constraint tree compiled into a flat sequence of
+        // constraint tests with short-circuit jumps, evaluated by
+        // MoleculeSubstructureMatcher without recursion. OR-lists of
+        // element numbers are folded into a single bitmask test.
+        class DLLEXPORT Program
+        {
+        public:
+            enum
+            {
+                // Jump targets that finish the evaluation
+                ACCEPT = -1,
+                REJECT = -2,
+
+                // Step type for the folded element lists
+                ELEMENT_SET = -1
+            };
+
+            struct Step
+            {
+                int type; // ATOM_***, BOND_***, HIGHLIGHTING or ELEMENT_SET
+                int value_min;
+                int value_max;
+                int on_true; // index of the next step, ACCEPT or REJECT
+                int on_false;
+                // The step is under odd number of OP_NOT nodes, so constraints
+                // that are disabled by the matching flags have inverted value
+                bool negated;
+                qword elements[2];
+                Node* node; // source constraint, for aliases and fragments
+            };
+
+            void compile(Atom* root);
+            void compile(Bond* root);
+
+            const Step* steps() const
+            {
+                return _steps.ptr();
+            }
+            // Index of the first step, or ACCEPT/REJECT for constant trees
+            int start() const
+            {
+                return _start;
+            }
+
+        private:
+            int _compile(Node* node, int on_true, int on_false, bool negated);
+            int _addStep(Node* node, int on_true, int on_false, bool negated);
+            bool _isElementList(Node* node);
+            void _finish(int start);
+
+            Array<Step> _steps;
+            int _start;
+            bool _bonds;
+        };
+
         QueryMolecule();
         ~QueryMolecule() override;
 
@@ -355,6 +412,14 @@ namespace indigo
 
         void optimize();
 
+        // Compiled constraints of the atom or bond. A program is compiled on the
+        // first call after the atom is invalidated or the molecule edit revision
+        // changes, so matchers running on several threads can share an unmodified
+        // query. Replaced programs are kept until the molecule is destroyed, so
+        // returned references stay valid across the edits.
+        const Program& getAtomProgram(int idx);
+        const Program& getBondProgram(int idx);
+
         Molecule3dConstraints spatial_constraints;
         Array<int> fixed_atoms;
 
@@ -395,6 +460,25 @@ namespace indigo
 
         PtrArray<Atom> _atoms;
         PtrArray<Bond> _bonds;
+
+        // Program pointers of the atoms and bonds for one edit revision, null
+        // for the programs that are not compiled yet
+        struct _ProgramSlots
+        {
+            int revision;
+            int atoms_count;
+            int bonds_count;
+            std::unique_ptr<std::atomic<const Program*>[]> atoms;
+            std::unique_ptr<std::atomic<const Program*>[]> bonds;
+        };
+
+        std::atomic<_ProgramSlots*> _program_slots;
+        PtrArray<_ProgramSlots> _all_program_slots;
+        PtrArray<Program> _all_programs;
+        std::mutex _programs_lock;
+
+        _ProgramSlots& _getProgramSlots();
+        template <typename T> const Program& _getProgram(std::atomic<const Program*>& slot, T* root);
     };
 
 } // namespace indigo
@@ -26,6 +26,8 @@
 namespace indigo
 {
 
+    class Output;
+    class RecordOffsetIndex;
     class Scanner;
 
     class SdfLoader
@@ -50,6 +52,21 @@ namespace indigo
         int count();
 
         void readAt(int index);
+        // Position the loader before the record with the given index. The record
+        // must have been read already or follow the last record read.
+        void seekToRecord(int index);
+
+        // Take the record offsets from the index of the whole input instead of
+        // collecting them while reading. The index must outlive the loader.
+        void useIndex(const RecordOffsetIndex* index);
+        // Read all the records and save their offsets. source_mtime is stored
+        // in the index to detect later changes of the input
+        void saveIndex(Output& output, long long source_mtime);
+        // Offset indexes are not supported for gzipped input
+        bool canSaveIndex() const
+        {
+            return !_own_scanner;
+        }
 
         CP_DECL;
         TL_CP_DECL(Array<char>, data);
@@ -64,6 +81,7 @@ namespace indigo
         TL_CP_DECL(Array<char>, _preread);
         int _current_number;
         long long _max_offset;
+        const RecordOffsetIndex* _index;
     };
 
 } // namespace indigo
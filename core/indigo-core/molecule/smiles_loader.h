@@ -20,6 +20,7 @@
 #define __smiles_loader__
 
 #include "base_cpp/exception.h"
+#include "base_cpp/reusable_obj_array.h"
 #include "base_cpp/tlscont.h"
 #include "molecule/molecule.h"
 #include "molecule/molecule_stereocenter_options.h"
@@ -78,16 +79,20 @@ namespace indigo
             _POLYMER_END = 2
         };
 
+        // Kept in a ReusableObjArray, so the descriptors and their neighbor
+        // arrays are reused by the next molecules loaded in the same thread
         class DLLEXPORT _AtomDesc
         {
         public:
-            _AtomDesc(Pool<List<int>::Elem>& neipool);
+            _AtomDesc();
             ~_AtomDesc();
 
+            void clear();
+
             void pending(int cycle);
             void closure(int cycle, int end);
 
-            List<int> neighbors;
+            Array<int> neighbors;
             int parent;
 
             int label;
@@ -138,8 +143,7 @@ namespace indigo
         TL_CP_DECL(Array<int>, _atom_stack);
         TL_CP_DECL(Array<_CycleDesc>, _cycles);
         TL_CP_DECL(StringPool, _pending_bonds_pool);
-        TL_CP_DECL(Pool<List<int>::Elem>, _neipool);
-        TL_CP_DECL(ObjArray<_AtomDesc>, _atoms);
+        TL_CP_DECL(ReusableObjArray<_AtomDesc>, _atoms);
         TL_CP_DECL(Array<_BondDesc>, _bonds);
         TL_CP_DECL(Array<int>, _polymer_repetitions);
 
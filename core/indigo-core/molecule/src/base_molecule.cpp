@@ -96,6 +96,24 @@ void BaseMolecule::clear()
     updateEditRevision();
 }
 
+void BaseMolecule::reserve(int vertex_count, int edge_count)
+{
+    Graph::reserve(vertex_count, edge_count);
+
+    if (vertex_count > 0)
+    {
+        _xyz.reserve(vertex_count);
+        reaction_atom_mapping.reserve(vertex_count);
+        reaction_atom_inversion.reserve(vertex_count);
+        reaction_atom_exact_change.reserve(vertex_count);
+    }
+    if (edge_count > 0)
+    {
+        reaction_bond_reacting_center.reserve(edge_count);
+        cis_trans.reserve(edge_count);
+    }
+}
+
 bool BaseMolecule::hasCoord(BaseMolecule& mol)
 {
     int i;
@@ -22,7 +22,7 @@
 #include "base_cpp/tlscont.h"
 #include "molecule/elements.h"
 #include "molecule/molecule.h"
-#include "molecule/molecule_automorphism_search.h"
+#include "molecule/molecule_canonicalizer.h"
 #include "molecule/molecule_dearom.h"
 #include "molecule/smiles_saver.h"
 
@@ -45,73 +45,28 @@ CanonicalSmilesSaver::~CanonicalSmilesSaver()
 {
 }
 
-void CanonicalSmilesSaver::saveMolecule(Molecule& mol_)
+void CanonicalSmilesSaver::saveMolecule(Molecule& mol)
 {
-    if (mol_.vertexCount() < 1)
-        return;
+    QS_DEF(MoleculeCanonicalizer, canonicalizer);
 
-    QS_DEF(Array<int>, ignored);
-    QS_DEF(Array<int>, order);
-    QS_DEF(Array<int>, ranks);
-    QS_DEF(Molecule, mol);
+    canonicalizer.find_invalid_stereo = find_invalid_stereo;
+    saveMolecule(mol, canonicalizer);
+}
 
-    int i;
+void CanonicalSmilesSaver::saveMolecule(Molecule& mol_, MoleculeCanonicalizer& canonicalizer)
+{
+    if (mol_.vertexCount() < 1)
+        return;
 
     if (mol_.sgroups.isPolimer())
         throw Error("can not canonicalize a polymer");
 
-    // Detect hydrogens configuration if aromatic but not ambiguous
-    // We can store this infromation in the original structure mol_.
-    mol_.restoreAromaticHydrogens();
-
-    mol.clone(mol_, 0, 0);
-
-    // TODO: canonicalize allenes properly
-    mol.allene_stereo.clear();
-
-    ignored.clear_resize(mol.vertexEnd());
-    ignored.zerofill();
-
-    for (i = mol.vertexBegin(); i < mol.vertexEnd(); i = mol.vertexNext(i))
-        if (mol.convertableToImplicitHydrogen(i))
-            ignored[i] = 1;
-
-    // Try to save into ordinary smiles and find what cis-trans bonds were used
-    NullOutput null_output;
-    SmilesSaver saver_cistrans(null_output);
-    saver_cistrans.ignore_hydrogens = true;
-    saver_cistrans.saveMolecule(mol);
-    // Then reset cis-trans infromation that is not saved into SMILES
-    const Array<int>& parities = saver_cistrans.getSavedCisTransParities();
-    for (i = mol.edgeBegin(); i < mol.edgeEnd(); i = mol.edgeNext(i))
-    {
-        if (mol.cis_trans.getParity(i) != 0 && parities[i] == 0)
-            mol.cis_trans.setParity(i, 0);
-    }
-
-    MoleculeAutomorphismSearch of;
-
-    of.detect_invalid_cistrans_bonds = find_invalid_stereo;
-    of.detect_invalid_stereocenters = find_invalid_stereo;
-    of.find_canonical_ordering = true;
-    of.ignored_vertices = ignored.ptr();
-    of.process(mol);
-    of.getCanonicalNumbering(order);
-
-    for (i = mol.edgeBegin(); i != mol.edgeEnd(); i = mol.edgeNext(i))
-        if (mol.cis_trans.getParity(i) != 0 && of.invalidCisTransBond(i))
-            mol.cis_trans.setParity(i, 0);
-
-    for (i = mol.vertexBegin(); i != mol.vertexEnd(); i = mol.vertexNext(i))
-        if (mol.stereocenters.getType(i) > MoleculeStereocenters::ATOM_ANY && of.invalidStereocenter(i))
-            mol.stereocenters.remove(i);
-
-    ranks.clear_resize(mol.vertexEnd());
+    canonicalizer.process(mol_);
 
-    for (i = 0; i < order.size(); i++)
-        ranks[order[i]] = i;
+    Molecule& mol = canonicalizer.molecule();
+    const Array<int>& order = canonicalizer.order();
 
-    vertex_ranks = ranks.ptr();
+    vertex_ranks = canonicalizer.ranks().ptr();
 
     _actual_atom_atom_mapping.clear_resize(mol.vertexCount());
     _actual_atom_atom_mapping.zerofill();
@@ -64,6 +64,20 @@ void Molecule::clear()
     updateEditRevision();
 }
 
+void Molecule::reserve(int vertex_count, int edge_count)
+{
+    BaseMolecule::reserve(vertex_count, edge_count);
+
+    if (vertex_count > 0)
+    {
+        _atoms.reserve(vertex_count);
+        _implicit_h.reserve(vertex_count);
+        _radicals.reserve(vertex_count);
+    }
+    if (edge_count > 0)
+        _bond_orders.reserve(edge_count);
+}
+
 void Molecule::_flipBond(int atom_parent, int atom_from, int atom_to)
 {
     int src_bond_idx = findEdgeIndex(atom_parent, atom_from);
@@ -900,6 +900,8 @@ void Molecule3dConstraintsChecker::markUsedAtoms(int* arr, int value)
 {
     int i;
 
+    // The cache comes from the thread-local pool and can keep the marks of a previous checker
+    _cache_mark.clear();
     _to_mark = arr;
     _mark_value = value;
 
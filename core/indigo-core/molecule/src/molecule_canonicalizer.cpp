@@ -0,0 +1,383 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#include "molecule/molecule_canonicalizer.h"
+
+#include <algorithm>
+
+#include "base_cpp/output.h"
+#include "molecule/canonical_smiles_saver.h"
+#include "molecule/molecule_automorphism_search.h"
+#include "molecule/smiles_saver.h"
+
+using namespace indigo;
+
+IMPL_ERROR(MoleculeCanonicalizer, "molecule canonicalizer");
+
+namespace
+{
+    // MurmurHash3 x64 128-bit mixing applied to a stream of 64-bit words
+    class HashBuilder
+    {
+    public:
+        HashBuilder() : _h1(0x9368e53c2f6af274ULL), _h2(0x586dcd208f7cd3fdULL), _length(0)
+        {
+        }
+
+        void add(qword value)
+        {
+            qword k1 = value * _C1;
+            k1 = _rotl(k1, 31);
+            k1 *= _C2;
+            _h1 ^= k1;
+            _h1 = _rotl(_h1, 27);
+            _h1 += _h2;
+            _h1 = _h1 * 5 + 0x52dce729;
+
+            qword k2 = value * _C2;
+            k2 = _rotl(k2, 33);
+            k2 *= _C1;
+            _h2 ^= k2;
+            _h2 = _rotl(_h2, 31);
+            _h2 += _h1;
+            _h2 = _h2 * 5 + 0x38495ab5;
+
+            _length++;
+        }
+
+        void add(int high, int low)
+        {
+            add(((qword)(dword)high << 32) | (dword)low);
+        }
+
+        void addString(const char* str)
+        {
+            qword word = 0;
+            int n = 0;
+
+            for (; *str != 0; str++)
+            {
+                word = (word << 8) | (byte)*str;
+                if (++n == 8)
+                {
+                    add(word);
+                    word = 0;
+                    n = 0;
+                }
+            }
+            add(word ^ ((qword)n << 56));
+        }
+
+        MoleculeCanonicalizer::Hash get() const
+        {
+            qword h1 = _h1 ^ _length;
+            qword h2 = _h2 ^ _length;
+
+            h1 += h2;
+            h2 += h1;
+            h1 = _fmix(h1);
+            h2 = _fmix(h2);
+            h1 += h2;
+            h2 += h1;
+
+            MoleculeCanonicalizer::Hash res;
+            res.lo = h1;
+            res.hi = h2;
+            return res;
+        }
+
+    private:
+        static const qword _C1 = 0x87c37b91114253d5ULL;
+        static const qword _C2 = 0x4cf5ad432745937fULL;
+
+        static qword _rotl(qword x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        static qword _fmix(qword k)
+        {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdULL;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ULL;
+            k ^= k >> 33;
+            return k;
+        }
+
+        qword _h1, _h2, _length;
+    };
+
+    // Number of the value in the order of first occurrence, starting from 1
+    int firstOccurrenceIndex(Array<int>& seen, int value)
+    {
+        for (int i = 0; i < seen.size(); i++)
+            if (seen.ptr()[i] == value)
+                return i + 1;
+        seen.push(value);
+        return seen.size();
+    }
+}
+
+MoleculeCanonicalizer::MoleculeCanonicalizer()
+{
+    find_invalid_stereo = true;
+}
+
+Molecule& MoleculeCanonicalizer::molecule()
+{
+    return _mol;
+}
+
+void MoleculeCanonicalizer::clear()
+{
+    _mol.clear();
+    _ignored.clear();
+    _order.clear();
+    _ranks.clear();
+}
+
+Array<int>& MoleculeCanonicalizer::ranks()
+{
+    return _ranks;
+}
+
+const Array<int>& MoleculeCanonicalizer::order() const
+{
+    return _order;
+}
+
+const Array<int>& MoleculeCanonicalizer::ignored() const
+{
+    return _ignored;
+}
+
+bool MoleculeCanonicalizer::_hasStereo(Molecule& mol)
+{
+    return mol.stereocenters.size() > 0 || mol.cis_trans.count() > 0;
+}
+
+void MoleculeCanonicalizer::process(Molecule& mol_)
+{
+    int i;
+
+    if (mol_.sgroups.isPolimer())
+        throw Error("can not canonicalize a polymer");
+
+    // Detect hydrogens configuration if aromatic but not ambiguous
+    // We can store this infromation in the original structure mol_.
+    mol_.restoreAromaticHydrogens();
+
+    _mol.clone(mol_, 0, 0);
+
+    // TODO: canonicalize allenes properly
+    _mol.allene_stereo.clear();
+
+    _ignored.clear_resize(_mol.vertexEnd());
+    _ignored.zerofill();
+
+    for (i = _mol.vertexBegin(); i < _mol.vertexEnd(); i = _mol.vertexNext(i))
+        if (_mol.convertableToImplicitHydrogen(i))
+            _ignored[i] = 1;
+
+    _order.clear();
+    _ranks.clear_resize(_mol.vertexEnd());
+    _ranks.fffill();
+
+    if (_mol.vertexCount() < 1)
+        return;
+
+    if (_mol.cis_trans.count() > 0)
+    {
+        // Try to save into ordinary smiles and find what cis-trans bonds were used
+        NullOutput null_output;
+        SmilesSaver saver_cistrans(null_output);
+        saver_cistrans.ignore_hydrogens = true;
+        saver_cistrans.saveMolecule(_mol);
+        // Then reset cis-trans infromation that is not saved into SMILES
+        const Array<int>& parities = saver_cistrans.getSavedCisTransParities();
+        for (i = _mol.edgeBegin(); i < _mol.edgeEnd(); i = _mol.edgeNext(i))
+        {
+            if (_mol.cis_trans.getParity(i) != 0 && parities[i] == 0)
+                _mol.cis_trans.setParity(i, 0);
+        }
+    }
+
+    bool detect_invalid_stereo = find_invalid_stereo && _hasStereo(_mol);
+
+    MoleculeAutomorphismSearch of;
+
+    of.detect_invalid_cistrans_bonds = detect_invalid_stereo;
+    of.detect_invalid_stereocenters = detect_invalid_stereo;
+    of.find_canonical_ordering = true;
+    of.ignored_vertices = _ignored.ptr();
+    of.process(_mol);
+    of.getCanonicalNumbering(_order);
+
+    if (detect_invalid_stereo)
+    {
+        for (i = _mol.edgeBegin(); i != _mol.edgeEnd(); i = _mol.edgeNext(i))
+            if (_mol.cis_trans.getParity(i) != 0 && of.invalidCisTransBond(i))
+                _mol.cis_trans.setParity(i, 0);
+
+        for (i = _mol.vertexBegin(); i != _mol.vertexEnd(); i = _mol.vertexNext(i))
+            if (_mol.stereocenters.getType(i) > MoleculeStereocenters::ATOM_ANY && of.invalidStereocenter(i))
+                _mol.stereocenters.remove(i);
+    }
+
+    for (i = 0; i < _order.size(); i++)
+        _ranks[_order[i]] = i;
+}
+
+void MoleculeCanonicalizer::saveSmiles(Molecule& mol, Output& output)
+{
+    CanonicalSmilesSaver saver(output);
+
+    saver.saveMolecule(mol, *this);
+}
+
+int MoleculeCanonicalizer::_rank(int atom_idx)
+{
+    if (atom_idx < 0)
+        return -1;
+    return _ranks[atom_idx];
+}
+
+int MoleculeCanonicalizer::_stereocenterParity(int atom_idx)
+{
+    const int* pyramid = _mol.stereocenters.getPyramid(atom_idx);
+    int r[4], i, j, parity = 0;
+
+    // Implicit or ignored hydrogen and lone pair have rank -1
+    for (i = 0; i < 4; i++)
+        r[i] = _rank(pyramid[i]);
+
+    for (i = 0; i < 4; i++)
+        for (j = i + 1; j < 4; j++)
+            if (r[i] > r[j])
+                parity ^= 1;
+
+    return parity;
+}
+
+int MoleculeCanonicalizer::_cisTransParity(int bond_idx)
+{
+    const int* subst = _mol.cis_trans.getSubstituents(bond_idx);
+    int parity = _mol.cis_trans.getParity(bond_idx);
+
+    // Parity is stored for subst[0] and subst[2]; make it relative to the
+    // lowest ranked substituent on each side. Ignored hydrogens have rank -1
+    // and are never preferred, as they may be implicit in the same molecule.
+    for (int side = 0; side < 4; side += 2)
+    {
+        int r0 = _rank(subst[side]), r1 = _rank(subst[side + 1]);
+        if (r1 >= 0 && (r0 < 0 || r1 < r0))
+            parity = 3 - parity;
+    }
+
+    return parity;
+}
+
+MoleculeCanonicalizer::Hash MoleculeCanonicalizer::hash(Molecule& mol)
+{
+    HashBuilder hb;
+    int i, k;
+
+    process(mol);
+
+    hb.add(_order.size());
+
+    _aam_seen.clear();
+    _group_seen.clear();
+    _group_parity.clear();
+
+    for (k = 0; k < _order.size(); k++)
+    {
+        i = _order[k];
+
+        int hcount = _mol.getImplicitH_NoThrow(i, -1);
+        const Vertex& v = _mol.getVertex(i);
+        for (int j = v.neiBegin(); j != v.neiEnd(); j = v.neiNext(j))
+            if (_ignored[v.neiVertex(j)])
+                hcount++;
+
+        hb.add(_mol.getAtomNumber(i), _mol.getAtomIsotope(i));
+        hb.add(_mol.getAtomCharge(i), _mol.getAtomRadical(i));
+        hb.add(_mol.getAtomAromaticity(i), hcount);
+
+        if (_mol.isPseudoAtom(i))
+            hb.addString(_mol.getPseudoAtom(i));
+        else if (_mol.isTemplateAtom(i))
+            hb.addString(_mol.getTemplateAtom(i));
+        else if (_mol.isRSite(i))
+            hb.add(_mol.getRSiteBits(i));
+
+        int aam = _mol.reaction_atom_mapping[i];
+        hb.add(aam != 0 ? firstOccurrenceIndex(_aam_seen, aam) : 0);
+
+        if (_mol.stereocenters.exists(i))
+        {
+            int type = _mol.stereocenters.getType(i);
+            int parity = (type > MoleculeStereocenters::ATOM_ANY) ? _stereocenterParity(i) : 0;
+            int group = 0;
+
+            // Enhanced stereo groups are numbered in canonical order, and
+            // parities inside a group are relative to its first atom
+            if (type == MoleculeStereocenters::ATOM_AND || type == MoleculeStereocenters::ATOM_OR)
+            {
+                int key = _mol.stereocenters.getGroup(i) * 4 + type;
+                int count = _group_seen.size();
+                group = firstOccurrenceIndex(_group_seen, key);
+                if (group > count)
+                    _group_parity.push(parity);
+                parity ^= _group_parity[group - 1];
+            }
+
+            hb.add(type, (group << 1) | parity);
+        }
+        else
+            hb.add(-1, 0);
+    }
+
+    _bonds.clear();
+    for (i = _mol.edgeBegin(); i != _mol.edgeEnd(); i = _mol.edgeNext(i))
+    {
+        const Edge& edge = _mol.getEdge(i);
+        if (!_ignored[edge.beg] && !_ignored[edge.end])
+            _bonds.push(i);
+    }
+
+    const int* ranks = _ranks.ptr();
+    Molecule& m = _mol;
+    auto bondKey = [ranks, &m](int bond) {
+        const Edge& edge = m.getEdge(bond);
+        int r1 = ranks[edge.beg], r2 = ranks[edge.end];
+        return r1 < r2 ? ((qword)(dword)r1 << 32) | (dword)r2 : ((qword)(dword)r2 << 32) | (dword)r1;
+    };
+    std::sort(_bonds.ptr(), _bonds.ptr() + _bonds.size(), [&bondKey](int b1, int b2) { return bondKey(b1) < bondKey(b2); });
+
+    hb.add(_bonds.size());
+    for (k = 0; k < _bonds.size(); k++)
+    {
+        int bond = _bonds[k];
+        hb.add(bondKey(bond));
+        hb.add(_mol.getBondOrder(bond), _mol.cis_trans.getParity(bond) != 0 ? _cisTransParity(bond) : 0);
+    }
+
+    return hb.get();
+}
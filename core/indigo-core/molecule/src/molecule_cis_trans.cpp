@@ -349,6 +349,11 @@ void MoleculeCisTrans::clear()
     _bonds.clear();
 }
 
+void MoleculeCisTrans::reserve(int bond_count)
+{
+    _bonds.reserve(bond_count);
+}
+
 bool MoleculeCisTrans::exists() const
 {
     return _bonds.size() > 0;
@@ -39,7 +39,7 @@ CP_DEF(MoleculeFingerprintBuilder);
 MoleculeFingerprintBuilder::MoleculeFingerprintBuilder(BaseMolecule& mol, const MoleculeFingerprintParameters& parameters)
     : cancellation(0), _mol(mol), _parameters(parameters), CP_INIT, TL_CP_GET(_total_fingerprint), TL_CP_GET(_atom_codes), TL_CP_GET(_bond_codes),
       TL_CP_GET(_atom_codes_empty), TL_CP_GET(_bond_codes_empty), TL_CP_GET(_atom_hydrogens), TL_CP_GET(_atom_charges), TL_CP_GET(_vertex_connectivity),
-      TL_CP_GET(_fragment_vertex_degree), TL_CP_GET(_bond_orders), TL_CP_GET(_ord_hashes)
+      TL_CP_GET(_fragment_vertex_degree), TL_CP_GET(_bond_orders), TL_CP_GET(_query_atoms), TL_CP_GET(_query_bonds), TL_CP_GET(_ord_hashes)
 {
     _total_fingerprint.resize(_parameters.fingerprintSize());
     cb_fragment = 0;
@@ -56,6 +56,8 @@ MoleculeFingerprintBuilder::MoleculeFingerprintBuilder(BaseMolecule& mol, const
     skip_any_bonds = false;
     skip_any_atoms_bonds = false;
 
+    fused_hashing = true;
+
     _ord_hashes.clear();
 }
 
@@ -152,6 +154,18 @@ void MoleculeFingerprintBuilder::_initHashCalculations(BaseMolecule& mol, const
         else
             _bond_orders[e] = 1;
     }
+
+    // Query atoms and bonds are checked for every fragment, so find them once
+    _query_atoms.clear_resize(mol.vertexEnd());
+    for (int v : mol.vertices())
+        _query_atoms[v] = (mol.getAtomNumber(v) == -1);
+
+    _query_bonds.clear_resize(mol.edgeEnd());
+    for (int e : mol.edges())
+    {
+        int bond_order = mol.getBondOrder(e);
+        _query_bonds[e] = (bond_order == -1 || (query && mol.asQueryMolecule().aromaticity.canBeAromatic(e) && bond_order != BOND_AROMATIC));
+    }
 }
 
 MoleculeFingerprintBuilder::~MoleculeFingerprintBuilder()
@@ -382,13 +396,7 @@ dword MoleculeFingerprintBuilder::_canonicalizeFragment(BaseMolecule& mol, const
 
 void MoleculeFingerprintBuilder::_addOrdHashBits(dword hash, int bits_per_fragment)
 {
-    HashBits hash_bits(hash, bits_per_fragment);
-
-    auto it = _ord_hashes.find(hash_bits);
-    if (it == _ord_hashes.end())
-        _ord_hashes.emplace(hash_bits, 1);
-    else
-        _ord_hashes.at(hash_bits)++;
+    _ord_hashes[HashBits(hash, bits_per_fragment)]++;
 }
 
 void MoleculeFingerprintBuilder::_calculateFragmentVertexDegree(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges)
@@ -421,8 +429,7 @@ int MoleculeFingerprintBuilder::_calculateFragmentExternalConn(BaseMolecule& mol
     return sum;
 }
 
-void MoleculeFingerprintBuilder::_canonicalizeFragmentAndSetBits(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool use_atoms,
-                                                                 bool use_bonds, int subgraph_type, dword& bits_set)
+int MoleculeFingerprintBuilder::_fragmentParts(const Array<int>& vertices, const Array<int>& edges, bool use_atoms, bool use_bonds, int subgraph_type)
 {
     bool set_sim = false, set_ord = false, set_any = false, set_tau = false;
 
@@ -465,7 +472,14 @@ void MoleculeFingerprintBuilder::_canonicalizeFragmentAndSetBits(BaseMolecule& m
     if (!use_bonds && !skip_tau && _parameters.tau_qwords > 0)
         set_tau = true;
 
-    if (!set_any && !set_ord && !set_sim && !set_tau)
+    return (set_sim ? 0x01 : 0) | (set_ord ? 0x02 : 0) | (set_any ? 0x04 : 0) | (set_tau ? 0x08 : 0);
+}
+
+void MoleculeFingerprintBuilder::_canonicalizeFragmentAndSetBits(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool use_atoms,
+                                                                 bool use_bonds, int subgraph_type, dword& bits_set)
+{
+    int parts = _fragmentParts(vertices, edges, use_atoms, use_bonds, subgraph_type);
+    if (parts == 0)
         return;
 
     // different_vertex_count is equal to the number of orbits
@@ -473,6 +487,14 @@ void MoleculeFingerprintBuilder::_canonicalizeFragmentAndSetBits(BaseMolecule& m
     int different_vertex_count;
     dword hash = _canonicalizeFragment(mol, vertices, edges, use_atoms, use_bonds, &different_vertex_count);
 
+    _setFragmentBits(mol, vertices, edges, use_atoms, use_bonds, parts, hash, different_vertex_count, bits_set);
+}
+
+void MoleculeFingerprintBuilder::_setFragmentBits(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool use_atoms, bool use_bonds,
+                                                  int parts, dword hash, int different_vertex_count, dword& bits_set)
+{
+    bool set_sim = (parts & 0x01) != 0, set_ord = (parts & 0x02) != 0, set_any = (parts & 0x04) != 0, set_tau = (parts & 0x08) != 0;
+
     // Calculate bits count factor based on different_vertex_count
     int bits_per_fragment;
     if (2 * vertices.size() > 3 * different_vertex_count)
@@ -567,21 +589,23 @@ void MoleculeFingerprintBuilder::_handleSubgraph(Graph& graph, const Array<int>&
 
     // Check if fragment has query atoms or query bonds
     for (i = 0; i < vertices.size(); i++)
-        if (mol.getAtomNumber(vertices[i]) == -1)
+        if (_query_atoms[vertices[i]])
             break;
 
     bool has_query_atoms = (i != vertices.size());
 
     for (i = 0; i < edges.size(); i++)
-    {
-        int e = edges[i];
-        int bond_order = mol.getBondOrder(e);
-        if (bond_order == -1 || (query && mol.asQueryMolecule().aromaticity.canBeAromatic(e) && bond_order != BOND_AROMATIC))
+        if (_query_bonds[edges[i]])
             break;
-    }
 
     bool has_query_bonds = (i != edges.size());
 
+    if (fused_hashing)
+    {
+        _handleSubgraphFused(mol, vertices, edges, has_query_atoms, has_query_bonds, subgraph_type);
+        return;
+    }
+
     dword bits_set = 0;
     if (!has_query_atoms && !has_query_bonds)
         _canonicalizeFragmentAndSetBits(mol, vertices, edges, true, true, subgraph_type, bits_set);
@@ -598,6 +622,56 @@ void MoleculeFingerprintBuilder::_handleSubgraph(Graph& graph, const Array<int>&
     _canonicalizeFragmentAndSetBits(mol, vertices, edges, false, false, subgraph_type, bits_set_ab);
 }
 
+void MoleculeFingerprintBuilder::_handleSubgraphFused(BaseMolecule& mol, const Array<int>& vertices, const Array<int>& edges, bool has_query_atoms,
+                                                      bool has_query_bonds, int subgraph_type)
+{
+    // Same variants and the same order of setting bits as in _handleSubgraph(),
+    // but the hashes of all the needed variants are calculated at once
+    const bool use_atoms[] = {true, true, false, false};
+    const bool use_bonds[] = {true, false, true, false};
+    const bool allowed[] = {!has_query_atoms && !has_query_bonds, !query || !has_query_atoms, !query || !has_query_bonds, true};
+
+    int parts[4], hash_idx[4];
+    const Array<int>* vertex_codes[SubgraphHash::MAX_CODE_SETS];
+    const Array<int>* edge_codes[SubgraphHash::MAX_CODE_SETS];
+    int count = 0;
+
+    for (int k = 0; k < 4; k++)
+    {
+        parts[k] = allowed[k] ? _fragmentParts(vertices, edges, use_atoms[k], use_bonds[k], subgraph_type) : 0;
+        if (parts[k] == 0)
+            continue;
+
+        vertex_codes[count] = use_atoms[k] ? &_atom_codes : &_atom_codes_empty;
+        edge_codes[count] = use_bonds[k] ? &_bond_codes : &_bond_codes_empty;
+        hash_idx[k] = count++;
+    }
+
+    if (count == 0)
+        return;
+
+    dword hashes[SubgraphHash::MAX_CODE_SETS];
+    int different_vertex_count[SubgraphHash::MAX_CODE_SETS];
+
+    subgraph_hash->max_iterations = (edges.size() + 1) / 2;
+    subgraph_hash->getHashes(vertices, edges, count, vertex_codes, edge_codes, hashes, different_vertex_count);
+
+    dword bits_set[4];
+    for (int k = 0; k < 4; k++)
+    {
+        if (k == 0)
+            bits_set[k] = 0;
+        else if (k == 3)
+            bits_set[k] = bits_set[1] | bits_set[2];
+        else
+            bits_set[k] = bits_set[0];
+
+        if (parts[k] != 0)
+            _setFragmentBits(mol, vertices, edges, use_atoms[k], use_bonds[k], parts[k], hashes[hash_idx[k]], different_vertex_count[hash_idx[k]],
+                             bits_set[k]);
+    }
+}
+
 void MoleculeFingerprintBuilder::_makeFingerprint(BaseMolecule& mol)
 {
     Obj<TautomerSuperStructure> tau_super_structure;
@@ -251,3 +251,294 @@ bool MoleculeMorganFingerprintBuilder::FeatureDescriptor::operator<(const Molecu
 {
     return bond_set < rhs.bond_set;
 }
+
+// Bond sets are sorted lists of edge indices; any total order is enough to find the equal ones
+static int _compareBondSets(const int* set1, int size1, const int* set2, int size2)
+{
+    if (size1 != size2)
+        return size1 < size2 ? -1 : 1;
+    for (int i = 0; i < size1; i++)
+        if (set1[i] != set2[i])
+            return set1[i] < set2[i] ? -1 : 1;
+    return 0;
+}
+
+MoleculeMorganFeaturesBatch::MoleculeMorganFeaturesBatch()
+{
+    clear();
+}
+
+void MoleculeMorganFeaturesBatch::clear()
+{
+    _offsets.clear();
+    _offsets.push(0);
+    _ids.clear();
+    _counts.clear();
+}
+
+int MoleculeMorganFeaturesBatch::count() const
+{
+    return _offsets.size() - 1;
+}
+
+int MoleculeMorganFeaturesBatch::getFeatures(int idx, const dword*& ids, const int*& counts) const
+{
+    int begin = _offsets[idx];
+
+    ids = _ids.ptr() + begin;
+    counts = _counts.ptr() + begin;
+    return _offsets[idx + 1] - begin;
+}
+
+int MoleculeMorganFeaturesBatch::addECFP(BaseMolecule& mol, int fp_depth)
+{
+    return _add(mol, fp_depth, MoleculeMorganFingerprintBuilder::initialStateCallback_ECFP);
+}
+
+int MoleculeMorganFeaturesBatch::addFCFP(BaseMolecule& mol, int fp_depth)
+{
+    return _add(mol, fp_depth, MoleculeMorganFingerprintBuilder::initialStateCallback_FCFP);
+}
+
+int MoleculeMorganFeaturesBatch::_add(BaseMolecule& mol, int fp_depth, InitialStateCallback initialStateCallback)
+{
+    _prepare(mol, initialStateCallback);
+
+    for (int i = 0; i < fp_depth; i++)
+    {
+        _iterate(i);
+        _collectFeatures();
+    }
+
+    // Features with the same hash but different bond sets are counted
+    std::sort(_feature_hashes.ptr(), _feature_hashes.ptr() + _feature_hashes.size());
+
+    for (int i = 0; i < _feature_hashes.size(); i++)
+    {
+        if (i > 0 && _feature_hashes[i] == _feature_hashes[i - 1])
+            _counts.top()++;
+        else
+        {
+            _ids.push(_feature_hashes[i]);
+            _counts.push(1);
+        }
+    }
+    _offsets.push(_ids.size());
+
+    return count() - 1;
+}
+
+void MoleculeMorganFeaturesBatch::_prepare(BaseMolecule& mol, InitialStateCallback initialStateCallback)
+{
+    _atoms.clear();
+    _atom_pos.clear_resize(mol.vertexEnd());
+    for (int idx : mol.vertices())
+    {
+        _atom_pos[idx] = _atoms.size();
+        _atoms.push(idx);
+    }
+
+    int n = _atoms.size();
+
+    _nei_offsets.clear_resize(n + 1);
+    _nei_atoms.clear();
+    _nei_bond_types.clear();
+    _nei_edges.clear();
+    _hashes.clear_resize(n);
+    _new_hashes.clear_resize(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        int idx = _atoms[i];
+        const Vertex& vertex = mol.getVertex(idx);
+
+        _nei_offsets[i] = _nei_atoms.size();
+        for (int nei : vertex.neighbors())
+        {
+            int edge_idx = vertex.neiEdge(nei);
+
+            _nei_atoms.push(_atom_pos[vertex.neiVertex(nei)]);
+            _nei_bond_types.push(mol.getBondOrder(edge_idx));
+            _nei_edges.push(edge_idx);
+        }
+
+        _hashes[i] = initialStateCallback(mol, idx);
+    }
+    _nei_offsets[n] = _nei_atoms.size();
+
+    // Environments are empty before the first iteration
+    _env_offsets.clear_resize(n + 1);
+    _env_offsets.zerofill();
+    _env_edges.clear();
+
+    _feature_hashes.clear();
+    _feature_offsets.clear();
+    _feature_offsets.push(0);
+    _feature_edges.clear();
+    _sorted_features.clear();
+}
+
+void MoleculeMorganFeaturesBatch::_sortKeys(qword* keys, int n)
+{
+    // Sorting networks for the usual degrees
+    auto cs = [keys](int i, int j) {
+        if (keys[j] < keys[i])
+            std::swap(keys[i], keys[j]);
+    };
+
+    switch (n)
+    {
+    case 0:
+    case 1:
+        break;
+    case 2:
+        cs(0, 1);
+        break;
+    case 3:
+        cs(0, 1);
+        cs(1, 2);
+        cs(0, 1);
+        break;
+    case 4:
+        cs(0, 1);
+        cs(2, 3);
+        cs(0, 2);
+        cs(1, 3);
+        cs(1, 2);
+        break;
+    default:
+        std::sort(keys, keys + n);
+    }
+}
+
+void MoleculeMorganFeaturesBatch::_iterate(int iteration_number)
+{
+    const dword MAGIC = MoleculeMorganFingerprintBuilder::MAGIC_HASH_NUMBER;
+    int n = _atoms.size();
+
+    _new_env_offsets.clear_resize(n + 1);
+    _new_env_edges.clear();
+
+    for (int i = 0; i < n; i++)
+    {
+        int begin = _nei_offsets[i], end = _nei_offsets[i + 1];
+
+        // Neighbours are ordered by bond type, then by their hash; the sign bit
+        // of the bond type is flipped to keep the signed order of the builder
+        _keys.resize(end - begin);
+        qword* keys = _keys.ptr();
+        for (int j = begin; j < end; j++)
+            keys[j - begin] = ((qword)((dword)_nei_bond_types[j] ^ 0x80000000U) << 32) | _hashes[_nei_atoms[j]];
+
+        _sortKeys(keys, end - begin);
+
+        dword hash = (dword)iteration_number * MAGIC + _hashes[i];
+        for (int j = 0; j < end - begin; j++)
+        {
+            hash = MAGIC * hash + (dword)((keys[j] >> 32) ^ 0x80000000U);
+            hash = MAGIC * hash + (dword)keys[j];
+        }
+        _new_hashes[i] = hash;
+
+        // The bonds to the neighbours merged with the environments of the neighbours,
+        // so the sets grow with the depth and not with the size of the molecule
+        _env.clear();
+        for (int j = begin; j < end; j++)
+            _env.push(_nei_edges[j]);
+        std::sort(_env.ptr(), _env.ptr() + _env.size());
+
+        for (int j = begin; j < end; j++)
+        {
+            int nei = _nei_atoms[j];
+            const int* nei_begin = _env_edges.ptr() + _env_offsets[nei];
+            const int* nei_end = _env_edges.ptr() + _env_offsets[nei + 1];
+
+            _merged.resize(_env.size() + (int)(nei_end - nei_begin));
+            int* merged_end = std::set_union(_env.ptr(), _env.ptr() + _env.size(), nei_begin, nei_end, _merged.ptr());
+            _merged.resize((int)(merged_end - _merged.ptr()));
+            _env.swap(_merged);
+        }
+
+        _new_env_offsets[i] = _new_env_edges.size();
+        _new_env_edges.concat(_env);
+    }
+    _new_env_offsets[n] = _new_env_edges.size();
+
+    _hashes.swap(_new_hashes);
+    _env_offsets.swap(_new_env_offsets);
+    _env_edges.swap(_new_env_edges);
+}
+
+void MoleculeMorganFeaturesBatch::_collectFeatures()
+{
+    int n = _atoms.size();
+    const int* env_offsets = _env_offsets.ptr();
+    const int* env_edges = _env_edges.ptr();
+    const dword* hashes = _hashes.ptr();
+
+    auto compareAtoms = [env_offsets, env_edges](int a, int b) {
+        return _compareBondSets(env_edges + env_offsets[a], env_offsets[a + 1] - env_offsets[a], env_edges + env_offsets[b], env_offsets[b + 1] - env_offsets[b]);
+    };
+
+    // Atoms having the same bond set give one feature with the least hash
+    _candidates.clear_resize(n);
+    for (int i = 0; i < n; i++)
+        _candidates[i] = i;
+
+    std::sort(_candidates.ptr(), _candidates.ptr() + n, [&compareAtoms, hashes](int a, int b) {
+        int cmp = compareAtoms(a, b);
+        if (cmp != 0)
+            return cmp < 0;
+        return hashes[a] < hashes[b];
+    });
+
+    int n_old = _feature_hashes.size();
+
+    for (int i = 0; i < n; i++)
+    {
+        int atom = _candidates[i];
+        const int* set = env_edges + env_offsets[atom];
+        int size = env_offsets[atom + 1] - env_offsets[atom];
+
+        if (i > 0 && compareAtoms(atom, _candidates[i - 1]) == 0)
+            continue;
+
+        // Skip environments that already were features on previous iterations
+        const int* feature_offsets = _feature_offsets.ptr();
+        const int* feature_edges = _feature_edges.ptr();
+        const int* sorted = _sorted_features.ptr();
+        int lo = 0, hi = _sorted_features.size();
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            int f = sorted[mid];
+            if (_compareBondSets(feature_edges + feature_offsets[f], feature_offsets[f + 1] - feature_offsets[f], set, size) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < _sorted_features.size())
+        {
+            int f = sorted[lo];
+            if (_compareBondSets(feature_edges + feature_offsets[f], feature_offsets[f + 1] - feature_offsets[f], set, size) == 0)
+                continue;
+        }
+
+        _feature_hashes.push(hashes[atom]);
+        _feature_edges.concat(set, size);
+        _feature_offsets.push(_feature_edges.size());
+    }
+
+    if (_feature_hashes.size() == n_old)
+        return;
+
+    for (int i = n_old; i < _feature_hashes.size(); i++)
+        _sorted_features.push(i);
+
+    const int* feature_offsets = _feature_offsets.ptr();
+    const int* feature_edges = _feature_edges.ptr();
+    std::sort(_sorted_features.ptr(), _sorted_features.ptr() + _sorted_features.size(), [feature_offsets, feature_edges](int a, int b) {
+        return _compareBondSets(feature_edges + feature_offsets[a], feature_offsets[a + 1] - feature_offsets[a], feature_edges + feature_offsets[b],
+                                feature_offsets[b + 1] - feature_offsets[b]) < 0;
+    });
+}
@@ -87,6 +87,7 @@ MoleculeSubstructureMatcher::MoleculeSubstructureMatcher(BaseMolecule& target)
     disable_unfolding_implicit_h = false;
     restore_unfolded_h = true;
     _h_unfold = false;
+    _target_h_unfolded = false;
 
     _query_nei_counters = 0;
     _target_nei_counters = 0;
@@ -299,7 +300,7 @@ bool MoleculeSubstructureMatcher::find()
     if (match_3d != 0 && !_target.have_xyz)
         return false;
 
-    if (_h_unfold)
+    if (_h_unfold && !_target_h_unfolded)
     {
         _target.asMolecule().unfoldHydrogens(&_unfolded_target_h, -1, true);
         _ee->validate();
@@ -327,7 +328,7 @@ bool MoleculeSubstructureMatcher::find()
 
     int result = _ee->process();
 
-    if (_h_unfold && restore_unfolded_h)
+    if (_h_unfold && restore_unfolded_h && !_target_h_unfolded)
         _removeUnfoldedHydrogens();
 
     if (!find_all_embeddings)
@@ -362,19 +363,30 @@ void MoleculeSubstructureMatcher::_removeUnfoldedHydrogens()
         _target.removeAtoms(atoms_to_remove);
 }
 
+void MoleculeSubstructureMatcher::setUnfoldedTargetHydrogens(const Array<int>& markers)
+{
+    _unfolded_target_h.copy(markers);
+    _target_h_unfolded = true;
+}
+
 bool MoleculeSubstructureMatcher::findNext()
 {
-    if (_h_unfold)
+    if (_h_unfold && !_target_h_unfolded)
         _target.asMolecule().unfoldHydrogens(&_unfolded_target_h, -1, true);
 
     bool found = _ee->processNext();
 
-    if (_h_unfold && restore_unfolded_h)
+    if (_h_unfold && restore_unfolded_h && !_target_h_unfolded)
         _removeUnfoldedHydrogens();
 
     return found;
 }
 
+static bool _valueWithinRange(int value_min, int value_max, int value)
+{
+    return value >= value_min && value <= value_max;
+}
+
 bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, BaseMolecule& target, int super_idx, FragmentMatchCache* fmcache, dword flags)
 {
     int i;
@@ -395,9 +407,44 @@ bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, Bas
         return false;
     case QueryMolecule::OP_NOT:
         return !matchQueryAtom(query->child(0), target, super_idx, fmcache, flags ^ MATCH_DISABLED_AS_TRUE);
+    default:
+        return _matchAtomConstraint(query->type, query->value_min, query->value_max, query, target, super_idx, fmcache, flags);
+    }
+}
+
+bool MoleculeSubstructureMatcher::matchQueryAtom(const QueryMolecule::Program& program, BaseMolecule& target, int super_idx, FragmentMatchCache* fmcache,
+                                                 dword flags)
+{
+    const QueryMolecule::Program::Step* steps = program.steps();
+    int pos = program.start();
+
+    while (pos >= 0)
+    {
+        const QueryMolecule::Program::Step& step = steps[pos];
+        bool result;
+
+        if (step.type == QueryMolecule::Program::ELEMENT_SET)
+        {
+            int number = target.getAtomNumber(super_idx);
+            result = number >= 0 && number < 128 && ((step.elements[number / 64] >> (number % 64)) & 1) != 0;
+        }
+        else
+            result = _matchAtomConstraint(step.type, step.value_min, step.value_max, (QueryMolecule::Atom*)step.node, target, super_idx, fmcache,
+                                          step.negated ? (flags ^ MATCH_DISABLED_AS_TRUE) : flags);
+
+        pos = result ? step.on_true : step.on_false;
+    }
 
+    return pos == QueryMolecule::Program::ACCEPT;
+}
+
+bool MoleculeSubstructureMatcher::_matchAtomConstraint(int type, int value_min, int value_max, QueryMolecule::Atom* query, BaseMolecule& target,
+                                                       int super_idx, FragmentMatchCache* fmcache, dword flags)
+{
+    switch (type)
+    {
     case QueryMolecule::ATOM_NUMBER:
-        return query->valueWithinRange(target.getAtomNumber(super_idx));
+        return _valueWithinRange(value_min, value_max, target.getAtomNumber(super_idx));
     case QueryMolecule::ATOM_PSEUDO:
         return target.isPseudoAtom(super_idx) && strcmp(query->alias.ptr(), target.getPseudoAtom(super_idx)) == 0;
     case QueryMolecule::ATOM_TEMPLATE:
@@ -405,10 +452,10 @@ bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, Bas
     case QueryMolecule::ATOM_RSITE:
         return true;
     case QueryMolecule::ATOM_ISOTOPE:
-        return query->valueWithinRange(target.getAtomIsotope(super_idx));
+        return _valueWithinRange(value_min, value_max, target.getAtomIsotope(super_idx));
     case QueryMolecule::ATOM_CHARGE: {
         if (flags & MATCH_ATOM_CHARGE)
-            return query->valueWithinRange(target.getAtomCharge(super_idx));
+            return _valueWithinRange(value_min, value_max, target.getAtomCharge(super_idx));
         return (flags & MATCH_DISABLED_AS_TRUE) != 0;
     }
     case QueryMolecule::ATOM_RADICAL: {
@@ -417,7 +464,7 @@ bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, Bas
         int radical = target.getAtomRadical_NoThrow(super_idx, -1);
         if (radical == -1)
             return false;
-        return query->valueWithinRange(radical);
+        return _valueWithinRange(value_min, value_max, radical);
     }
     case QueryMolecule::ATOM_VALENCE: {
         if (flags & MATCH_ATOM_VALENCE)
@@ -427,7 +474,7 @@ bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, Bas
             int valence = target.getAtomValence_NoThrow(super_idx, -1);
             if (valence == -1)
                 return false;
-            return query->valueWithinRange(valence);
+            return _valueWithinRange(value_min, value_max, valence);
         }
         return (flags & MATCH_DISABLED_AS_TRUE) != 0;
     }
@@ -435,30 +482,30 @@ bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, Bas
         int conn = target.getVertex(super_idx).degree();
         if (!target.isPseudoAtom(super_idx) && !target.isRSite(super_idx))
             conn += target.asMolecule().getImplicitH_NoThrow(super_idx, 0);
-        return query->valueWithinRange(conn);
+        return _valueWithinRange(value_min, value_max, conn);
     }
     case QueryMolecule::ATOM_TOTAL_BOND_ORDER: {
         // TODO: target.isPseudoAtom(super_idx) || target.isRSite(super_idx)
         int conn = target.asMolecule().getAtomConnectivity_NoThrow(super_idx, -1);
         if (conn == -1)
             return false;
-        return query->valueWithinRange(conn);
+        return _valueWithinRange(value_min, value_max, conn);
     }
     case QueryMolecule::ATOM_TOTAL_H: {
         if (target.isPseudoAtom(super_idx) || target.isRSite(super_idx) || target.isTemplateAtom(super_idx))
             return false;
-        return query->valueWithinRange(target.getAtomTotalH(super_idx));
+        return _valueWithinRange(value_min, value_max, target.getAtomTotalH(super_idx));
     }
     case QueryMolecule::ATOM_SUBSTITUENTS:
     case QueryMolecule::ATOM_SUBSTITUENTS_AS_DRAWN:
-        return query->valueWithinRange(target.getAtomSubstCount(super_idx));
+        return _valueWithinRange(value_min, value_max, target.getAtomSubstCount(super_idx));
     case QueryMolecule::ATOM_SSSR_RINGS:
-        return query->valueWithinRange(target.vertexCountSSSR(super_idx));
+        return _valueWithinRange(value_min, value_max, target.vertexCountSSSR(super_idx));
     case QueryMolecule::ATOM_SMALLEST_RING_SIZE:
-        return query->valueWithinRange(target.vertexSmallestRingSize(super_idx));
+        return _valueWithinRange(value_min, value_max, target.vertexSmallestRingSize(super_idx));
     case QueryMolecule::ATOM_RING_BONDS:
     case QueryMolecule::ATOM_RING_BONDS_AS_DRAWN:
-        return query->valueWithinRange(target.getAtomRingBondsCount(super_idx));
+        return _valueWithinRange(value_min, value_max, target.getAtomRingBondsCount(super_idx));
     case QueryMolecule::ATOM_UNSATURATION:
         return !target.isSaturatedAtom(super_idx);
     case QueryMolecule::ATOM_FRAGMENT: {
@@ -500,11 +547,11 @@ bool MoleculeSubstructureMatcher::matchQueryAtom(QueryMolecule::Atom* query, Bas
         return result;
     }
     case QueryMolecule::ATOM_AROMATICITY:
-        return query->valueWithinRange(target.getAtomAromaticity(super_idx));
+        return _valueWithinRange(value_min, value_max, target.getAtomAromaticity(super_idx));
     case QueryMolecule::HIGHLIGHTING:
-        return query->valueWithinRange((int)target.isAtomHighlighted(super_idx));
+        return _valueWithinRange(value_min, value_max, (int)target.isAtomHighlighted(super_idx));
     default:
-        throw Error("bad query atom type: %d", query->type);
+        throw Error("bad query atom type: %d", type);
     }
 }
 
@@ -533,7 +580,35 @@ bool MoleculeSubstructureMatcher::matchQueryBond(QueryMolecule::Bond* query, Bas
         return false;
     case QueryMolecule::OP_NOT:
         return !matchQueryBond(query->child(0), target, sub_idx, super_idx, am, flags ^ MATCH_DISABLED_AS_TRUE);
+    default:
+        return _matchBondConstraint(query->type, query->value, target, sub_idx, super_idx, am, flags);
+    }
+}
 
+bool MoleculeSubstructureMatcher::matchQueryBond(const QueryMolecule::Program& program, BaseMolecule& target, int sub_idx, int super_idx,
+                                                 AromaticityMatcher* am, dword flags)
+{
+    const QueryMolecule::Program::Step* steps = program.steps();
+    int pos = program.start();
+
+    while (pos >= 0)
+    {
+        const QueryMolecule::Program::Step& step = steps[pos];
+
+        if (_matchBondConstraint(step.type, step.value_min, target, sub_idx, super_idx, am, step.negated ? (flags ^ MATCH_DISABLED_AS_TRUE) : flags))
+            pos = step.on_true;
+        else
+            pos = step.on_false;
+    }
+
+    return pos == QueryMolecule::Program::ACCEPT;
+}
+
+bool MoleculeSubstructureMatcher::_matchBondConstraint(int type, int value, BaseMolecule& target, int sub_idx, int super_idx, AromaticityMatcher* am,
+                                                       dword flags)
+{
+    switch (type)
+    {
     case QueryMolecule::BOND_ORDER: {
         if (flags & MATCH_BOND_TYPE)
         {
@@ -547,16 +622,16 @@ bool MoleculeSubstructureMatcher::matchQueryBond(QueryMolecule::Bond* query, Bas
                         return false;
                 }
             }
-            return target.possibleBondOrder(super_idx, query->value);
+            return target.possibleBondOrder(super_idx, value);
         }
         return (flags & MATCH_DISABLED_AS_TRUE) != 0;
     }
     case QueryMolecule::BOND_TOPOLOGY:
-        return target.getEdgeTopology(super_idx) == query->value;
+        return target.getEdgeTopology(super_idx) == value;
     case QueryMolecule::HIGHLIGHTING:
-        return query->value == (int)target.isAtomHighlighted(super_idx);
+        return value == (int)target.isAtomHighlighted(super_idx);
     default:
-        throw Error("bad query bond type: %d", query->type);
+        throw Error("bad query bond type: %d", type);
     }
 }
 
@@ -631,9 +706,7 @@ bool MoleculeSubstructureMatcher::_matchAtoms(Graph& subgraph, Graph& supergraph
         }
     }
 
-    QueryMolecule::Atom& sub_atom = query.getAtom(sub_idx);
-
-    if (!matchQueryAtom(&sub_atom, target, super_idx, self->fmcache, match_atoms_flags))
+    if (!matchQueryAtom(query.getAtomProgram(sub_idx), target, super_idx, self->fmcache, match_atoms_flags))
         return false;
 
     if (query.stereocenters.getType(sub_idx) > target.stereocenters.getType(super_idx))
@@ -688,9 +761,8 @@ bool MoleculeSubstructureMatcher::_matchBonds(Graph& subgraph, Graph& supergraph
 
     QueryMolecule& query = (QueryMolecule&)subgraph;
     BaseMolecule& target = (BaseMolecule&)supergraph;
-    QueryMolecule::Bond& sub_bond = query.getBond(sub_idx);
 
-    if (!matchQueryBond(&sub_bond, target, sub_idx, super_idx, self->_am.get(), flags))
+    if (!matchQueryBond(query.getBondProgram(sub_idx), target, sub_idx, super_idx, self->_am.get(), flags))
         return false;
 
     return true;
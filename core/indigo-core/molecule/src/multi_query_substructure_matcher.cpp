@@ -0,0 +1,172 @@
+/****************************************************************************
+ * Copyright (C) from 2009 to Present EPAM Systems.
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***************************************************************************/
+
+#include "molecule/multi_query_substructure_matcher.h"
+
+#include "molecule/elements.h"
+
+using namespace indigo;
+
+IMPL_ERROR(MultiQuerySubstructureMatcher, "multi-query substructure matcher");
+
+MultiQuerySubstructureMatcher::MultiQuerySubstructureMatcher()
+{
+    use_pi_systems_matcher = false;
+    _target_arom.prepared = false;
+    _target_arom_h_unfolded.prepared = false;
+}
+
+MultiQuerySubstructureMatcher::~MultiQuerySubstructureMatcher()
+{
+}
+
+int MultiQuerySubstructureMatcher::addQuery(QueryMolecule& query)
+{
+    Pattern& pattern = _patterns.add(new Pattern());
+
+    pattern.query.clone(query, 0, 0);
+    pattern.nei_counters.calculate(pattern.query);
+    pattern.unfold_h = MoleculeSubstructureMatcher::shouldUnfoldTargetHydrogens(pattern.query, false);
+
+    QS_DEF(Array<int>, counts);
+    counts.clear_resize(ELEM_MAX);
+    counts.zerofill();
+
+    for (int i = pattern.query.vertexBegin(); i != pattern.query.vertexEnd(); i = pattern.query.vertexNext(i))
+    {
+        int elem = pattern.query.getAtomNumber(i);
+
+        // Hydrogens can be folded in the query or unfolded in the target
+        if (elem > ELEM_H && elem < ELEM_MAX)
+            counts[elem]++;
+    }
+
+    pattern.elements.clear();
+    for (int elem = ELEM_MIN; elem < ELEM_MAX; elem++)
+        if (counts[elem] > 0)
+        {
+            pattern.elements.push(elem);
+            pattern.elements.push(counts[elem]);
+        }
+
+    return _patterns.size() - 1;
+}
+
+int MultiQuerySubstructureMatcher::count() const
+{
+    return _patterns.size();
+}
+
+QueryMolecule& MultiQuerySubstructureMatcher::getQuery(int id)
+{
+    return _patterns[id]->query;
+}
+
+void MultiQuerySubstructureMatcher::clear()
+{
+    _patterns.clear();
+}
+
+void MultiQuerySubstructureMatcher::match(Molecule& target, Dbitset& result)
+{
+    QS_DEF(Array<int>, ids);
+
+    match(target, ids);
+
+    result.resize(_patterns.size());
+    result.clear();
+    for (int i = 0; i < ids.size(); i++)
+        result.set(ids[i]);
+}
+
+void MultiQuerySubstructureMatcher::match(Molecule& target, Array<int>& result)
+{
+    result.clear();
+
+    _target_elements.clear_resize(ELEM_MAX);
+    _target_elements.zerofill();
+
+    for (int i = target.vertexBegin(); i != target.vertexEnd(); i = target.vertexNext(i))
+    {
+        int elem = target.getAtomNumber(i);
+
+        if (elem >= ELEM_MIN && elem < ELEM_MAX)
+            _target_elements[elem]++;
+    }
+
+    _target_arom.prepared = false;
+    _target_arom_h_unfolded.prepared = false;
+
+    for (int i = 0; i < _patterns.size(); i++)
+    {
+        if (!_screen(*_patterns[i]))
+            continue;
+
+        if (_matchPattern(*_patterns[i], target))
+            result.push(i);
+    }
+}
+
+bool MultiQuerySubstructureMatcher::_screen(const Pattern& pattern)
+{
+    for (int i = 0; i < pattern.elements.size(); i += 2)
+        if (_target_elements[pattern.elements[i]] < pattern.elements[i + 1])
+            return false;
+
+    return true;
+}
+
+void MultiQuerySubstructureMatcher::_prepareTarget(Molecule& target, PreparedTarget& prepared, bool unfold_h)
+{
+    prepared.mol.clone(target, 0, 0);
+    if (!target.isAromatized())
+        prepared.mol.aromatize(arom_options);
+
+    prepared.nei_counters.calculate(prepared.mol);
+    prepared.fmcache.clear();
+
+    // Unfold once so that the queries do not have to unfold and remove
+    // the same hydrogens one after another
+    if (unfold_h)
+        prepared.mol.unfoldHydrogens(&prepared.unfolded_h, -1, true);
+
+    prepared.matcher.recreate(prepared.mol);
+    // The matchers still have to know which hydrogens were implicit
+    if (unfold_h)
+        prepared.matcher->setUnfoldedTargetHydrogens(prepared.unfolded_h);
+    prepared.prepared = true;
+}
+
+bool MultiQuerySubstructureMatcher::_matchPattern(Pattern& pattern, Molecule& target)
+{
+    PreparedTarget& prepared = pattern.unfold_h ? _target_arom_h_unfolded : _target_arom;
+
+    if (!prepared.prepared)
+        _prepareTarget(target, prepared, pattern.unfold_h);
+
+    MoleculeSubstructureMatcher& matcher = prepared.matcher.ref();
+
+    matcher.use_pi_systems_matcher = use_pi_systems_matcher;
+    matcher.arom_options = arom_options;
+    matcher.fmcache = &prepared.fmcache;
+    matcher.restore_unfolded_h = false;
+    matcher.setQuery(pattern.query);
+    matcher.setNeiCounters(&pattern.nei_counters, &prepared.nei_counters);
+
+    return matcher.find();
+}
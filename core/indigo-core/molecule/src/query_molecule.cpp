@@ -21,12 +21,13 @@
 #include "molecule/elements.h"
 #include "molecule/molecule_arom.h"
 #include "molecule/molecule_standardize.h"
+#include <algorithm>
 #include <unordered_map>
 #include <string>
 
 using namespace indigo;
 
-QueryMolecule::QueryMolecule() : spatial_constraints(*this)
+QueryMolecule::QueryMolecule() : spatial_constraints(*this), _program_slots(nullptr)
 {
 }
 
@@ -2092,6 +2093,175 @@ void QueryMolecule::invalidateAtom(int index, int mask)
     BaseMolecule::invalidateAtom(index, mask);
     if (_min_h.size() > index)
         _min_h[index] = -1;
+
+    // Only the slot is reset, the program itself may still be in use by a matcher
+    _ProgramSlots* slots = _program_slots.load(std::memory_order_acquire);
+    if (slots != nullptr && index >= 0 && index < slots->atoms_count)
+        slots->atoms[index].store(nullptr, std::memory_order_release);
+}
+
+QueryMolecule::_ProgramSlots& QueryMolecule::_getProgramSlots()
+{
+    int revision = getEditRevision();
+
+    _ProgramSlots* slots = _program_slots.load(std::memory_order_acquire);
+    if (slots != nullptr && slots->revision == revision)
+        return *slots;
+
+    std::lock_guard<std::mutex> locker(_programs_lock);
+
+    slots = _program_slots.load(std::memory_order_relaxed);
+    if (slots != nullptr && slots->revision == revision)
+        return *slots;
+
+    // Slots of the previous revisions are kept for the concurrent readers
+    slots = &_all_program_slots.add(new _ProgramSlots());
+    slots->revision = revision;
+    slots->atoms_count = vertexEnd();
+    slots->bonds_count = edgeEnd();
+    slots->atoms.reset(new std::atomic<const Program*>[slots->atoms_count]());
+    slots->bonds.reset(new std::atomic<const Program*>[slots->bonds_count]());
+
+    _program_slots.store(slots, std::memory_order_release);
+    return *slots;
+}
+
+template <typename T> const QueryMolecule::Program& QueryMolecule::_getProgram(std::atomic<const Program*>& slot, T* root)
+{
+    const Program* program = slot.load(std::memory_order_acquire);
+    if (program != nullptr)
+        return *program;
+
+    std::lock_guard<std::mutex> locker(_programs_lock);
+
+    program = slot.load(std::memory_order_relaxed);
+    if (program == nullptr)
+    {
+        Program& compiled = _all_programs.add(new Program());
+        compiled.compile(root);
+        program = &compiled;
+        slot.store(program, std::memory_order_release);
+    }
+    return *program;
+}
+
+const QueryMolecule::Program& QueryMolecule::getAtomProgram(int idx)
+{
+    return _getProgram(_getProgramSlots().atoms[idx], _atoms[idx]);
+}
+
+const QueryMolecule::Program& QueryMolecule::getBondProgram(int idx)
+{
+    return _getProgram(_getProgramSlots().bonds[idx], _bonds[idx]);
+}
+
+void QueryMolecule::Program::compile(Atom* root)
+{
+    _steps.clear();
+    _bonds = false;
+    _finish(_compile(root, ACCEPT, REJECT, false));
+}
+
+void QueryMolecule::Program::compile(Bond* root)
+{
+    _steps.clear();
+    _bonds = true;
+    _finish(_compile(root, ACCEPT, REJECT, false));
+}
+
+// Emits the steps for the node and returns the index of its first step. Jump
+// targets must be known in advance, so the children are compiled in reverse
+// order and the steps come out from the last test to the first one.
+int QueryMolecule::Program::_compile(Node* node, int on_true, int on_false, bool negated)
+{
+    int i;
+
+    switch (node->type)
+    {
+    case OP_NONE:
+        return on_true;
+    case OP_AND:
+        for (i = node->children.size() - 1; i >= 0; i--)
+            on_true = _compile(node->children[i], on_true, on_false, negated);
+        return on_true;
+    case OP_OR:
+        if (_isElementList(node))
+            return _addStep(node, on_true, on_false, negated);
+        for (i = node->children.size() - 1; i >= 0; i--)
+            on_false = _compile(node->children[i], on_true, on_false, negated);
+        return on_false;
+    case OP_NOT:
+        return _compile(node->children[0], on_false, on_true, !negated);
+    default:
+        return _addStep(node, on_true, on_false, negated);
+    }
+}
+
+int QueryMolecule::Program::_addStep(Node* node, int on_true, int on_false, bool negated)
+{
+    Step& step = _steps.push();
+
+    step.type = node->type;
+    step.on_true = on_true;
+    step.on_false = on_false;
+    step.negated = negated;
+    step.elements[0] = step.elements[1] = 0;
+    step.node = node;
+
+    if (node->type == OP_OR)
+    {
+        step.type = ELEMENT_SET;
+        step.value_min = step.value_max = 0;
+
+        for (int i = 0; i < node->children.size(); i++)
+        {
+            Atom* child = (Atom*)node->children[i];
+            for (int elem = child->value_min; elem <= child->value_max; elem++)
+                step.elements[elem / 64] |= (qword)1 << (elem % 64);
+        }
+    }
+    else if (_bonds)
+        step.value_min = step.value_max = ((Bond*)node)->value;
+    else
+    {
+        step.value_min = ((Atom*)node)->value_min;
+        step.value_max = ((Atom*)node)->value_max;
+    }
+
+    return _steps.size() - 1;
+}
+
+bool QueryMolecule::Program::_isElementList(Node* node)
+{
+    if (_bonds || node->children.size() < 2)
+        return false;
+
+    for (int i = 0; i < node->children.size(); i++)
+    {
+        Atom* child = (Atom*)node->children[i];
+        if (child->type != ATOM_NUMBER || child->value_min < 0 || child->value_max >= 128 || child->value_min > child->value_max)
+            return false;
+    }
+    return true;
+}
+
+void QueryMolecule::Program::_finish(int start)
+{
+    // Put the first test first, so that the evaluation mostly goes forward
+    int n = _steps.size();
+
+    for (int i = 0; i < n / 2; i++)
+        std::swap(_steps[i], _steps[n - 1 - i]);
+
+    for (int i = 0; i < n; i++)
+    {
+        if (_steps[i].on_true >= 0)
+            _steps[i].on_true = n - 1 - _steps[i].on_true;
+        if (_steps[i].on_false >= 0)
+            _steps[i].on_false = n - 1 - _steps[i].on_false;
+    }
+
+    _start = (start >= 0) ? n - 1 - start : start;
 }
 
 void QueryMolecule::optimize()
@@ -18,6 +18,7 @@
 
 #include "molecule/rdf_loader.h"
 #include "base_cpp/output.h"
+#include "base_cpp/record_offset_index.h"
 #include "base_cpp/scanner.h"
 #include "gzip/gzip_scanner.h"
 
@@ -57,6 +58,7 @@ RdfLoader::RdfLoader(Scanner& scanner)
     _current_number = 0;
     _max_offset = 0LL;
     _offsets.clear();
+    _index = 0;
 }
 
 RdfLoader::~RdfLoader()
@@ -72,6 +74,9 @@ bool RdfLoader::isEOF()
 
 int RdfLoader::count()
 {
+    if (_index != 0)
+        return _index->count();
+
     long long offset = _scanner->tell();
     int cn = _current_number;
 
@@ -105,8 +110,12 @@ void RdfLoader::readNext()
     if (_scanner->isEOF())
         throw Error("end of stream");
 
-    _offsets.expand(_current_number + 1);
-    _offsets[_current_number++] = _scanner->tell();
+    if (_index == 0)
+    {
+        _offsets.expand(_current_number + 1);
+        _offsets[_current_number] = _scanner->tell();
+    }
+    _current_number++;
 
     /*
      * Read data
@@ -311,6 +320,15 @@ int RdfLoader::currentNumber()
 
 void RdfLoader::readAt(int index)
 {
+    if (_index != 0)
+    {
+        if (index < 0 || index >= _index->count())
+            throw Error("No such record index: %d", index);
+        seekToRecord(index);
+        readNext();
+        return;
+    }
+
     if (index < _offsets.size())
     {
         _scanner->seek(_offsets[index], SEEK_SET);
@@ -332,3 +350,51 @@ void RdfLoader::readAt(int index)
         } while (index + 1 != _offsets.size());
     }
 }
+
+void RdfLoader::seekToRecord(int index)
+{
+    if (_index != 0)
+    {
+        _scanner->seek(_index->offset(index), SEEK_SET);
+        _current_number = index;
+        return;
+    }
+
+    if (index < 0 || index > _offsets.size())
+        throw Error("No such record index: %d", index);
+
+    _scanner->seek(index < _offsets.size() ? _offsets[index] : _max_offset, SEEK_SET);
+    _current_number = index;
+}
+
+void RdfLoader::useIndex(const RecordOffsetIndex* index)
+{
+    if (index != 0 && _ownScanner)
+        throw Error("offset index is not supported for gzipped input");
+    _index = index;
+}
+
+void RdfLoader::saveIndex(Output& output, long long source_mtime)
+{
+    if (_ownScanner)
+        throw Error("offset index is not supported for gzipped input");
+
+    QS_DEF(Array<long long>, offsets);
+    long long offset = _scanner->tell();
+    int cn = _current_number;
+
+    offsets.clear();
+
+    seekToRecord(0);
+    while (!isEOF())
+    {
+        offsets.push(_scanner->tell());
+        readNext();
+    }
+    offsets.push(_scanner->tell());
+
+    _scanner->seek(offset, SEEK_SET);
+    _current_number = cn;
+
+    RecordOffsetIndex::save(output, *_scanner, source_mtime, offsets);
+}
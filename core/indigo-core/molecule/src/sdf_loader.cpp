@@ -18,6 +18,7 @@
 
 #include "molecule/sdf_loader.h"
 #include "base_cpp/output.h"
+#include "base_cpp/record_offset_index.h"
 #include "base_cpp/scanner.h"
 #include "gzip/gzip_scanner.h"
 
@@ -52,6 +53,7 @@ SdfLoader::SdfLoader(Scanner& scanner) : CP_INIT, TL_CP_GET(data), TL_CP_GET(pro
     _current_number = 0;
     _max_offset = 0LL;
     _offsets.clear();
+    _index = 0;
     _preread.clear();
 }
 
@@ -73,6 +75,9 @@ int SdfLoader::currentNumber()
 
 int SdfLoader::count()
 {
+    if (_index != 0)
+        return _index->count();
+
     long long offset = _scanner->tell();
     int cn = _current_number;
 
@@ -124,8 +129,12 @@ void SdfLoader::readNext()
     if (_scanner->isEOF())
         throw Error("end of stream");
 
-    _offsets.expand(_current_number + 1);
-    _offsets[_current_number++] = _scanner->tell() - n_preread;
+    if (_index == 0)
+    {
+        _offsets.expand(_current_number + 1);
+        _offsets[_current_number] = _scanner->tell() - n_preread;
+    }
+    _current_number++;
 
     properties.clear();
 
@@ -225,6 +234,15 @@ void SdfLoader::readNext()
 
 void SdfLoader::readAt(int index)
 {
+    if (_index != 0)
+    {
+        if (index < 0 || index >= _index->count())
+            throw Error("No such record index: %d", index);
+        seekToRecord(index);
+        readNext();
+        return;
+    }
+
     if (index < _offsets.size())
     {
         _scanner->seek(_offsets[index], SEEK_SET);
@@ -248,3 +266,54 @@ void SdfLoader::readAt(int index)
         } while (index + 1 != _offsets.size());
     }
 }
+
+void SdfLoader::seekToRecord(int index)
+{
+    if (_index != 0)
+    {
+        _scanner->seek(_index->offset(index), SEEK_SET);
+        _preread.clear();
+        _current_number = index;
+        return;
+    }
+
+    if (index < 0 || index > _offsets.size())
+        throw Error("No such record index: %d", index);
+
+    _scanner->seek(index < _offsets.size() ? _offsets[index] : _max_offset, SEEK_SET);
+    _preread.clear();
+    _current_number = index;
+}
+
+void SdfLoader::useIndex(const RecordOffsetIndex* index)
+{
+    if (index != 0 && _own_scanner)
+        throw Error("offset index is not supported for gzipped input");
+    _index = index;
+}
+
+void SdfLoader::saveIndex(Output& output, long long source_mtime)
+{
+    if (_own_scanner)
+        throw Error("offset index is not supported for gzipped input");
+
+    QS_DEF(Array<long long>, offsets);
+    long long offset = _scanner->tell();
+    int cn = _current_number;
+
+    offsets.clear();
+
+    seekToRecord(0);
+    while (!isEOF())
+    {
+        offsets.push(_scanner->tell() - _preread.size());
+        readNext();
+    }
+    offsets.push(_scanner->tell());
+
+    _scanner->seek(offset, SEEK_SET);
+    _preread.clear();
+    _current_number = cn;
+
+    RecordOffsetIndex::save(output, *_scanner, source_mtime, offsets);
+}
@@ -35,7 +35,7 @@ IMPL_ERROR(SmilesLoader, "SMILES loader");
 CP_DEF(SmilesLoader);
 
 SmilesLoader::SmilesLoader(Scanner& scanner)
-    : _scanner(scanner), CP_INIT, TL_CP_GET(_atom_stack), TL_CP_GET(_cycles), TL_CP_GET(_pending_bonds_pool), TL_CP_GET(_neipool), TL_CP_GET(_atoms),
+    : _scanner(scanner), CP_INIT, TL_CP_GET(_atom_stack), TL_CP_GET(_cycles), TL_CP_GET(_pending_bonds_pool), TL_CP_GET(_atoms),
       TL_CP_GET(_bonds), TL_CP_GET(_polymer_repetitions)
 {
     ignorable_aam = 0;
@@ -54,8 +54,6 @@ SmilesLoader::SmilesLoader(Scanner& scanner)
 
 SmilesLoader::~SmilesLoader()
 {
-    // clear pool-dependent data in this thread to avoid data races
-    _atoms.clear();
 }
 
 void SmilesLoader::loadMolecule(Molecule& mol)
@@ -161,9 +159,9 @@ void SmilesLoader::_calcStereocenters()
                 pyramid[counter++] = -1;
             }
 
-            for (j = _atoms[i].neighbors.begin(); j != _atoms[i].neighbors.end(); j = _atoms[i].neighbors.next(j))
+            for (j = 0; j < _atoms[i].neighbors.size(); j++)
             {
-                int nei = _atoms[i].neighbors.at(j);
+                int nei = _atoms[i].neighbors[j];
 
                 if (counter >= 4)
                 {
@@ -176,7 +174,7 @@ void SmilesLoader::_calcStereocenters()
                     pyramid[counter++] = nei;
             }
 
-            if (j != _atoms[i].neighbors.end())
+            if (j != _atoms[i].neighbors.size())
                 continue;
 
             if (counter < 3)
@@ -983,7 +981,7 @@ void SmilesLoader::_parseMolecule()
                     if (_qmol != 0)
                         bond->index = _qmol->addBond(bond->beg, bond->end, new QueryMolecule::Bond());
 
-                    _atoms[bond->beg].neighbors.add(bond->end);
+                    _atoms[bond->beg].neighbors.push(bond->end);
                     _atoms[bond->end].closure(number, bond->beg);
 
                     break;
@@ -994,7 +992,7 @@ void SmilesLoader::_parseMolecule()
                     bond = &_bonds[_cycles[number].pending_bond];
                     bond->end = _atom_stack.top();
                     added_bond = true;
-                    _atoms[bond->end].neighbors.add(bond->beg);
+                    _atoms[bond->end].neighbors.push(bond->beg);
                     _atoms[bond->beg].closure(number, bond->end);
 
                     if (_qmol != 0)
@@ -1162,7 +1160,7 @@ void SmilesLoader::_parseMolecule()
                             bond->index = _qmol->addBond(bond->beg, bond->end, qbond.release());
 
                         _atoms[bond->end].closure(number, bond->beg);
-                        _atoms[bond->beg].neighbors.add(bond->end);
+                        _atoms[bond->beg].neighbors.push(bond->end);
 
                         _cycles[number].clear();
                         continue;
@@ -1207,7 +1205,7 @@ void SmilesLoader::_parseMolecule()
                             pending_bond.index = _qmol->addBond(pending_bond.beg, bond->beg, qbond.release());
 
                         pending_bond.end = bond->beg;
-                        _atoms[pending_bond.end].neighbors.add(pending_bond.beg);
+                        _atoms[pending_bond.end].neighbors.push(pending_bond.beg);
                         _atoms[pending_bond.beg].closure(number, pending_bond.end);
 
                         // forget the closing bond but move its index here
@@ -1239,7 +1237,7 @@ void SmilesLoader::_parseMolecule()
             }
         }
 
-        _AtomDesc& atom = _atoms.push(_neipool);
+        _AtomDesc& atom = _atoms.push();
 
         std::unique_ptr<QueryMolecule::Atom> qatom;
 
@@ -1302,8 +1300,8 @@ void SmilesLoader::_parseMolecule()
 
         if (bond != 0)
         {
-            _atoms[bond->beg].neighbors.add(bond->end);
-            _atoms[bond->end].neighbors.add(bond->beg);
+            _atoms[bond->beg].neighbors.push(bond->end);
+            _atoms[bond->end].neighbors.push(bond->beg);
             _atoms[bond->end].parent = bond->beg;
             // when going from a polymer atom, make the new atom belong
             // to the same polymer
@@ -1430,6 +1428,8 @@ void SmilesLoader::_loadParsedMolecule()
 
     if (_mol != 0)
     {
+        _mol->reserve(_atoms.size(), _bonds.size());
+
         for (i = 0; i < _atoms.size(); i++)
         {
             if (_atoms[i].label == 0)
@@ -1555,10 +1555,19 @@ void SmilesLoader::_loadParsedMolecule()
 
 void SmilesLoader::_markAromaticBonds()
 {
-    CycleBasis basis;
+    QS_DEF(CycleBasis, basis);
     int i;
 
-    basis.create(*_bmol);
+    basis.clear();
+
+    // Only the bonds without an explicit order between two aromatic atoms
+    // may become aromatic, and the cycle basis is not needed if there are none
+    for (i = 0; i < _bonds.size(); i++)
+        if (_bonds[i].type == -1 && _atoms[_bonds[i].beg].aromatic && _atoms[_bonds[i].end].aromatic)
+            break;
+
+    if (i < _bonds.size())
+        basis.create(*_bmol);
 
     // Mark all 'empty' bonds in "aromatic" rings as aromatic.
     // We use SSSR here because we do not want "empty" bonds to
@@ -1739,7 +1748,7 @@ void SmilesLoader::_addExplicitHForStereo()
     {
         if ((_atoms[i].chirality > 0) && (_bmol->getVertex(i).degree() == 2) && (_atoms[i].hydrogens == 1))
         {
-            _AtomDesc& atom = _atoms.push(_neipool);
+            _AtomDesc& atom = _atoms.push();
             _BondDesc* bond = &_bonds.push();
 
             atom.label = ELEM_H;
@@ -1750,8 +1759,8 @@ void SmilesLoader::_addExplicitHForStereo()
             bond->type = BOND_SINGLE;
             bond->index = _mol->addBond_Silent(bond->beg, bond->end, bond->type);
 
-            _atoms[i].neighbors.add(exp_h_idx);
-            _atoms[exp_h_idx].neighbors.add(i);
+            _atoms[i].neighbors.push(exp_h_idx);
+            _atoms[exp_h_idx].neighbors.push(i);
             _atoms[exp_h_idx].parent = i;
 
             _atoms[i].hydrogens = 0;
@@ -1778,7 +1787,7 @@ void SmilesLoader::_addLigandsForStereo()
 
             for (int j = 0; j < num_ligands; j++)
             {
-                _AtomDesc& atom = _atoms.push(_neipool);
+                _AtomDesc& atom = _atoms.push();
                 _BondDesc* bond = &_bonds.push();
                 std::unique_ptr<QueryMolecule::Atom> qatom;
 
@@ -1800,14 +1809,14 @@ void SmilesLoader::_addLigandsForStereo()
                 bond->topology = 0;
                 bond->index = _qmol->addBond(i, any_atom_idx, qbond.release());
 
-                _atoms[i].neighbors.add(any_atom_idx);
-                _atoms[any_atom_idx].neighbors.add(i);
+                _atoms[i].neighbors.push(any_atom_idx);
+                _atoms[any_atom_idx].neighbors.push(i);
                 _atoms[any_atom_idx].parent = i;
             }
 
             if (_atoms[i].hydrogens == 1)
             {
-                _AtomDesc& atom = _atoms.push(_neipool);
+                _AtomDesc& atom = _atoms.push();
                 _BondDesc* bond = &_bonds.push();
 
                 std::unique_ptr<QueryMolecule::Atom> qatom = std::make_unique<QueryMolecule::Atom>(QueryMolecule::ATOM_NUMBER, ELEM_H);
@@ -1823,8 +1832,8 @@ void SmilesLoader::_addLigandsForStereo()
                 bond->topology = 0;
                 bond->index = _qmol->addBond(i, exp_h_idx, qbond.release());
 
-                _atoms[i].neighbors.add(exp_h_idx);
-                _atoms[exp_h_idx].neighbors.add(i);
+                _atoms[i].neighbors.push(exp_h_idx);
+                _atoms[exp_h_idx].neighbors.push(i);
                 _atoms[exp_h_idx].parent = i;
 
                 _atoms[i].hydrogens = 0;
@@ -2866,8 +2875,19 @@ void SmilesLoader::_readRGroupOccurrenceRanges(const char* str, Array<int>& rang
     ranges.push((beg << 16) | end);
 }
 
-SmilesLoader::_AtomDesc::_AtomDesc(Pool<List<int>::Elem>& neipool) : neighbors(neipool)
+SmilesLoader::_AtomDesc::_AtomDesc()
+{
+    clear();
+}
+
+SmilesLoader::_AtomDesc::~_AtomDesc()
 {
+}
+
+void SmilesLoader::_AtomDesc::clear()
+{
+    neighbors.clear();
+
     label = 0;
     isotope = 0;
     charge = 0;
@@ -2886,15 +2906,11 @@ SmilesLoader::_AtomDesc::_AtomDesc(Pool<List<int>::Elem>& neipool) : neighbors(n
     rsite_num = 0;
 }
 
-SmilesLoader::_AtomDesc::~_AtomDesc()
-{
-}
-
 void SmilesLoader::_AtomDesc::pending(int cycle)
 {
     if (cycle < 1)
         throw Error("cycle number %d is not allowed", cycle);
-    neighbors.add(-cycle);
+    neighbors.push(-cycle);
 }
 
 void SmilesLoader::_AtomDesc::closure(int cycle, int end)
@@ -2904,11 +2920,11 @@ void SmilesLoader::_AtomDesc::closure(int cycle, int end)
     if (cycle < 1)
         throw Error("cycle number %d is not allowed", cycle);
 
-    for (i = neighbors.begin(); i != neighbors.end(); i = neighbors.next(i))
+    for (i = 0; i < neighbors.size(); i++)
     {
-        if (neighbors.at(i) == -cycle)
+        if (neighbors[i] == -cycle)
         {
-            neighbors.at(i) = end;
+            neighbors[i] = end;
             break;
         }
     }
@@ -51,7 +51,7 @@ bool ReactionSubstructureMatcher::_match_atoms(BaseReaction& query_, Reaction& t
 
     self._fmcaches.expand(sub_mol_idx + 1);
 
-    if (!MoleculeSubstructureMatcher::matchQueryAtom(&submol.getAtom(sub_atom_idx), supermol, super_atom_idx, &self._fmcaches[sub_mol_idx], 0xFFFFFFFFUL))
+    if (!MoleculeSubstructureMatcher::matchQueryAtom(submol.getAtomProgram(sub_atom_idx), supermol, super_atom_idx, &self._fmcaches[sub_mol_idx], 0xFFFFFFFFUL))
         return false;
 
     if (submol.stereocenters.getType(sub_atom_idx) > supermol.stereocenters.getType(super_atom_idx))
@@ -116,7 +116,7 @@ bool ReactionSubstructureMatcher::_match_bonds(BaseReaction& query_, Reaction& t
     QueryMolecule& submol = query.getQueryMolecule(sub_mol_idx);
     Molecule& supermol = target.getMolecule(super_mol_idx);
 
-    if (!MoleculeSubstructureMatcher::matchQueryBond(&submol.getBond(sub_bond_idx), supermol, sub_bond_idx, super_bond_idx, am, 0xFFFFFFFFUL))
+    if (!MoleculeSubstructureMatcher::matchQueryBond(submol.getBondProgram(sub_bond_idx), supermol, sub_bond_idx, super_bond_idx, am, 0xFFFFFFFFUL))
         return false;
 
     int sub_change = query.getReactingCenter(sub_mol_idx, sub_bond_idx);